@@ -0,0 +1,273 @@
+#include "AIPlayer.h"
+#include "Game.h"
+#include "Random.h"
+#include "Rules.h"
+
+#include <atomic>
+#include <thread>
+
+using namespace std;
+
+AIPlayer::AIPlayer() {
+    _greenChance = 0.0;
+    _otherChance = 0.0;
+    _effectTiles = 0;
+    _nodeBudget = 40000;
+    _nodesSearched = 0;
+    _rules = defaultGameRules();
+}
+
+void AIPlayer::setup(const Board& board, const EventSampler& sampler, const GameRules& rules) {
+    _rules = rules;
+
+    // Only the middle tiles (not start or finish) have effects
+    _effectTiles = board.getBoardSize() - 2;
+    if (_effectTiles > 0) {
+        _greenChance = (double)board.getGreenCount() / _effectTiles;
+    }
+    // The other five colors are equally likely
+    _otherChance = (1.0 - _greenChance) / 5.0;
+
+    for (int p = 0; p < PATH_COUNT; p++) {
+        for (int a = 0; a < ADVISOR_COUNT; a++) {
+            sampler.getOutcomes(p, a, _eventDeltas[p][a], _eventChances[p][a]);
+        }
+    }
+}
+
+void AIPlayer::setNodeBudget(long nodes) {
+    _nodeBudget = nodes;
+}
+
+long AIPlayer::getNodesSearched() const {
+    return _nodesSearched;
+}
+
+// Stats right after taking a path (same bonuses as Game::applyPathBonuses)
+AIPlayer::SearchState AIPlayer::startState(const Player& character, int path) const {
+    SearchState state;
+    state.remaining = _effectTiles;
+    state.greenToggle = 0;
+    state.accuracy = character.getAccuracy();
+    state.efficiency = character.getEfficiency();
+    state.insight = character.getInsight();
+    state.discoverPoints = character.getDiscoverPoints();
+
+    if (path == 0) {
+        state.discoverPoints += _rules.fellowshipDP;
+        state.accuracy += _rules.fellowshipAccuracy;
+        state.efficiency += _rules.fellowshipEfficiency;
+        state.insight += _rules.fellowshipInsight;
+    } else {
+        state.discoverPoints += _rules.directLabDP;
+        state.accuracy += _rules.directLabAccuracy;
+        state.efficiency += _rules.directLabEfficiency;
+        state.insight += _rules.directLabInsight;
+    }
+    return state;
+}
+
+// Score now, plus a straight-line guess for the tiles the search did not reach
+// (each stat point is worth 10 final-score points, ignoring the rounding to 100s)
+double AIPlayer::leafValue(const SearchState& state, int path, int advisor) const {
+    Player p("", 0, state.accuracy, state.efficiency, state.insight, state.discoverPoints, path);
+    double value = Game::calculateFinalScore(p);
+
+    double eventAverage = 0.0;
+    const vector<int>& deltas = _eventDeltas[path][advisor];
+    const vector<double>& chances = _eventChances[path][advisor];
+    for (int i = 0; i < (int)deltas.size(); i++) {
+        eventAverage += deltas[i] * chances[i];
+    }
+
+    // Every other Green tile has an event; riddles count as 0 for the AI
+    double perTile = _greenChance * 0.5 * eventAverage +
+                     _otherChance * 10.0 * (_rules.blueMaxAccuracy + _rules.pinkEfficiency +
+                                            _rules.redInsight + _rules.brownAccuracy +
+                                            _rules.brownEfficiency);
+    return value + perTile * state.remaining;
+}
+
+double AIPlayer::Search::expectimax(const SearchState& state, int depth) {
+    nodes++;
+    if (state.remaining == 0 || depth == 0) {
+        return ai->leafValue(state, path, advisor);
+    }
+
+    // Transposition table lookup: same stats and tiles left means same future
+    unsigned long long key = mixKey(mixKey(mixKey(state.remaining * 2 + state.greenToggle,
+                                                  state.accuracy), state.efficiency),
+                                    mixKey(state.insight, state.discoverPoints));
+    TableEntry& entry = table[key & (_TABLE_SIZE - 1)];
+    if (entry.key == key && entry.depth >= depth) {
+        return entry.value;
+    }
+
+    SearchState next = state;
+    next.remaining--;
+    double value = 0.0;
+
+    // Green: event on every other Green tile
+    if (state.greenToggle == 0) {
+        next.greenToggle = 1;
+        const vector<int>& deltas = ai->_eventDeltas[path][advisor];
+        const vector<double>& chances = ai->_eventChances[path][advisor];
+        if (deltas.empty()) {
+            value += ai->_greenChance * expectimax(next, depth - 1);
+        }
+        for (int i = 0; i < (int)deltas.size(); i++) {
+            SearchState afterEvent = next;
+            afterEvent.discoverPoints += deltas[i];
+            value += ai->_greenChance * chances[i] * expectimax(afterEvent, depth - 1);
+        }
+    } else {
+        next.greenToggle = 0;
+        value += ai->_greenChance * expectimax(next, depth - 1);
+    }
+    next.greenToggle = state.greenToggle;
+
+    // Blue: identical strands give the full accuracy bonus
+    next.accuracy += ai->_rules.blueMaxAccuracy;
+    value += ai->_otherChance * expectimax(next, depth - 1);
+    next.accuracy = state.accuracy;
+
+    // Pink
+    next.efficiency += ai->_rules.pinkEfficiency;
+    value += ai->_otherChance * expectimax(next, depth - 1);
+    next.efficiency = state.efficiency;
+
+    // Red
+    next.insight += ai->_rules.redInsight;
+    value += ai->_otherChance * expectimax(next, depth - 1);
+    next.insight = state.insight;
+
+    // Brown
+    next.accuracy += ai->_rules.brownAccuracy;
+    next.efficiency += ai->_rules.brownEfficiency;
+    value += ai->_otherChance * expectimax(next, depth - 1);
+    next.accuracy = state.accuracy;
+    next.efficiency = state.efficiency;
+
+    // Purple: the AI does not know the riddle answers
+    value += ai->_otherChance * expectimax(next, depth - 1);
+
+    entry.key = key;
+    entry.depth = depth;
+    entry.value = value;
+    return value;
+}
+
+// Iterative deepening: search one tile deeper each round until the budget is used up
+double AIPlayer::searchCandidate(const SearchState& start, int path, int advisor, long budget,
+                                 long& nodes) const {
+    Search search;
+    search.ai = this;
+    search.path = path;
+    search.advisor = advisor;
+    search.table.assign(_TABLE_SIZE, TableEntry{0, -1, 0.0});
+    search.nodes = 0;
+    search.budget = budget;
+
+    double value = leafValue(start, path, advisor);
+    for (int depth = 1; depth <= start.remaining; depth++) {
+        long before = search.nodes;
+        value = search.expectimax(start, depth);
+        long used = search.nodes - before;
+        // The next depth costs several times more; stop if it would not fit
+        if (search.nodes + used * 4 > budget) {
+            break;
+        }
+    }
+
+    nodes = search.nodes;
+    return value;
+}
+
+// Searches every (character, path, advisor) candidate and keeps the best one
+// Candidates are shared out to worker threads through an atomic counter
+void AIPlayer::searchBest(const vector<Player>& options, int excluded,
+                          int& bestCharacter, int& bestPath, int& bestAdvisor) {
+    struct Candidate {
+        int character;
+        int path;
+        int advisor;
+        double value;
+        long nodes;
+    };
+
+    vector<Candidate> candidates;
+    for (int c = 0; c < (int)options.size(); c++) {
+        if (c == excluded) {
+            continue;
+        }
+        for (int p = 0; p < PATH_COUNT; p++) {
+            // Advisor 0 (none) is never picked in the game
+            for (int a = 1; a < ADVISOR_COUNT; a++) {
+                Candidate candidate = {c, p, a, 0.0, 0};
+                candidates.push_back(candidate);
+            }
+        }
+    }
+
+    bestCharacter = -1;
+    bestPath = 0;
+    bestAdvisor = 1;
+    if (candidates.empty()) {
+        return;
+    }
+
+    long budget = _nodeBudget / (long)candidates.size();
+    if (budget < 1) {
+        budget = 1;
+    }
+
+    atomic<int> nextCandidate(0);
+    int threadCount = thread::hardware_concurrency();
+    if (threadCount < 1) {
+        threadCount = 1;
+    }
+    if (threadCount > (int)candidates.size()) {
+        threadCount = candidates.size();
+    }
+
+    // Each worker keeps taking the next unsearched candidate
+    vector<thread> workers;
+    for (int t = 0; t < threadCount; t++) {
+        workers.push_back(thread([&]() {
+            int i;
+            while ((i = nextCandidate.fetch_add(1)) < (int)candidates.size()) {
+                Candidate& c = candidates[i];
+                SearchState start = startState(options[c.character], c.path);
+                c.value = searchCandidate(start, c.path, c.advisor, budget, c.nodes);
+            }
+        }));
+    }
+    for (int t = 0; t < threadCount; t++) {
+        workers[t].join();
+    }
+
+    // Pick the best (the first one wins ties, so the choice is repeatable)
+    _nodesSearched = 0;
+    int best = 0;
+    for (int i = 0; i < (int)candidates.size(); i++) {
+        _nodesSearched += candidates[i].nodes;
+        if (candidates[i].value > candidates[best].value) {
+            best = i;
+        }
+    }
+    bestCharacter = candidates[best].character;
+    bestPath = candidates[best].path;
+    bestAdvisor = candidates[best].advisor;
+}
+
+int AIPlayer::chooseCharacter(const vector<Player>& options, int excluded) {
+    int character, path, advisor;
+    searchBest(options, excluded, character, path, advisor);
+    return character;
+}
+
+void AIPlayer::choosePath(const Player& character, int& path, int& advisor) {
+    vector<Player> options(1, character);
+    int index;
+    searchBest(options, -1, index, path, advisor);
+}
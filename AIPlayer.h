@@ -0,0 +1,89 @@
+#ifndef AIPLAYER_H
+#define AIPLAYER_H
+
+#include "Board.h"
+#include "EventSampler.h"
+#include "Player.h"
+#include "Rules.h"
+#include <vector>
+
+using namespace std;
+
+// Computer player for the setup decisions (character, path and advisor)
+//
+// Each candidate decision is scored by an expectimax search over the tiles still
+// to come: chance nodes for the tile color and for the random event outcome,
+// with the final score (Game::calculateFinalScore) at the end of the board.
+// Positions reached in different orders (Blue then Pink, Pink then Blue) are
+// stored once in a hashed transposition table. The search deepens until its node
+// budget is spent, and candidates are searched in parallel, one thread each.
+//
+// On its turns the AI plays every DNA task perfectly but cannot solve riddles.
+
+class AIPlayer {
+private:
+    // What is left to play for one player
+    struct SearchState {
+        int remaining;        // tiles with an effect still ahead
+        int greenToggle;      // 0 = the next Green tile triggers an event
+        int accuracy;
+        int efficiency;
+        int insight;
+        int discoverPoints;
+    };
+
+    struct TableEntry {
+        unsigned long long key;
+        int depth;
+        double value;
+    };
+
+    // One search thread: its own transposition table and node counter
+    struct Search {
+        const AIPlayer* ai;
+        int path;
+        int advisor;
+        vector<TableEntry> table;
+        long nodes;
+        long budget;
+
+        double expectimax(const SearchState& state, int depth);
+    };
+
+    static const int _TABLE_SIZE = 1 << 12;
+
+    // Tile odds (from the Board) and event odds per (path, advisor) (from the EventSampler)
+    double _greenChance;
+    double _otherChance;
+    int _effectTiles;
+    vector<int> _eventDeltas[PATH_COUNT][ADVISOR_COUNT];
+    vector<double> _eventChances[PATH_COUNT][ADVISOR_COUNT];
+
+    GameRules _rules;   // reward values the game is using
+
+    long _nodeBudget;
+    long _nodesSearched;
+
+    double leafValue(const SearchState& state, int path, int advisor) const;
+    double searchCandidate(const SearchState& start, int path, int advisor, long budget,
+                           long& nodes) const;
+    SearchState startState(const Player& character, int path) const;
+    void searchBest(const vector<Player>& options, int excluded,
+                    int& bestCharacter, int& bestPath, int& bestAdvisor);
+
+public:
+    AIPlayer();
+
+    // Reads the tile odds from the board, the event odds from the sampler and the rewards
+    void setup(const Board& board, const EventSampler& sampler, const GameRules& rules);
+    // Roughly how many search nodes one decision may use (default: about 1 ms)
+    void setNodeBudget(long nodes);
+    long getNodesSearched() const;
+
+    // Returns the 0-based index of the best character that is not 'excluded'
+    int chooseCharacter(const vector<Player>& options, int excluded);
+    // Picks the best path and advisor for the given character
+    void choosePath(const Player& character, int& path, int& advisor);
+};
+
+#endif
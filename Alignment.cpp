@@ -0,0 +1,180 @@
+#include "Alignment.h"
+#include "ScratchArena.h"
+#include "StrandIO.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <climits>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static const int MATCH_SCORE = 1;
+static const int MISMATCH_SCORE = -1;
+static const int GAP_SCORE = -2;
+static const int DROPPED = INT_MIN / 2;
+
+// One alignment cell: the best path ending here and what it has counted so far
+// (carrying the counts along means no traceback table is needed)
+struct AlignCell {
+    int score;
+    int matches;
+    int columns;
+    int gaps;
+    bool edge;   // the path has run along the edge of the band
+};
+
+// One pass with a fixed band; 'edge' tells whether the chosen path ran along the band's edge
+static AlignmentResult alignBanded(string_view a, string_view b, int band, int xDrop, bool& edge) {
+    long long n = a.size();
+    long long m = b.size();
+    // Diagonal d = j - i; the path from (0,0) to (n,m) has to cross 0 and m - n
+    long long low = max(min(0LL, m - n) - band, -n);
+    long long high = min(max(0LL, m - n) + band, m);
+    bool lowLimits = low > -n;
+    bool highLimits = high < m;
+    int width = high - low + 1;
+
+    // The two rows come from this thread's scratch arena and go back on return
+    ScratchScope scope(threadScratch());
+    pmr::vector<AlignCell> previous(width, &threadScratch());
+    pmr::vector<AlignCell> current(width, &threadScratch());
+    AlignCell best = {0, 0, 0, 0, false};
+    long long bestRow = 0;
+    long long bestColumn = 0;
+
+    // Row 0: only gaps in strand 1
+    long long liveLow = 0;
+    long long liveHigh = -1;
+    long long rowLow = 0;
+    long long rowHigh = min(high, m);
+    for (long long j = rowLow; j <= rowHigh; j++) {
+        AlignCell& cell = previous[j - low];
+        cell = {(int)(GAP_SCORE * j), 0, (int)j, (int)j, highLimits && j == high};
+        if (cell.score < -xDrop) {
+            cell.score = DROPPED;
+        } else {
+            liveHigh = j;
+        }
+    }
+
+    bool complete = false;
+    AlignCell end = best;
+    if (n == 0 && liveHigh == m) {
+        complete = true;
+        end = previous[m - low];
+    }
+    for (long long i = 1; i <= n && liveLow <= liveHigh; i++) {
+        // Only columns next to a cell still alive in the row above can be reached
+        long long start = max(max(liveLow, i + low), 0LL);
+        long long stop = min(min(liveHigh + 1, i + high), m);
+        long long previousLow = rowLow;
+        long long previousHigh = rowHigh;
+        rowLow = start;
+        rowHigh = stop;
+        liveLow = LLONG_MAX;
+        liveHigh = -1;
+
+        for (long long j = start; j <= stop; j++) {
+            long long index = j - i - low;
+            AlignCell cell = {DROPPED, 0, 0, 0, false};
+            // Diagonal first, so equal-length strands line up without gaps on ties
+            if (j >= 1 && j - 1 >= previousLow && j - 1 <= previousHigh && previous[index].score != DROPPED) {
+                const AlignCell& from = previous[index];
+                bool same = a[i - 1] == b[j - 1];
+                cell = {from.score + (same ? MATCH_SCORE : MISMATCH_SCORE), from.matches + same,
+                        from.columns + 1, from.gaps, from.edge};
+            }
+            if (j >= previousLow && j <= previousHigh && index + 1 < width && previous[index + 1].score != DROPPED) {
+                const AlignCell& from = previous[index + 1];
+                if (from.score + GAP_SCORE > cell.score) {
+                    cell = {from.score + GAP_SCORE, from.matches, from.columns + 1, from.gaps + 1, from.edge};
+                }
+            }
+            if (j - 1 >= start && current[index - 1].score != DROPPED) {
+                const AlignCell& from = current[index - 1];
+                if (from.score + GAP_SCORE > cell.score) {
+                    cell = {from.score + GAP_SCORE, from.matches, from.columns + 1, from.gaps + 1, from.edge};
+                }
+            }
+
+            if (cell.score != DROPPED && cell.score < best.score - xDrop) {
+                cell.score = DROPPED;
+            }
+            if (cell.score != DROPPED) {
+                cell.edge = cell.edge || (lowLimits && j - i == low) || (highLimits && j - i == high);
+                liveLow = min(liveLow, j);
+                liveHigh = j;
+                if (cell.score > best.score) {
+                    best = cell;
+                    bestRow = i;
+                    bestColumn = j;
+                }
+            }
+            current[index] = cell;
+        }
+        swap(previous, current);
+
+        if (i == n && stop == m && previous[m - n - low].score != DROPPED) {
+            complete = true;
+            end = previous[m - n - low];
+        }
+    }
+
+    AlignmentResult result;
+    result.band = band;
+    result.complete = complete;
+    if (complete) {
+        result.matches = end.matches;
+        result.columns = end.columns;
+        result.gaps = end.gaps;
+        edge = end.edge;
+    } else {
+        // Stopped early: the rest of both strands counts as unmatched columns,
+        // and the longer rest can only line up with gaps
+        long long rest1 = n - bestRow;
+        long long rest2 = m - bestColumn;
+        result.matches = best.matches;
+        result.columns = best.columns + max(rest1, rest2);
+        result.gaps = best.gaps + (rest1 > rest2 ? rest1 - rest2 : rest2 - rest1);
+        edge = best.edge;
+    }
+    result.identity = result.columns > 0 ? result.matches / (double)result.columns : 0;
+    return result;
+}
+
+AlignmentResult alignStrands(string_view strand1, string_view strand2, const AlignmentOptions& options) {
+    TRACE_SCOPE("alignStrands");
+    long long n = strand1.size();
+    long long m = strand2.size();
+    int band = max(options.band, 1);
+    while (true) {
+        bool edge = false;
+        AlignmentResult result = alignBanded(strand1, strand2, band, options.xDrop, edge);
+        // A path squeezed against the band might do better with a wider one
+        bool full = min(0LL, m - n) - band <= -n && max(0LL, m - n) + band >= m;
+        if (!edge || full) {
+            return result;
+        }
+        band = (int)min(2LL * band, n + m);
+    }
+}
+
+int printAlignment(const char strandFile[], ostream& out) {
+    vector<string> names;
+    vector<string> strands;
+    if (!readStrands(strandFile, names, strands) || strands.size() < 2) {
+        out << "Error: " << strandFile << " needs at least two strands" << endl;
+        return 1;
+    }
+    AlignmentResult result = alignStrands(strands[0], strands[1]);
+    out << names[0] << " (" << strands[0].size() << " bases) vs "
+        << names[1] << " (" << strands[1].size() << " bases)\n";
+    out << "Similarity score: " << result.identity << "\n";
+    out << result.matches << " matches in " << result.columns << " columns, "
+        << result.gaps << " gaps, band " << result.band
+        << (result.complete ? "" : " (stopped early: strands too different)") << endl;
+    return 0;
+}
@@ -0,0 +1,50 @@
+#ifndef ALIGNMENT_H
+#define ALIGNMENT_H
+
+#include <iostream>
+#include <string_view>
+
+using namespace std;
+
+// Banded global alignment for strands that differ by a few insertions/deletions
+//
+// strandSimilarity lines the strands up base by base, so one extra base early
+// on shifts everything after it. An alignment may instead skip a base in one
+// strand (a gap). Scores: match +1, mismatch -1, gap -2. The identity is
+// matching columns / alignment columns, which is the same as strandSimilarity
+// for equal-length strands aligned without gaps.
+//
+// Full alignment is O(n*m). Two things keep it near linear for similar strands:
+//  - Band: only diagonals within 'band' of the straight path from start to end
+//    are looked at (O(n * band)). If the best path runs along the edge of the
+//    band, the band is doubled and the alignment is repeated.
+//  - X-drop: cells more than 'xDrop' below the best score so far are dropped,
+//    and each row only looks past the cells still alive in the row before.
+//    If every cell in a row is dropped the strands are too different; the
+//    identity is then taken from the best partial alignment, counting the
+//    rest of both strands as unmatched columns.
+// Only the current and previous rows are kept, so memory is O(band).
+
+struct AlignmentOptions {
+    int band;      // starting band width (diagonals on each side)
+    int xDrop;     // score drop that ends a path
+};
+
+const AlignmentOptions DEFAULT_ALIGNMENT = {32, 50};   // X-drop 50 allows a gap of about 20 bases
+
+struct AlignmentResult {
+    double identity;     // matches / columns (0 to 1)
+    long long matches;
+    long long columns;   // alignment length, including gaps
+    long long gaps;      // columns with a gap in either strand
+    int band;            // band width of the final pass
+    bool complete;       // false if X-drop stopped it before the end
+};
+
+AlignmentResult alignStrands(string_view strand1, string_view strand2,
+                             const AlignmentOptions& options = DEFAULT_ALIGNMENT);
+
+// Command line helper: aligns the first two strands of a strand file (see StrandIO.h)
+int printAlignment(const char strandFile[], ostream& out);
+
+#endif
@@ -0,0 +1,143 @@
+// Allocation check: a separate program (not part of the game) that checks
+// that game turns make no heap allocations once the turn arena has warmed up
+//
+// Compile it with the game's files but this file in place of main.cpp (see
+// readme.txt), then run ./alloc-check 200 (typed strands of 200 bases).
+//
+// It replaces the global operator new (the plain and the aligned one; new[]
+// and the nothrow forms go through them), so every allocation in this program
+// adds one to a per-thread counter before calling malloc. The game itself
+// keeps the normal allocator.
+
+#include "Game.h"
+#include "Random.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <string>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+using namespace std;
+
+// =========================== Counting operator new ===========================
+
+static thread_local long long allocationCount = 0;
+
+// Allocations made by the calling thread so far
+static long long threadAllocations() {
+    return allocationCount;
+}
+
+void* operator new(size_t size) {
+    allocationCount++;
+    void* memory = malloc(size == 0 ? 1 : size);
+    if (memory == nullptr) {
+        throw bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new(size_t size, align_val_t alignment) {
+    allocationCount++;
+    size_t align = (size_t)alignment;
+#ifdef _WIN32
+    // No aligned_alloc on Windows; memory from _aligned_malloc needs _aligned_free
+    void* memory = _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+    // aligned_alloc wants a multiple of the alignment
+    void* memory = aligned_alloc(align, (size + align - 1) / align * align);
+#endif
+    if (memory == nullptr) {
+        throw bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, size_t /*size*/) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, align_val_t /*alignment*/) noexcept {
+#ifdef _WIN32
+    _aligned_free(memory);
+#else
+    free(memory);
+#endif
+}
+
+void operator delete(void* memory, size_t /*size*/, align_val_t alignment) noexcept {
+    operator delete(memory, alignment);
+}
+
+// =========================== Turn check ===========================
+
+// Formats everything like a real console stream but throws the text away
+class DiscardBuffer : public streambuf {
+private:
+    char _buffer[4096];
+
+protected:
+    int overflow(int c) override {
+        setp(_buffer, _buffer + sizeof(_buffer));
+        return c;
+    }
+
+public:
+    DiscardBuffer() {
+        setp(_buffer, _buffer + sizeof(_buffer));
+    }
+};
+
+// Answers for every prompt of a game, like a player typing: the setup choices,
+// then over and over a riddle answer and two strands (a number prompt skips
+// the word, a strand prompt takes it as a strand)
+static string scriptedGame(int strandLength) {
+    unsigned long long rng = 1300;
+    string strand1;
+    string strand2;
+    for (int i = 0; i < strandLength; i++) {
+        strand1 += "ACGT"[nextRandom(rng) % 4];
+    }
+    strand2 = strand1;
+    for (int i = 0; i < strandLength; i += 7) {
+        strand2[i] = "ACGT"[nextRandom(rng) % 4];
+    }
+    string script = "1\n2\n0\n3\n1\n1\n";
+    for (int turn = 0; turn < 200; turn++) {
+        script += "loop\n" + strand1 + "\n" + strand2 + "\n";
+    }
+    return script;
+}
+
+// Plays the scripted two-player game (typed-in strands, riddle answers, every
+// tile) twice with one Game. The first game warms up the turn arena; the
+// second must make no heap allocations during turns. Exit code 1 if it did
+int main(int argc, char* argv[]) {
+    int strandLength = (argc > 1) ? max(atoi(argv[1]), 1) : 200;
+    string script = scriptedGame(strandLength);
+    istringstream input;
+    DiscardBuffer discard;
+    ostream console(&discard);
+    Game game(input, console);
+    game.setAllocationCounter(threadAllocations);
+
+    long long turnAllocations[2];
+    for (int run = 0; run < 2; run++) {
+        input.str(script);
+        input.clear();
+        game.run();
+        turnAllocations[run] = game.getTurnAllocations();
+    }
+    cout << "Heap allocations during turns: " << turnAllocations[0] << " in the first game (warm-up), "
+         << turnAllocations[1] << " in the second" << endl;
+    return turnAllocations[1] == 0 ? 0 : 1;
+}
@@ -0,0 +1,157 @@
+/*
+ * AssetCompiler.cpp
+ *
+ * Build tool (its own program, not part of the game) that turns characters.txt,
+ * random_events.txt and riddles.txt into GeneratedAssets.cpp: constexpr tables
+ * the game links in, so it can start without reading any files.
+ *
+ * Build and run it again whenever one of the .txt files changes:
+ *   c++ -std=c++17 AssetCompiler.cpp DataLoader.cpp -o asset_compiler
+ *   ./asset_compiler > GeneratedAssets.cpp
+ *
+ * An optional argument gives the folder holding the .txt files.
+ */
+
+#include "DataLoader.h"
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// All interned text, and where each distinct string starts in it
+string text;
+map<string, unsigned int> interned;
+
+// Adds a string to the text table (once) and returns "{offset, length}"
+string intern(string_view s) {
+    string key(s);
+    map<string, unsigned int>::iterator found = interned.find(key);
+    unsigned int offset;
+    if (found != interned.end()) {
+        offset = found->second;
+    } else {
+        offset = text.size();
+        text += key;
+        interned[key] = offset;
+    }
+    return "{" + to_string(offset) + ", " + to_string(s.size()) + "}";
+}
+
+// Writes the text table as a C++ string literal, 64 bytes per line
+// Every byte outside plain printable ASCII becomes a 3-digit octal escape
+void printText() {
+    cout << "static constexpr char ASSET_TEXT[] =\n";
+    if (text.empty()) {
+        cout << "    \"\";\n\n";
+        return;
+    }
+    for (size_t start = 0; start < text.size(); start += 64) {
+        cout << "    \"";
+        for (size_t i = start; i < text.size() && i < start + 64; i++) {
+            unsigned char c = text[i];
+            if (c == '"' || c == '\\' || c == '?' || c < 32 || c > 126) {
+                const char digits[] = "01234567";
+                cout << '\\' << digits[(c >> 6) & 7] << digits[(c >> 3) & 7] << digits[c & 7];
+            } else {
+                cout << c;
+            }
+        }
+        cout << "\"";
+        if (start + 64 >= text.size()) {
+            cout << ";";
+        }
+        cout << "\n";
+    }
+    cout << "\n";
+}
+
+// Prints one table; an empty table gets a placeholder row since C++ has no empty arrays
+void printTable(const char type[], const char name[], const vector<string>& rows,
+                const char placeholder[]) {
+    cout << "static constexpr " << type << " " << name << "[] = {\n";
+    for (size_t i = 0; i < rows.size(); i++) {
+        cout << "    " << rows[i] << ",\n";
+    }
+    if (rows.empty()) {
+        cout << "    " << placeholder << ",\n";
+    }
+    cout << "};\n\n";
+}
+
+// Opens a data file and skips its header line
+bool openData(DataFile& file, const string& folder, const char name[]) {
+    string path = folder + name;
+    if (!file.open(path.c_str())) {
+        cerr << "Error: could not open " << path << endl;
+        return false;
+    }
+    string_view header;
+    file.nextLine(header);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    string folder = "";
+    if (argc > 1) {
+        folder = string(argv[1]) + "/";
+    }
+
+    DataFile file;
+    string_view line;
+    TextArena lowerCase;
+
+    vector<string> characters;
+    if (!openData(file, folder, "characters.txt")) {
+        return 1;
+    }
+    CharacterFields c;
+    while (file.nextLine(line)) {
+        if (!parseCharacterLine(line, c)) continue;
+        characters.push_back("{" + intern(c.name) + ", " + to_string(c.experience) + ", " +
+                             to_string(c.accuracy) + ", " + to_string(c.efficiency) + ", " +
+                             to_string(c.insight) + ", " + to_string(c.discoverPoints) + "}");
+    }
+
+    vector<string> events;
+    if (!openData(file, folder, "random_events.txt")) {
+        return 1;
+    }
+    EventFields e;
+    while (file.nextLine(line)) {
+        if (!parseEventLine(line, e)) continue;
+        events.push_back("{" + intern(e.description) + ", " + to_string(e.pathType) + ", " +
+                         to_string(e.advisorType) + ", " + to_string(e.dpDelta) + ", " +
+                         to_string(e.weight) + "}");
+    }
+
+    vector<string> riddles;
+    if (!openData(file, folder, "riddles.txt")) {
+        return 1;
+    }
+    RiddleFields r;
+    while (file.nextLine(line)) {
+        if (!parseRiddleLine(line, r)) continue;
+        riddles.push_back("{" + intern(r.question) + ", " + intern(r.answer) + ", " +
+                          intern(lowerCase.storeLowerCase(r.answer)) + "}");
+    }
+
+    cout << "// GENERATED by AssetCompiler.cpp from characters.txt, random_events.txt and riddles.txt\n";
+    cout << "// Do not edit by hand: rebuild with ./asset_compiler > GeneratedAssets.cpp\n\n";
+    cout << "#include \"Assets.h\"\n\n";
+
+    printText();
+    printTable("AssetCharacter", "ASSET_CHARACTERS", characters, "{{0, 0}, 0, 0, 0, 0, 0}");
+    printTable("AssetEvent", "ASSET_EVENTS", events, "{{0, 0}, 0, 0, 0, 0}");
+    printTable("AssetRiddle", "ASSET_RIDDLES", riddles, "{{0, 0}, {0, 0}, {0, 0}}");
+
+    cout << "extern const AssetBundle BUNDLED_ASSETS = {\n";
+    cout << "    ASSET_TEXT,\n";
+    cout << "    ASSET_CHARACTERS, " << characters.size() << ",\n";
+    cout << "    ASSET_EVENTS, " << events.size() << ",\n";
+    cout << "    ASSET_RIDDLES, " << riddles.size() << "\n";
+    cout << "};\n";
+    return 0;
+}
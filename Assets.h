@@ -0,0 +1,49 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+
+// Game data compiled into the program (see AssetCompiler.cpp)
+// All text lives in one shared character table; entries refer to it by offset and length
+// Identical strings are stored only once
+
+struct AssetText {
+    unsigned int offset;
+    unsigned int length;
+};
+
+struct AssetCharacter {
+    AssetText name;
+    int experience;
+    int accuracy;
+    int efficiency;
+    int insight;
+    int discoverPoints;
+};
+
+struct AssetEvent {
+    AssetText description;
+    int pathType;
+    int advisorType;
+    int dpDelta;
+    int weight;
+};
+
+struct AssetRiddle {
+    AssetText question;
+    AssetText answer;
+    AssetText answerLower;   // precomputed lowercase answer
+};
+
+struct AssetBundle {
+    const char* text;
+    const AssetCharacter* characters;
+    int characterCount;
+    const AssetEvent* events;
+    int eventCount;
+    const AssetRiddle* riddles;
+    int riddleCount;
+};
+
+// Defined in the generated file GeneratedAssets.cpp
+extern const AssetBundle BUNDLED_ASSETS;
+
+#endif
@@ -0,0 +1,249 @@
+#include "BalanceOptimizer.h"
+#include "Random.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+// =========================== Workers ===========================
+
+BalanceOptimizer::Worker::Worker() : silent(nullptr), game(silent) {
+}
+
+BalanceOptimizer::BalanceOptimizer(int threadCount) {
+    _jobs = 0;
+    _nextJob = 0;
+    _jobsLeft = 0;
+    _stopping = false;
+
+    _gamesPerCandidate = 2000;
+    _populationSize = 16;
+    _survivors = 4;
+    _generations = 20;
+    _seed = 1300;
+
+    if (threadCount < 1) {
+        threadCount = 1;
+    }
+    for (int i = 0; i < threadCount; i++) {
+        _workers.push_back(unique_ptr<Worker>(new Worker()));
+        _workers.back()->game.loadData();
+    }
+    // Start the threads only after every Game is ready
+    for (int i = 0; i < threadCount; i++) {
+        Worker* worker = _workers[i].get();
+        worker->runner = thread(&BalanceOptimizer::workerLoop, this, worker);
+    }
+}
+
+BalanceOptimizer::~BalanceOptimizer() {
+    {
+        lock_guard<mutex> guard(_lock);
+        _stopping = true;
+    }
+    _workReady.notify_all();
+    for (int i = 0; i < (int)_workers.size(); i++) {
+        _workers[i]->runner.join();
+    }
+}
+
+void BalanceOptimizer::workerLoop(Worker* worker) {
+    unique_lock<mutex> guard(_lock);
+    while (true) {
+        _workReady.wait(guard, [this]() {
+            return _stopping || (_jobs != 0 && _nextJob < (int)_jobs->size());
+        });
+        if (_stopping) {
+            return;
+        }
+
+        Job& job = (*_jobs)[_nextJob];
+        _nextJob++;
+
+        guard.unlock();
+        playGames(worker->game, job);
+        guard.lock();
+
+        _jobsLeft--;
+        if (_jobsLeft == 0) {
+            _workDone.notify_all();
+        }
+    }
+}
+
+// Hands a batch of jobs to the workers and waits until all are done
+void BalanceOptimizer::runJobs(vector<Job>& jobs) {
+    unique_lock<mutex> guard(_lock);
+    _jobs = &jobs;
+    _nextJob = 0;
+    _jobsLeft = jobs.size();
+    _workReady.notify_all();
+    _workDone.wait(guard, [this]() { return _jobsLeft == 0; });
+    _jobs = 0;
+}
+
+// Game number g always gets the same characters, advisors and seed
+void BalanceOptimizer::playGames(Game& game, Job& job) const {
+    game.setRules(*job.rules);
+    int characterCount = game.getCharacterCount();
+
+    job.fellowshipWins = 0.0;
+    for (int g = job.firstGame; g < job.firstGame + job.gameCount; g++) {
+        unsigned long long rng = mixKey(_seed, g);
+
+        int characters[2];
+        characters[0] = nextRandom(rng) % characterCount;
+        characters[1] = nextRandom(rng) % characterCount;
+        if (characterCount > 1) {
+            while (characters[1] == characters[0]) {
+                characters[1] = nextRandom(rng) % characterCount;
+            }
+        }
+
+        int advisors[2];
+        advisors[0] = 1 + nextRandom(rng) % 5;
+        advisors[1] = 1 + nextRandom(rng) % 5;
+
+        // Alternate which seat takes Training Fellowship
+        int fellowSeat = g % 2;
+        int paths[2];
+        paths[fellowSeat] = 0;
+        paths[1 - fellowSeat] = 1;
+
+        int scores[2];
+        game.simulate(characters, paths, advisors, nextRandom(rng), scores);
+
+        if (scores[fellowSeat] > scores[1 - fellowSeat]) {
+            job.fellowshipWins += 1.0;
+        } else if (scores[fellowSeat] == scores[1 - fellowSeat]) {
+            job.fellowshipWins += 0.5;
+        }
+    }
+}
+
+// =========================== Search ===========================
+
+void BalanceOptimizer::setGamesPerCandidate(int games) {
+    _gamesPerCandidate = games;
+}
+
+void BalanceOptimizer::setPopulation(int size, int survivors) {
+    _populationSize = size;
+    _survivors = survivors;
+}
+
+void BalanceOptimizer::setGenerations(int generations) {
+    _generations = generations;
+}
+
+double BalanceOptimizer::fellowshipWinRate(const GameRules& rules) {
+    // Split the games into a few jobs per worker so threads finish together
+    int jobCount = _workers.size() * 4;
+    if (jobCount > _gamesPerCandidate) {
+        jobCount = _gamesPerCandidate;
+    }
+
+    vector<Job> jobs;
+    for (int j = 0; j < jobCount; j++) {
+        Job job;
+        job.rules = &rules;
+        job.firstGame = (long)_gamesPerCandidate * j / jobCount;
+        job.gameCount = (long)_gamesPerCandidate * (j + 1) / jobCount - job.firstGame;
+        job.fellowshipWins = 0.0;
+        jobs.push_back(job);
+    }
+    runJobs(jobs);
+
+    double wins = 0.0;
+    for (int j = 0; j < jobCount; j++) {
+        wins += jobs[j].fellowshipWins;
+    }
+    return wins / _gamesPerCandidate;
+}
+
+// Child of two parents: each value is taken from one of them (uniform crossover),
+// then nudged by a random normal amount of about 10% of its size
+GameRules BalanceOptimizer::mutate(const GameRules& a, const GameRules& b,
+                                   unsigned long long& rng) const {
+    GameRules child = a;
+    for (int i = 0; i < RULE_FIELD_COUNT; i++) {
+        int GameRules::* field = RULE_FIELDS[i].value;
+        if (nextRandom(rng) % 2 == 1) {
+            child.*field = b.*field;
+        }
+
+        if (nextRandom(rng) % 3 == 0) {
+            // Box-Muller: two uniform numbers make one normally distributed one
+            double u1 = ((nextRandom(rng) >> 11) + 1.0) / 9007199254740993.0;
+            double u2 = (nextRandom(rng) >> 11) / 9007199254740992.0;
+            double normal = sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2);
+
+            double step = fabs((double)(child.*field)) * 0.1;
+            if (step < 10.0) {
+                step = 10.0;
+            }
+            child.*field += (int)lround(normal * step);
+        }
+    }
+
+    // Tile rewards must stay rewards
+    if (child.blueMaxAccuracy < 0) child.blueMaxAccuracy = 0;
+    if (child.pinkEfficiency < 0) child.pinkEfficiency = 0;
+    if (child.redInsight < 0) child.redInsight = 0;
+    if (child.brownAccuracy < 0) child.brownAccuracy = 0;
+    if (child.brownEfficiency < 0) child.brownEfficiency = 0;
+    if (child.riddleInsight < 0) child.riddleInsight = 0;
+    return child;
+}
+
+GameRules BalanceOptimizer::optimize(const GameRules& start, ostream& report) {
+    struct Candidate {
+        GameRules rules;
+        double winRate;
+        double distance;   // how far the win rate is from 50%
+    };
+
+    unsigned long long rng = _seed;
+    int survivors = _survivors;
+    if (survivors < 1) survivors = 1;
+    if (survivors > _populationSize) survivors = _populationSize;
+
+    // First generation: the starting rules plus mutated copies of them
+    vector<Candidate> population(_populationSize);
+    population[0].rules = start;
+    for (int i = 1; i < _populationSize; i++) {
+        population[i].rules = mutate(start, start, rng);
+    }
+
+    for (int generation = 0; generation < _generations; generation++) {
+        for (int i = 0; i < _populationSize; i++) {
+            population[i].winRate = fellowshipWinRate(population[i].rules);
+            population[i].distance = fabs(population[i].winRate - 0.5);
+        }
+
+        stable_sort(population.begin(), population.end(),
+                    [](const Candidate& x, const Candidate& y) { return x.distance < y.distance; });
+
+        report << "Generation " << (generation + 1) << ": best Training Fellowship win rate "
+               << population[0].winRate * 100.0 << "% (Direct Lab "
+               << (1.0 - population[0].winRate) * 100.0 << "%)" << endl;
+
+        if (generation + 1 == _generations) {
+            break;
+        }
+
+        // The survivors stay; everyone else is replaced by a child of two survivors
+        for (int i = survivors; i < _populationSize; i++) {
+            const GameRules& a = population[nextRandom(rng) % survivors].rules;
+            const GameRules& b = population[nextRandom(rng) % survivors].rules;
+            population[i].rules = mutate(a, b, rng);
+        }
+    }
+
+    report << "\n===== MOST BALANCED RULES =====\n";
+    for (int i = 0; i < RULE_FIELD_COUNT; i++) {
+        report << RULE_FIELDS[i].name << "|" << population[0].rules.*(RULE_FIELDS[i].value) << "\n";
+    }
+    return population[0].rules;
+}
@@ -0,0 +1,79 @@
+#ifndef BALANCEOPTIMIZER_H
+#define BALANCEOPTIMIZER_H
+
+#include "Game.h"
+#include "Rules.h"
+
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Searches for reward values (GameRules) that make the two paths equally strong
+//
+// A candidate is judged by simulating many games where one computer player takes
+// Training Fellowship and the other Direct Lab; the goal is a 50% win rate for each.
+// Candidates evolve with a simple genetic algorithm: the best few survive, and
+// the rest of the next generation is made by mixing and mutating them.
+// All candidates use the same game seeds, so differences come from the rules.
+//
+// The simulation threads (each with its own silent Game) are started once and
+// reused for every generation.
+
+class BalanceOptimizer {
+private:
+    // One slice of games for one candidate
+    struct Job {
+        const GameRules* rules;
+        int firstGame;
+        int gameCount;
+        double fellowshipWins;   // filled in by the worker (ties count as half)
+    };
+
+    struct Worker {
+        ostream silent;   // stream with no buffer: drops everything
+        Game game;
+        thread runner;
+
+        Worker();
+    };
+
+    vector<unique_ptr<Worker>> _workers;
+    mutex _lock;
+    condition_variable _workReady;
+    condition_variable _workDone;
+    vector<Job>* _jobs;
+    int _nextJob;
+    int _jobsLeft;
+    bool _stopping;
+
+    int _gamesPerCandidate;
+    int _populationSize;
+    int _survivors;
+    int _generations;
+    unsigned long long _seed;
+
+    void workerLoop(Worker* worker);
+    void runJobs(vector<Job>& jobs);
+    void playGames(Game& game, Job& job) const;
+    GameRules mutate(const GameRules& a, const GameRules& b, unsigned long long& rng) const;
+
+public:
+    explicit BalanceOptimizer(int threadCount);
+    ~BalanceOptimizer();
+
+    void setGamesPerCandidate(int games);
+    void setPopulation(int size, int survivors);
+    void setGenerations(int generations);
+
+    // Win rate of Training Fellowship against Direct Lab under the given rules
+    double fellowshipWinRate(const GameRules& rules);
+    // Runs the genetic algorithm from 'start'; progress is printed to 'report'
+    GameRules optimize(const GameRules& start, ostream& report);
+};
+
+#endif
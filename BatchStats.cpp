@@ -0,0 +1,95 @@
+#include "BatchStats.h"
+#include "Game.h"
+#include "Random.h"
+#include "ScoreAnalytics.h"
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Games played per simulateBatch call (rows = twice this)
+static const int BLOCK_GAMES = 4096;
+
+// Each thread plays every threadCount-th block of games into its own silent
+// Game, PlayerTable and ScoreAnalytics; nothing is shared until the final merge
+void runScoreStatistics(long games, int threadCount, const GameRules& rules, ostream& report) {
+    if (threadCount < 1) {
+        threadCount = 1;
+    }
+
+    // Character names for the report
+    ostream silent(nullptr);
+    Game names(silent);
+    names.loadData();
+    vector<string> characterNames;
+    for (int i = 0; i < names.getCharacterCount(); i++) {
+        characterNames.push_back(names.getCharacterOption(i).getName());
+    }
+    if (characterNames.empty()) {
+        report << "No characters loaded.\n";
+        return;
+    }
+
+    vector<unique_ptr<ScoreAnalytics>> results;
+    for (int t = 0; t < threadCount; t++) {
+        results.push_back(unique_ptr<ScoreAnalytics>(new ScoreAnalytics(characterNames)));
+    }
+
+    vector<thread> workers;
+    for (int t = 0; t < threadCount; t++) {
+        workers.push_back(thread([&, t]() {
+            ostream out(nullptr);
+            Game game(out);
+            game.loadData();
+            game.setRules(rules);
+            int characterCount = game.getCharacterCount();
+            ScoreAnalytics& stats = *results[t];
+
+            PlayerTable table;
+            vector<int> characters(BLOCK_GAMES * 2);
+            vector<int> paths(BLOCK_GAMES * 2);
+            vector<int> advisors(BLOCK_GAMES * 2);
+            vector<int> scores(BLOCK_GAMES * 2);
+            vector<unsigned long long> seeds(BLOCK_GAMES);
+
+            for (long start = (long)t * BLOCK_GAMES; start < games; start += (long)threadCount * BLOCK_GAMES) {
+                int count = (int)min((long)BLOCK_GAMES, games - start);
+
+                // Game g's choices come only from g, so they do not depend on the thread count
+                for (int b = 0; b < count; b++) {
+                    unsigned long long rng = mixKey(1300, start + b);
+                    int* chosen = &characters[b * 2];
+                    chosen[0] = nextRandom(rng) % characterCount;
+                    chosen[1] = nextRandom(rng) % characterCount;
+                    if (characterCount > 1) {
+                        while (chosen[1] == chosen[0]) {
+                            chosen[1] = nextRandom(rng) % characterCount;
+                        }
+                    }
+                    for (int i = 0; i < 2; i++) {
+                        paths[b * 2 + i] = nextRandom(rng) % 2;
+                        advisors[b * 2 + i] = 1 + nextRandom(rng) % 5;
+                    }
+                    seeds[b] = nextRandom(rng);
+                }
+
+                game.simulateBatch(count, characters.data(), paths.data(), advisors.data(),
+                                   seeds.data(), table, scores.data());
+                for (int r = 0; r < count * 2; r++) {
+                    stats.add(characters[r], table[r], scores[r]);
+                }
+            }
+        }));
+    }
+    for (int t = 0; t < threadCount; t++) {
+        workers[t].join();
+    }
+
+    for (int t = 1; t < threadCount; t++) {
+        results[0]->merge(*results[t]);
+    }
+    results[0]->report(report);
+}
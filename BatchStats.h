@@ -0,0 +1,13 @@
+#ifndef BATCHSTATS_H
+#define BATCHSTATS_H
+
+#include "Rules.h"
+#include <iostream>
+
+using namespace std;
+
+// Plays 'games' simulated games (random characters, paths and advisors) on
+// 'threadCount' threads and prints the score distribution (see ScoreAnalytics.h)
+void runScoreStatistics(long games, int threadCount, const GameRules& rules, ostream& report);
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef BITS_H
+#define BITS_H
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// Bit counting that works with every compiler: GCC and Clang have builtins
+// for it, MSVC has _BitScan intrinsics, and anything else gets a plain loop
+
+// Number of 0 bits above the highest 1 bit (x must not be 0)
+inline int leadingZeros(unsigned long long x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(x);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long index;
+    _BitScanReverse64(&index, x);
+    return 63 - (int)index;
+#else
+    int count = 0;
+    while ((x & (1ULL << 63)) == 0) {
+        x <<= 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+// Number of 0 bits below the lowest 1 bit (x must not be 0)
+inline int trailingZeros(unsigned long long x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return (int)index;
+#else
+    int count = 0;
+    while ((x & 1) == 0) {
+        x >>= 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+#endif
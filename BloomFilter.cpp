@@ -0,0 +1,345 @@
+#include "BloomFilter.h"
+#include "DNAUtils.h"
+#include "Random.h"
+#include "StrandIO.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+
+using namespace std;
+
+// Odd constants that turn the low 32 bits of the hash into 8 different bit
+// positions (multiply, keep the top 6 bits)
+static const unsigned int BIT_SALTS[8] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+// =========================== KmerBloomFilter ===========================
+
+KmerBloomFilter::KmerBloomFilter() {
+    _k = BLOOM_DEFAULT_K;
+    _blocks.resize(1);
+    memset(_blocks.data(), 0, sizeof(Block));
+}
+
+size_t KmerBloomFilter::blockIndex(unsigned long long hash) const {
+    // The top 32 bits scaled to the block count (no modulo needed)
+    return ((hash >> 32) * _blocks.size()) >> 32;
+}
+
+unsigned long long KmerBloomFilter::bitFor(unsigned long long hash, int word) {
+    unsigned int spread = (unsigned int)hash * BIT_SALTS[word];
+    return 1ULL << (spread >> 26);
+}
+
+void KmerBloomFilter::build(string_view strand, int k, int bitsPerKmer) {
+    _k = max(1, min(k, 32));
+    long long kmers = max(1LL, (long long)strand.size() - _k + 1);
+    long long blockCount = max(1LL, (kmers * max(bitsPerKmer, 1) + 511) / 512);
+    _blocks.assign(blockCount, Block());
+    memset(_blocks.data(), 0, _blocks.size() * sizeof(Block));
+
+    unsigned long long mask = (_k == 32) ? ~0ULL : ((1ULL << (2 * _k)) - 1);
+    unsigned long long kmer = 0;
+    int valid = 0;   // bases since the last non-ACGT character
+    for (size_t i = 0; i < strand.size(); i++) {
+        int code = baseCode(strand[i]);
+        if (code < 0) {
+            valid = 0;
+            continue;
+        }
+        kmer = ((kmer << 2) | code) & mask;
+        valid++;
+        if (valid >= _k) {
+            add(kmer);
+        }
+    }
+}
+
+void KmerBloomFilter::add(unsigned long long kmer) {
+    unsigned long long hash = splitMix64(kmer);
+    Block& block = _blocks[blockIndex(hash)];
+    for (int w = 0; w < 8; w++) {
+        block.words[w] |= bitFor(hash, w);
+    }
+}
+
+bool KmerBloomFilter::mayContain(unsigned long long kmer) const {
+    unsigned long long hash = splitMix64(kmer);
+    const Block& block = _blocks[blockIndex(hash)];
+    // Check all 8 words without branching; the block is one cache line anyway
+    unsigned long long missing = 0;
+    for (int w = 0; w < 8; w++) {
+        unsigned long long bit = bitFor(hash, w);
+        missing |= bit & ~block.words[w];
+    }
+    return missing == 0;
+}
+
+// Mismatches a window of 'length' bases may have and still reach minSimilarity
+static long long allowedMismatches(long long length, double minSimilarity) {
+    return (long long)((1 - minSimilarity) * length + 1e-9);
+}
+
+bool KmerBloomFilter::canReject(long long targetLength, double minSimilarity) const {
+    return targetLength / _k > allowedMismatches(targetLength, minSimilarity);
+}
+
+bool KmerBloomFilter::mayMatch(string_view target, double minSimilarity, int& probes) const {
+    long long length = target.size();
+    long long pieces = length / _k;
+    long long allowed = allowedMismatches(length, minSimilarity);
+    if (pieces <= allowed) {
+        return true;
+    }
+    long long missing = 0;
+    for (long long p = 0; p < pieces; p++) {
+        unsigned long long kmer = 0;
+        bool usable = true;
+        for (int i = 0; i < _k; i++) {
+            int code = baseCode(target[p * _k + i]);
+            if (code < 0) {
+                // Unknown letter: this piece cannot be checked
+                usable = false;
+                break;
+            }
+            kmer = (kmer << 2) | code;
+        }
+        if (!usable) {
+            continue;
+        }
+        probes++;
+        if (!mayContain(kmer)) {
+            missing++;
+            if (missing > allowed) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int KmerBloomFilter::getK() const {
+    return _k;
+}
+
+size_t KmerBloomFilter::getBytes() const {
+    return _blocks.size() * sizeof(Block);
+}
+
+// =========================== KmerFilterSet ===========================
+
+void KmerFilterSet::build(string_view strand) {
+    _filters.resize(BLOOM_K_COUNT);
+    for (int f = 0; f < BLOOM_K_COUNT; f++) {
+        _filters[f].build(strand, BLOOM_K_VALUES[f]);
+    }
+}
+
+const KmerBloomFilter* KmerFilterSet::choose(long long targetLength, double minSimilarity) const {
+    for (size_t f = 0; f < _filters.size(); f++) {
+        if (_filters[f].canReject(targetLength, minSimilarity)) {
+            return &_filters[f];
+        }
+    }
+    return nullptr;
+}
+
+bool KmerFilterSet::mayMatch(string_view target, double minSimilarity, int& probes) const {
+    const KmerBloomFilter* filter = choose(target.size(), minSimilarity);
+    return filter == nullptr || filter->mayMatch(target, minSimilarity, probes);
+}
+
+bool KmerFilterSet::canReject(long long targetLength, double minSimilarity) const {
+    return choose(targetLength, minSimilarity) != nullptr;
+}
+
+double KmerFilterSet::lowestCutoff(long long targetLength) const {
+    // A filter rules things out once the mismatches allowed drop below the
+    // number of pieces, so above a similarity of 1 - pieces / length
+    double lowest = 1;
+    for (size_t f = 0; f < _filters.size(); f++) {
+        long long pieces = targetLength / _filters[f].getK();
+        if (targetLength > 0) {
+            lowest = min(lowest, 1 - pieces / (double)targetLength);
+        }
+    }
+    return lowest;
+}
+
+size_t KmerFilterSet::getBytes() const {
+    size_t bytes = 0;
+    for (size_t f = 0; f < _filters.size(); f++) {
+        bytes += _filters[f].getBytes();
+    }
+    return bytes;
+}
+
+// =========================== Filter files ===========================
+
+// Layout (native byte order, like the sketch files):
+//   "GBF2", reference count (uint32)
+//   per reference: name length (uint32) + name, filter count (uint32),
+//                  per filter: k (int32), block count (uint64), blocks (64 bytes each)
+// "GBF1" files (one filter per reference, no filter count) still load
+
+static const char BLOOM_MAGIC[4] = {'G', 'B', 'F', '2'};
+static const char BLOOM_MAGIC_SINGLE[4] = {'G', 'B', 'F', '1'};
+
+void KmerBloomFilter::save(ofstream& fout) const {
+    writeValue<int>(fout, _k);
+    writeValue<unsigned long long>(fout, _blocks.size());
+    fout.write((const char*)_blocks.data(), _blocks.size() * sizeof(Block));
+}
+
+bool KmerBloomFilter::load(ifstream& fin) {
+    unsigned long long blockCount;
+    if (!readValue(fin, _k) || !readValue(fin, blockCount) || _k < 1 || _k > 32 ||
+        blockCount < 1 || blockCount > (1ULL << 32)) {
+        return false;
+    }
+    _blocks.resize(blockCount);
+    return (bool)fin.read((char*)_blocks.data(), blockCount * sizeof(Block));
+}
+
+void KmerFilterSet::save(ofstream& fout) const {
+    writeValue<unsigned int>(fout, _filters.size());
+    for (size_t f = 0; f < _filters.size(); f++) {
+        _filters[f].save(fout);
+    }
+}
+
+bool KmerFilterSet::load(ifstream& fin) {
+    unsigned int count;
+    if (!readValue(fin, count) || count > 32) {
+        return false;
+    }
+    _filters.resize(count);
+    for (unsigned int f = 0; f < count; f++) {
+        if (!_filters[f].load(fin)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool KmerFilterSet::loadSingle(ifstream& fin) {
+    _filters.resize(1);
+    return _filters[0].load(fin);
+}
+
+bool saveBloomFilters(const char filename[], const vector<string>& names,
+                      const vector<KmerFilterSet>& filters) {
+    ofstream fout(filename, ios::binary | ios::trunc);
+    if (!fout.is_open()) {
+        return false;
+    }
+    fout.write(BLOOM_MAGIC, 4);
+    writeValue<unsigned int>(fout, filters.size());
+    for (size_t f = 0; f < filters.size(); f++) {
+        writeValue<unsigned int>(fout, names[f].size());
+        fout.write(names[f].data(), names[f].size());
+        filters[f].save(fout);
+    }
+    return fout.good();
+}
+
+bool loadBloomFilters(const char filename[], vector<string>& names, vector<KmerFilterSet>& filters) {
+    ifstream fin(filename, ios::binary);
+    char magic[4];
+    unsigned int count;
+    if (!fin.read(magic, 4)) {
+        return false;
+    }
+    bool single = memcmp(magic, BLOOM_MAGIC_SINGLE, 4) == 0;
+    if ((!single && memcmp(magic, BLOOM_MAGIC, 4) != 0) || !readValue(fin, count)) {
+        return false;
+    }
+    names.resize(count);
+    filters.resize(count);
+    for (unsigned int f = 0; f < count; f++) {
+        unsigned int nameLength;
+        if (!readValue(fin, nameLength) || nameLength > (1 << 20)) {
+            return false;
+        }
+        names[f].resize(nameLength);
+        fin.read(&names[f][0], nameLength);
+        if (!fin || !(single ? filters[f].loadSingle(fin) : filters[f].load(fin))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// =========================== Command line tools ===========================
+
+int buildBloomFilterFile(const char strandFile[], const char filterFile[], ostream& out) {
+    vector<string> names;
+    vector<string> strands;
+    if (!readStrands(strandFile, names, strands)) {
+        out << "Error: could not read " << strandFile << endl;
+        return 1;
+    }
+    vector<KmerFilterSet> filters(strands.size());
+    size_t bytes = 0;
+    for (size_t s = 0; s < strands.size(); s++) {
+        filters[s].build(strands[s]);
+        bytes += filters[s].getBytes();
+    }
+    if (!saveBloomFilters(filterFile, names, filters)) {
+        out << "Error: could not write " << filterFile << endl;
+        return 1;
+    }
+    out << "Saved " << filters.size() << " filters (" << bytes / 1024 << " KB) to " << filterFile << endl;
+    return 0;
+}
+
+int filteredBestMatch(const char strandFile[], const char filterFile[], const char targetFile[],
+                      double minSimilarity, ostream& out) {
+    vector<string> names;
+    vector<string> strands;
+    vector<string> filterNames;
+    vector<KmerFilterSet> filters;
+    vector<string> targetNames;
+    vector<string> targets;
+    if (!readStrands(strandFile, names, strands)) {
+        out << "Error: could not read " << strandFile << endl;
+        return 1;
+    }
+    if (!loadBloomFilters(filterFile, filterNames, filters) || filterNames != names) {
+        out << "Error: " << filterFile << " is not the filter file of " << strandFile << endl;
+        return 1;
+    }
+    if (!readStrands(targetFile, targetNames, targets) || targets.size() == 0 || targets[0].size() == 0) {
+        out << "Error: could not read a target strand from " << targetFile << endl;
+        return 1;
+    }
+    const string& target = targets[0];
+    int length = target.size();
+
+    out << fixed << setprecision(4);
+    if (filters.size() > 0 && !filters[0].canReject(length, minSimilarity)) {
+        out << "Warning: at a similarity of " << minSimilarity << " the filters cannot rule out any reference for a "
+            << length << "-base target, so every reference is scanned (use a cutoff above "
+            << filters[0].lowestCutoff(length) << ")" << endl;
+    }
+    int scanned = 0;
+    int matched = 0;
+    int probes = 0;
+    for (size_t s = 0; s < strands.size(); s++) {
+        if (strands[s].size() < target.size() || !filters[s].mayMatch(target, minSimilarity, probes)) {
+            continue;
+        }
+        scanned++;
+        StrandMatch best = findBestMatch(strands[s], target);
+        double similarity = best.matches / (double)length;
+        if (similarity >= minSimilarity) {
+            out << names[s] << "\tindex " << best.index << "\tsimilarity " << similarity << endl;
+            matched++;
+        }
+    }
+    out << matched << " matches; scanned " << scanned << " of " << strands.size()
+        << " references (" << probes << " filter probes)" << endl;
+    return 0;
+}
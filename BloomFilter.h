@@ -0,0 +1,121 @@
+#ifndef BLOOMFILTER_H
+#define BLOOMFILTER_H
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// Quick "can this reference strand contain the target?" test, so that
+// bestStrandMatch only has to scan the references that might
+//
+// Each reference gets a Bloom filter of its k-mers (every run of k bases).
+// A Bloom filter answers "was this k-mer added?" with either "no" (always
+// right) or "maybe" (wrong about 1% of the time at 10 bits per k-mer).
+//
+// Blocked: the filter is split into 64-byte blocks (one cache line). One hash
+// picks the block and 8 bits inside it, so a lookup touches a single cache
+// line instead of 8 random ones.
+//
+// The test itself is the pigeonhole rule: cut the target into m / k pieces
+// that do not overlap. A window of the reference with at most e mismatches
+// leaves at least (m / k - e) of those pieces untouched, and an untouched
+// piece is a k-mer of the reference. So once more than e pieces are missing
+// from the filter, no window can reach the similarity, and we stop probing.
+// For low similarity cutoffs (e >= m / k, so a similarity of 1 - 1/k or
+// less) nothing can be ruled out.
+// K-mers with letters other than A, C, G, T are left out on both sides.
+//
+// Which k: a long k-mer almost never turns up in a reference by chance, so
+// it rules references out best, but it only works for cutoffs above 1 - 1/k
+// (0.9375 for k = 16). So every reference gets a filter for each k in
+// BLOOM_K_VALUES, and a search uses the longest k that works for its cutoff:
+// k = 16 above 0.9375, k = 12 above 0.917, k = 8 above 0.875. Below that
+// every reference is scanned (--filter-match prints a warning).
+
+const int BLOOM_DEFAULT_K = 16;           // k-mer length (at most 32)
+const int BLOOM_BITS_PER_KMER = 10;       // about 1% false "maybe"s
+
+// k of the filters built for each reference, longest first
+const int BLOOM_K_COUNT = 3;
+const int BLOOM_K_VALUES[BLOOM_K_COUNT] = {16, 12, 8};
+
+class KmerBloomFilter {
+private:
+    struct alignas(64) Block {
+        unsigned long long words[8];
+    };
+
+    int _k;
+    vector<Block> _blocks;
+
+    // The block and the bit in each of its 8 words for one k-mer
+    size_t blockIndex(unsigned long long hash) const;
+    static unsigned long long bitFor(unsigned long long hash, int word);
+
+public:
+    KmerBloomFilter();
+
+    // Adds every k-mer of the strand (replaces what was there)
+    void build(string_view strand, int k = BLOOM_DEFAULT_K, int bitsPerKmer = BLOOM_BITS_PER_KMER);
+
+    // kmer is 2-bit packed, first base in the highest bits (A=0 C=1 G=2 T=3)
+    void add(unsigned long long kmer);
+    bool mayContain(unsigned long long kmer) const;
+
+    // False if no window of the reference can be at least minSimilarity
+    // like the target (see above). 'probes' counts the filter lookups made
+    bool mayMatch(string_view target, double minSimilarity, int& probes) const;
+    // False if mayMatch always says true for targets this long at this cutoff
+    bool canReject(long long targetLength, double minSimilarity) const;
+
+    int getK() const;
+    size_t getBytes() const;
+
+    void save(ofstream& fout) const;
+    bool load(ifstream& fin);
+};
+
+// The filters of one reference, one per k (see "Which k" above)
+class KmerFilterSet {
+private:
+    vector<KmerBloomFilter> _filters;   // longest k first
+
+    // The filter with the longest k that can rule anything out, or nullptr
+    const KmerBloomFilter* choose(long long targetLength, double minSimilarity) const;
+
+public:
+    // Builds a filter for every k in BLOOM_K_VALUES
+    void build(string_view strand);
+
+    bool mayMatch(string_view target, double minSimilarity, int& probes) const;
+    // False if none of the filters can rule anything out for this target and cutoff
+    bool canReject(long long targetLength, double minSimilarity) const;
+    // The lowest cutoff (exclusive) at which some filter can rule anything out
+    double lowestCutoff(long long targetLength) const;
+
+    size_t getBytes() const;
+
+    void save(ofstream& fout) const;
+    bool load(ifstream& fin);
+    // Older single-filter files
+    bool loadSingle(ifstream& fin);
+};
+
+// Filter files: one filter set per strand of a strand file (see BloomFilter.cpp for the layout)
+bool saveBloomFilters(const char filename[], const vector<string>& names,
+                      const vector<KmerFilterSet>& filters);
+bool loadBloomFilters(const char filename[], vector<string>& names, vector<KmerFilterSet>& filters);
+
+// Command line helpers (return the exit code)
+// Builds a filter for every strand in a strand file (see StrandIO.h) and saves them
+int buildBloomFilterFile(const char strandFile[], const char filterFile[], ostream& out);
+// Best match of the target (first strand of targetFile) in every reference
+// that passes the filter; prints the ones at least minSimilarity alike
+int filteredBestMatch(const char strandFile[], const char filterFile[], const char targetFile[],
+                      double minSimilarity, ostream& out);
+
+#endif
@@ -1,5 +1,7 @@
 // Source file calling the header file
 #include "Board.h"
+#include "Random.h"
+#include "Trace.h"
 // Recall we use this preprocessor directive for rand() and srand()
 #include <cstdlib>
 // Similarly, we use this one for time() (The seed for random)
@@ -32,68 +34,116 @@ Board::Board() {
         _player_position[i] = 0;
     }
 
+    // Original board: 52 tiles with 30 greens on the 50 middle tiles
+    _board_size = _DEFAULT_BOARD_SIZE;
+    _green_count = 30;
+
     // Fill both lanes
     initializeBoard();
 }
+
+Board::Board(int board_size, unsigned long long seed) {
+    _player_count = _MAX_PLAYERS;
+
+    for (int i = 0; i < _player_count; i++) {
+        _player_position[i] = 0;
+    }
+
+    // Need at least a start tile and a finish tile
+    if (board_size < 2) {
+        board_size = 2;
+    }
+    _board_size = board_size;
+
+    // Keep the same 30-out-of-50 green ratio as the default board
+    _green_count = (int)(((long long)(_board_size - 2) * 30) / 50);
+
+    initializeBoard(seed);
+}
+
 char Board::getTileColor(int player_index, int pos) const {
     if (player_index >= 0 && player_index < _player_count &&
-        pos >= 0 && pos < _BOARD_SIZE) {
-        return _tiles[player_index][pos].color;
+        pos >= 0 && pos < _board_size) {
+        return computeTileColor(player_index, pos);
     }
     return ' '; // default / error
 }
 
+Tile Board::getTile(int lane_index, int pos) const {
+    Tile tile;
+    tile.color = getTileColor(lane_index, pos);
+    return tile;
+}
+
 int Board::getBoardSize() const {
-    return _BOARD_SIZE;
+    return _board_size;
+}
+
+int Board::getGreenCount() const {
+    return _green_count;
+}
+
+unsigned long long Board::getSeed() const {
+    return _seed;
 }
 // =========================== Private Member Functions ===========================
 
-void Board::initializeTiles(int player_index) {
-    Tile tile;
-    int green_count = 0;
-    // Recall 52 from header file
-    int total_tiles = _BOARD_SIZE;
-
-    for (int i = 0; i < total_tiles; i++) {
-        // Set the last tile as Orange for the finish line
-        if (i == total_tiles - 1) {
-            tile.color = 'O';
-        } 
-        // Set the first tile as Grey for the starting line
-        else if (i == 0) {
-            tile.color = 'Y';
-        } 
-        // Hard-coded target of 30 green tiles
-        // Probablisitic method to spread out the green tiles randomly
-        else if (green_count < 30 && (rand() % (total_tiles - i) < 30 - green_count)) {
-            tile.color = 'G';
-            green_count++;
-        }
-        // Randomly assign one of the other colors: Blue, Pink, Brown, Red, Purple
-        else {
-            int color_choice = rand() % 5;
-            switch (color_choice) {
-                case 0:
-                    tile.color = 'B'; // Blue
-                    break;
-                case 1:
-                    tile.color = 'P'; // Pink
-                    break;
-                case 2:
-                    tile.color = 'T'; // Brown
-                    break;
-                case 3:
-                    tile.color = 'R'; // Red
-                    break;
-                case 4:
-                    tile.color = 'U'; // Purple
-                    break;
-            }
+// Shuffles the middle tiles (1 to size - 2) of one lane without storing them
+// A small Feistel network is a bijection on a power-of-4 range, and "cycle walking"
+// (re-applying it until the value lands inside the lane) turns it into a bijection
+// on exactly the middle tiles. The range is less than 4x the lane, so this is O(1) on average
+unsigned long long Board::permuteInterior(int lane_index, unsigned long long index) const {
+    unsigned long long n = (unsigned long long)(_board_size - 2);
+
+    // Smallest even number of bits that covers n
+    int bits = 2;
+    while (bits < 62 && (1ULL << bits) < n) {
+        bits += 2;
+    }
+    int half_bits = bits / 2;
+    unsigned long long half_mask = (1ULL << half_bits) - 1;
+    unsigned long long lane_key = mixKey(_seed, (unsigned long long)lane_index);
+
+    unsigned long long x = index;
+    do {
+        unsigned long long left = x >> half_bits;
+        unsigned long long right = x & half_mask;
+        for (int round = 0; round < 4; round++) {
+            unsigned long long next = left ^ (mixKey(lane_key + round, right) & half_mask);
+            left = right;
+            right = next;
         }
+        x = (left << half_bits) | right;
+    } while (x >= n);
+
+    return x;
+}
+
+char Board::computeTileColor(int lane_index, int pos) const {
+    // Set the last tile as Orange for the finish line
+    if (pos == _board_size - 1) {
+        return 'O';
+    }
+    // Set the first tile as Grey for the starting line
+    if (pos == 0) {
+        return 'Y';
+    }
 
-        // Assign the tile to the board for the specified lane/player 1 or 2
-        // Recall i refers to tile 0 to 51
-        _tiles[player_index][i] = tile;
+    // Exactly _green_count middle tiles are green: the ones the shuffle sends to the front
+    if (permuteInterior(lane_index, (unsigned long long)(pos - 1)) < (unsigned long long)_green_count) {
+        return 'G';
+    }
+
+    // Randomly assign one of the other colors: Blue, Pink, Brown, Red, Purple
+    // The hash of (seed, lane, position) plays the role of rand() here
+    unsigned long long roll = mixKey(mixKey(_seed, (unsigned long long)lane_index + 0x100),
+                                     (unsigned long long)pos);
+    switch (roll % 5) {
+        case 0: return 'B'; // Blue
+        case 1: return 'P'; // Pink
+        case 2: return 'T'; // Brown
+        case 3: return 'R'; // Red
+        default: return 'U'; // Purple
     }
 }
 
@@ -104,12 +154,12 @@ bool Board::isPlayerOnTile(int player_index, int pos) {
     return false;
 }
 
-void Board::displayTile(int player_index, int pos) {
-    string color = "";
+void Board::displayTile(int player_index, int pos, ostream& out) {
+    const char* color = "";   // not a string: the codes are too long to fit without a malloc
     int player = isPlayerOnTile(player_index, pos);
 
     // Using the defined nicenames above
-    switch(_tiles[player_index][pos].color) {
+    switch(computeTileColor(player_index, pos)) {
         case 'O': color = ORANGE; break;
         case 'Y': color = GREY; break;
         case 'G': color = GREEN; break;
@@ -122,44 +172,52 @@ void Board::displayTile(int player_index, int pos) {
 
     // Template for displaying a tile: <line filler space> <color start> |<player symbol or blank space>| <reset color> <line filler space> <endl>
     if (player == true) {
-        cout << color << "|" << (player_index + 1) << "|" << RESET;
+        out << color << "|" << (player_index + 1) << "|" << RESET;
     }
     else {
-        cout << color << "| |" << RESET;
+        out << color << "| |" << RESET;
     }
 }
 
 // =========================== Public Member Functions ===========================
 
 void Board::initializeBoard() {
-    for (int i = 0; i < 2; i++) {
-        // This ensures each lane (or each player) has a unique tile distribution
-        initializeTiles(i);
-    }
+    // Pick a fresh board seed. rand() only gives 15 to 31 bits (RAND_MAX is
+    // 32767 on some compilers), so two calls are mixed to spread over all 64
+    unsigned long long seed = mixKey((unsigned long long)rand(), (unsigned long long)rand());
+    initializeBoard(seed);
+}
+
+void Board::initializeBoard(unsigned long long seed) {
+    // Nothing to fill in: every lane is generated lazily from this seed
+    // The lane index is part of the hash, so each lane still has a unique tile distribution
+    _seed = seed;
 }
 
-void Board::displayTrack(int player_index) {
-    for (int i = 0; i < _BOARD_SIZE; i++) {
-        displayTile(player_index, i);
+void Board::displayTrack(int player_index, ostream& out) {
+    for (int i = 0; i < _board_size; i++) {
+        displayTile(player_index, i, out);
     }
-    cout << endl;
+    out << endl;
 }
 
-void Board::displayBoard() {
-    for (int i = 0; i < 2; i++) {
-        displayTrack(i);
+void Board::displayBoard(ostream& out) {
+    TRACE_SCOPE("displayBoard");
+    for (int i = 0; i < _LANE_COUNT; i++) {
+        displayTrack(i, out);
         if (i == 0) {
-            cout << endl; // Add an extra line between the two lanes
+            out << endl; // Add an extra line between the two lanes
         }
     }
 }
 
 bool Board::movePlayer(int player_index) {
+    TRACE_SCOPE("movePlayer");
     // Increment player position by 1
     _player_position[player_index]++;
 
     // Player reached last tile
-    if (_player_position[player_index] == _BOARD_SIZE - 1) {
+    if (_player_position[player_index] == _board_size - 1) {
         return true;
     }
 
@@ -172,3 +230,10 @@ int Board::getPlayerPosition(int player_index) const {
     }
     return -1;
 }
+
+void Board::setPlayerPosition(int player_index, int pos) {
+    if (player_index >= 0 && player_index < _player_count &&
+        pos >= 0 && pos < _board_size) {
+        _player_position[player_index] = pos;
+    }
+}
@@ -4,35 +4,48 @@
 #define BOARD_H
 
 #include "Tile.h"
+#include <iostream>
 
 class Board {
     private:
         // Static in this context: Belongs to the class, not each object
-        static const int _BOARD_SIZE = 52;
+        static const int _DEFAULT_BOARD_SIZE = 52;
         static const int _MAX_PLAYERS = 2;
+        static const int _LANE_COUNT = 2;
 
-        // Composition!
-        Tile _tiles[2][_BOARD_SIZE];
+        // Tiles are no longer stored: each color is computed on demand
+        // from (seed, lane, position), so memory stays the same for any board length
+        int _board_size;
+        int _green_count;
+        unsigned long long _seed;
 
         int _player_count;
         int _player_position[_MAX_PLAYERS];
 
-        void initializeTiles(int player_index);
+        unsigned long long permuteInterior(int lane_index, unsigned long long index) const;
+        char computeTileColor(int lane_index, int pos) const;
         bool isPlayerOnTile(int player_index, int pos);
-        void displayTile(int player_index, int pos);
+        void displayTile(int player_index, int pos, std::ostream& out);
 
     public:
         // Default Constructor
         Board();
+        // Parameterized Constructor (used for very long stress boards)
+        Board(int board_size, unsigned long long seed);
 
         void initializeBoard();
-        void displayTrack(int player_index);
-        void displayBoard();
+        void initializeBoard(unsigned long long seed);
+        void displayTrack(int player_index, std::ostream& out = std::cout);
+        void displayBoard(std::ostream& out = std::cout);
         bool movePlayer(int player_index);
         // Recall we can use const for getter functions
         int getPlayerPosition(int player_index) const;
+        void setPlayerPosition(int player_index, int pos);
+        Tile getTile(int lane_index, int position) const;
         char getTileColor(int lane_index, int position) const;
         int getBoardSize() const;
+        int getGreenCount() const;
+        unsigned long long getSeed() const;
 };
 
 #endif
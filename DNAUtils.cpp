@@ -1,64 +1,120 @@
 #include "DNAUtils.h"
+#include "Alignment.h"
+#include "Trace.h"
+#include <algorithm>
 #include <iostream>
 
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
 using namespace std;
 
+// Compare kernel shared by the similarity functions
+// Equal bytes compare to 0xFF (-1), so subtracting the comparison adds 1 per match
+// to a byte counter. Every 255 steps (before a byte can overflow) the counters
+// are summed with _mm_sad_epu8 / _mm256_sad_epu8.
+int countMatches(const char a[], const char b[], int length) {
+    long long matches = 0;
+    int i = 0;
+#if defined(__AVX2__)
+    while (i + 32 <= length) {
+        __m256i counts = _mm256_setzero_si256();
+        int stop = i + min(255 * 32, (length - i) / 32 * 32);
+        for (; i < stop; i += 32) {
+            __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+            __m256i y = _mm256_loadu_si256((const __m256i*)(b + i));
+            counts = _mm256_sub_epi8(counts, _mm256_cmpeq_epi8(x, y));
+        }
+        __m256i sums = _mm256_sad_epu8(counts, _mm256_setzero_si256());
+        matches += _mm256_extract_epi64(sums, 0) + _mm256_extract_epi64(sums, 1) +
+                   _mm256_extract_epi64(sums, 2) + _mm256_extract_epi64(sums, 3);
+    }
+#endif
+#if defined(__SSE2__)
+    while (i + 16 <= length) {
+        __m128i counts = _mm_setzero_si128();
+        int stop = i + min(255 * 16, (length - i) / 16 * 16);
+        for (; i < stop; i += 16) {
+            __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+            __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+            counts = _mm_sub_epi8(counts, _mm_cmpeq_epi8(x, y));
+        }
+        __m128i sums = _mm_sad_epu8(counts, _mm_setzero_si128());
+        matches += _mm_cvtsi128_si64(sums) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(sums, sums));
+    }
+#endif
+    // Leftover bases (or every base without SIMD)
+    for (; i < length; i++) {
+        if (a[i] == b[i]) {
+            matches++;
+        }
+    }
+    return matches;
+}
+
 // Blue tiles: equal-length similarity
-double strandSimilarity(string strand1, string strand2) {
+double strandSimilarity(string_view strand1, string_view strand2, ostream& out, bool allowIndels) {
+    TRACE_SCOPE("strandSimilarity");
+    if (allowIndels && strand1.length() > 0 && strand2.length() > 0) {
+        double aligned = alignStrands(strand1, strand2).identity;
+        out << "Similarity score: " << aligned << endl;
+        return aligned;
+    }
     if (strand1.length() != strand2.length() || strand1.length() == 0) {
-        cout << "Strands must be the same non-zero length.\n";
+        out << "Strands must be the same non-zero length.\n";
         return 0.0;
     }
 
-    int matches = 0;
-    for (int i = 0; i < strand1.length(); i++) {
-        if (strand1[i] == strand2[i]) {
-            matches++;
-        }
-    }
+    int matches = countMatches(strand1.data(), strand2.data(), strand1.length());
 
     double score = matches / static_cast<double>(strand1.length());
-    cout << "Similarity score: " << score << endl;
+    out << "Similarity score: " << score << endl;
     return score;
 }
 
 // Pink tiles: unequal-length best match
-int bestStrandMatch(string input_strand, string target_strand) {
+StrandMatch findBestMatch(string_view input_strand, string_view target_strand) {
+    StrandMatch best = {-1, -1};
+    if (target_strand.length() == 0 || target_strand.length() > input_strand.length()) {
+        return best;
+    }
+    int length = target_strand.length();
+    int maxStart = input_strand.length() - target_strand.length();
+    for (int start = 0; start <= maxStart; start++) {
+        int matches = countMatches(input_strand.data() + start, target_strand.data(), length);
+        // Only a strictly better count replaces the best, so ties keep the earliest start
+        if (matches > best.matches) {
+            best.matches = matches;
+            best.index = start;
+        }
+    }
+    return best;
+}
+
+int bestStrandMatch(string_view input_strand, string_view target_strand, ostream& out) {
+    TRACE_SCOPE("bestStrandMatch");
     if (input_strand.length() == 0 || target_strand.length() == 0) {
-        cout << "Strands must be non-empty.\n";
+        out << "Strands must be non-empty.\n";
         return -1;
     }
     if (target_strand.length() > input_strand.length()) {
-        cout << "Target strand cannot be longer than input strand.\n";
+        out << "Target strand cannot be longer than input strand.\n";
         return -1;
     }
 
-    double bestScore = -1.0;
-    int bestIndex = -1;
-    int maxStart = input_strand.length() - target_strand.length();
-
-    for (int start = 0; start <= maxStart; start++) {
-        int matches = 0;
-        for (int j = 0; j < target_strand.length(); j++) {
-            if (input_strand[start + j] == target_strand[j]) {
-                matches++;
-            }
-        }
-        double score = matches / static_cast<double>(target_strand.length());
-        if (score > bestScore) {
-            bestScore = score;
-            bestIndex = start;
-        }
-    }
+    StrandMatch best = findBestMatch(input_strand, target_strand);
+    double bestScore = best.matches / static_cast<double>(target_strand.length());
 
-    cout << "Best match starts at index " << bestIndex
+    out << "Best match starts at index " << best.index
          << " with similarity " << bestScore << endl;
-    return bestIndex;
+    return best.index;
 }
 
 // Red tiles: mutation identification (simple version)
-void identifyMutations(string input_strand, string target_strand) {
-    cout << "Comparing input vs target for mutations...\n";
+void identifyMutations(string_view input_strand, string_view target_strand, ostream& out) {
+    TRACE_SCOPE("identifyMutations");
+    out << "Comparing input vs target for mutations...\n";
 
     int i = 0;
     int j = 0;
@@ -68,7 +124,7 @@ void identifyMutations(string input_strand, string target_strand) {
             j++;
         } else {
             // Simple heuristic: treat as substitution
-            cout << "Substitution at position " << i
+            out << "Substitution at position " << i
                  << ": " << target_strand[j] << " -> " << input_strand[i] << endl;
             i++;
             j++;
@@ -77,28 +133,29 @@ void identifyMutations(string input_strand, string target_strand) {
 
     // Extra bases in input_strand
     while (i < input_strand.length()) {
-        cout << "Insertion at position " << i
+        out << "Insertion at position " << i
              << ": extra base '" << input_strand[i] << "' in input strand.\n";
         i++;
     }
 
     // Missing bases in input_strand (extra in target)
     while (j < target_strand.length()) {
-        cout << "Deletion at position " << j
+        out << "Deletion at position " << j
              << ": missing base '" << target_strand[j] << "' from input strand.\n";
         j++;
     }
 }
 
 // Brown tiles: DNA -> RNA transcription
-void transcribeDNAtoRNA(string strand) {
-    cout << "RNA sequence: ";
+void transcribeDNAtoRNA(string_view strand, ostream& out) {
+    TRACE_SCOPE("transcribeDNAtoRNA");
+    out << "RNA sequence: ";
     for (int i = 0; i < strand.length(); i++) {
         char base = strand[i];
         if (base == 'T') {
             base = 'U';
         }
-        cout << base;
+        out << base;
     }
-    cout << endl;
+    out << endl;
 }
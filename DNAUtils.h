@@ -1,12 +1,33 @@
-
 #ifndef DNAUTILS_H
 #define DNAUTILS_H
 
+#include <iostream>
 #include <string>
+#include <string_view>
+
+// Number of positions where a[i] == b[i] for i < length
+// Compares 32 bases at a time with AVX2 (16 with SSE2) when the compiler allows it
+int countMatches(const char a[], const char b[], int length);
+
+// Where the target lines up best inside the input, without printing anything:
+// the start with the most matching bases (the earliest one if several tie).
+// index and matches are -1 if the target is empty or longer than the input.
+// bestStrandMatch and the file versions of it (--scan-match, --filter-match,
+// --match-all) all search with this
+struct StrandMatch {
+    int index;
+    int matches;
+};
+StrandMatch findBestMatch(std::string_view input_strand, std::string_view target_strand);
 
-double strandSimilarity(std::string strand1, std::string strand2);
-int bestStrandMatch(std::string input_strand, std::string target_strand);
-void identifyMutations(std::string input_strand, std::string target_strand);
-void transcribeDNAtoRNA(std::string strand);
+// Each function prints its result to 'out' (the console unless told otherwise)
+// Strands are passed as string_views, so calling them copies nothing
+// With allowIndels the strands are aligned first (see Alignment.h), so they
+// may differ in length by a few inserted or deleted bases
+double strandSimilarity(std::string_view strand1, std::string_view strand2, std::ostream& out = std::cout,
+                        bool allowIndels = false);
+int bestStrandMatch(std::string_view input_strand, std::string_view target_strand, std::ostream& out = std::cout);
+void identifyMutations(std::string_view input_strand, std::string_view target_strand, std::ostream& out = std::cout);
+void transcribeDNAtoRNA(std::string_view strand, std::ostream& out = std::cout);
 
 #endif
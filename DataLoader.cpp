@@ -0,0 +1,251 @@
+#include "DataLoader.h"
+#include <charconv>
+#include <cstring>
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// =========================== TextArena ===========================
+
+TextArena::TextArena() {
+    _used = 0;
+    _capacity = 0;
+}
+
+string_view TextArena::store(string_view text) {
+    // Start a new block when the text does not fit in the current one
+    if (_used + text.size() > _capacity) {
+        size_t block_size = text.size() > _BLOCK_SIZE ? text.size() : _BLOCK_SIZE;
+        _blocks.push_back(unique_ptr<char[]>(new char[block_size]));
+        _used = 0;
+        _capacity = block_size;
+    }
+
+    char* dest = _blocks.back().get() + _used;
+    if (!text.empty()) {
+        memcpy(dest, text.data(), text.size());
+    }
+    _used += text.size();
+    return string_view(dest, text.size());
+}
+
+string_view TextArena::storeLowerCase(string_view text) {
+    string_view stored = store(text);
+    char* dest = (char*)stored.data();
+    for (size_t i = 0; i < stored.size(); i++) {
+        if (dest[i] >= 'A' && dest[i] <= 'Z') {
+            dest[i] = dest[i] - 'A' + 'a';
+        }
+    }
+    return stored;
+}
+
+void TextArena::clear() {
+    _blocks.clear();
+    _used = 0;
+    _capacity = 0;
+}
+
+// =========================== DataFile ===========================
+
+DataFile::DataFile() {
+    _data = 0;
+    _size = 0;
+    _pos = 0;
+    _mapped = false;
+}
+
+DataFile::~DataFile() {
+    release();
+}
+
+void DataFile::release() {
+#ifndef _WIN32
+    if (_mapped) {
+        munmap((void*)_data, _size);
+    }
+#endif
+    _fallback.clear();
+    _data = 0;
+    _size = 0;
+    _pos = 0;
+    _mapped = false;
+}
+
+bool DataFile::open(const char filename[]) {
+    release();
+
+#ifdef _WIN32
+    ifstream fin(filename, ios::binary | ios::ate);
+    if (!fin.is_open()) {
+        return false;
+    }
+    _fallback.resize(fin.tellg());
+    fin.seekg(0);
+    if (!_fallback.empty()) {
+        fin.read(&_fallback[0], _fallback.size());
+    }
+    _data = _fallback.empty() ? 0 : &_fallback[0];
+    _size = _fallback.size();
+    return true;
+#else
+    int fd = ::open(filename, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return false;
+    }
+
+    // An empty file cannot be mapped, but it is still a valid (empty) file
+    if (info.st_size > 0) {
+        void* map = mmap(0, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        _data = (const char*)map;
+        _size = info.st_size;
+        _mapped = true;
+    }
+    close(fd);
+    return true;
+#endif
+}
+
+bool DataFile::nextLine(string_view& line) {
+    if (_pos >= _size) {
+        return false;
+    }
+
+    const char* start = _data + _pos;
+    const char* end = (const char*)memchr(start, '\n', _size - _pos);
+    size_t length = end ? (size_t)(end - start) : _size - _pos;
+
+    // Move past the line and its '\n'
+    _pos += length + (end ? 1 : 0);
+
+    // Drop the '\r' of Windows line endings
+    if (length > 0 && start[length - 1] == '\r') {
+        length--;
+    }
+    line = string_view(start, length);
+    return true;
+}
+
+size_t DataFile::size() const {
+    return _size;
+}
+
+// =========================== Field helpers ===========================
+
+int splitFields(string_view line, string_view fields[], int max_fields) {
+    int count = 0;
+    size_t start = 0;
+
+    while (count < max_fields - 1) {
+        size_t bar = line.find('|', start);
+        if (bar == string_view::npos) {
+            break;
+        }
+        fields[count] = line.substr(start, bar - start);
+        count++;
+        start = bar + 1;
+    }
+
+    // Whatever is left is the last field
+    fields[count] = line.substr(start);
+    count++;
+    return count;
+}
+
+bool parseIntField(string_view field, int& value) {
+    // Trim spaces and tabs on both sides
+    while (!field.empty() && (field.front() == ' ' || field.front() == '\t')) {
+        field.remove_prefix(1);
+    }
+    while (!field.empty() && (field.back() == ' ' || field.back() == '\t')) {
+        field.remove_suffix(1);
+    }
+
+    // from_chars does not accept a leading '+', stoi did
+    if (!field.empty() && field.front() == '+') {
+        field.remove_prefix(1);
+    }
+
+    const char* end = field.data() + field.size();
+    from_chars_result result = from_chars(field.data(), end, value);
+    return result.ec == errc() && result.ptr == end && !field.empty();
+}
+
+// =========================== Line parsers ===========================
+
+// name|experience|accuracy|efficiency|insight|discoveryPoints
+bool parseCharacterLine(string_view line, CharacterFields& character) {
+    if (line.empty()) {
+        return false;
+    }
+
+    string_view fields[6];
+    if (splitFields(line, fields, 6) != 6) {
+        return false;
+    }
+
+    character.name = fields[0];
+    return parseIntField(fields[1], character.experience) &&
+           parseIntField(fields[2], character.accuracy) &&
+           parseIntField(fields[3], character.efficiency) &&
+           parseIntField(fields[4], character.insight) &&
+           parseIntField(fields[5], character.discoverPoints);
+}
+
+// description|pathType|advisorType|dpDelta[|weight]  (lines starting with '/' are comments)
+bool parseEventLine(string_view line, EventFields& event) {
+    if (line.empty() || line[0] == '/') {
+        return false;
+    }
+
+    string_view fields[5];
+    int count = splitFields(line, fields, 5);
+    if (count < 4) {
+        return false;
+    }
+
+    // Events without a weight are all equally likely
+    event.weight = 1;
+    if (count == 5 && !parseIntField(fields[4], event.weight)) {
+        return false;
+    }
+
+    event.description = fields[0];
+    return parseIntField(fields[1], event.pathType) &&
+           parseIntField(fields[2], event.advisorType) &&
+           parseIntField(fields[3], event.dpDelta);
+}
+
+// question|answer  (only the first '|' splits, so answers such as "||" still work)
+bool parseRiddleLine(string_view line, RiddleFields& riddle) {
+    if (line.empty()) {
+        return false;
+    }
+
+    string_view fields[2];
+    if (splitFields(line, fields, 2) != 2) {
+        return false;
+    }
+
+    riddle.question = fields[0];
+    riddle.answer = fields[1];
+    return true;
+}
@@ -0,0 +1,87 @@
+#ifndef DATALOADER_H
+#define DATALOADER_H
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// Stores many small strings in a few large blocks
+// Strings handed out by store() stay valid until clear(), because blocks never move
+class TextArena {
+private:
+    static const size_t _BLOCK_SIZE = 64 * 1024;
+
+    vector<unique_ptr<char[]>> _blocks;
+    size_t _used;       // bytes used in the last block
+    size_t _capacity;   // size of the last block
+
+public:
+    TextArena();
+
+    string_view store(string_view text);
+    // Same as store, but 'A'..'Z' are turned into 'a'..'z' on the way in
+    string_view storeLowerCase(string_view text);
+    void clear();
+};
+
+// A whole data file mapped into memory, read one line at a time without copying
+// Lines are returned without their '\n' or '\r\n' ending
+class DataFile {
+private:
+    const char* _data;
+    size_t _size;
+    size_t _pos;
+    bool _mapped;
+    vector<char> _fallback;   // used where mmap is not available
+
+    void release();
+
+public:
+    DataFile();
+    ~DataFile();
+
+    bool open(const char filename[]);
+    bool nextLine(string_view& line);
+    // Hint for how much text the file holds (used to size arenas and tables)
+    size_t size() const;
+};
+
+// Splits a line at '|' into at most max_fields fields
+// The last field keeps the rest of the line, including any further '|'
+int splitFields(string_view line, string_view fields[], int max_fields);
+
+// Parses a whole field as an int with from_chars (spaces around it are allowed)
+bool parseIntField(string_view field, int& value);
+
+// One parsed line of each data file (text fields point into the line)
+struct CharacterFields {
+    string_view name;
+    int experience;
+    int accuracy;
+    int efficiency;
+    int insight;
+    int discoverPoints;
+};
+
+struct EventFields {
+    string_view description;
+    int pathType;
+    int advisorType;
+    int dpDelta;
+    int weight;      // optional 5th field, 1 if missing
+};
+
+struct RiddleFields {
+    string_view question;
+    string_view answer;
+};
+
+// Line parsers shared by the game and the asset compiler
+// Each returns false for lines that should be skipped (empty, comment or malformed)
+bool parseCharacterLine(string_view line, CharacterFields& character);
+bool parseEventLine(string_view line, EventFields& event);
+bool parseRiddleLine(string_view line, RiddleFields& riddle);
+
+#endif
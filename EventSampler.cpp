@@ -0,0 +1,165 @@
+#include "EventSampler.h"
+
+using namespace std;
+
+EventSampler::EventSampler() {
+}
+
+void EventSampler::clear() {
+    _events.clear();
+    for (int p = 0; p < PATH_COUNT; p++) {
+        for (int a = 0; a < ADVISOR_COUNT; a++) {
+            _tables[p][a].choices.clear();
+            _tables[p][a].probabilities.clear();
+            _tables[p][a].columns.clear();
+        }
+    }
+}
+
+void EventSampler::addEvent(int pathType, int advisorType, int dpDelta, int weight) {
+    EventInfo e;
+    e.pathType = pathType;
+    e.advisorType = advisorType;
+    e.dpDelta = dpDelta;
+    e.weight = weight;
+    _events.push_back(e);
+}
+
+void EventSampler::build() {
+    for (int p = 0; p < PATH_COUNT; p++) {
+        for (int a = 0; a < ADVISOR_COUNT; a++) {
+            buildTable(_tables[p][a], p, a);
+        }
+    }
+}
+
+// Vose's version of the alias method
+void EventSampler::buildTable(Table& table, int pathType, int advisor) {
+    table.choices.clear();
+    table.probabilities.clear();
+    table.columns.clear();
+
+    // Collect the events of this path and add up their weights
+    long long totalWeight = 0;
+    vector<int> weights;
+    for (int i = 0; i < (int)_events.size(); i++) {
+        const EventInfo& e = _events[i];
+        if (e.pathType != pathType || e.weight <= 0) {
+            continue;
+        }
+
+        SampledEvent choice;
+        choice.eventIndex = i;
+        choice.dpDelta = e.dpDelta;
+        choice.isProtected = false;
+
+        // Advisor protection: the matching advisor cancels a loss
+        if (e.dpDelta < 0 && e.advisorType != 0 && e.advisorType == advisor) {
+            choice.dpDelta = 0;
+            choice.isProtected = true;
+        }
+
+        table.choices.push_back(choice);
+        weights.push_back(e.weight);
+        totalWeight += e.weight;
+    }
+
+    int n = table.choices.size();
+    if (n == 0) {
+        return;
+    }
+
+    for (int i = 0; i < n; i++) {
+        table.probabilities.push_back((double)weights[i] / totalWeight);
+    }
+
+    // Scale every weight so the average column is exactly 1.0
+    vector<double> scaled(n);
+    vector<int> small;
+    vector<int> large;
+    for (int i = 0; i < n; i++) {
+        scaled[i] = (double)weights[i] * n / totalWeight;
+        if (scaled[i] < 1.0) {
+            small.push_back(i);
+        } else {
+            large.push_back(i);
+        }
+    }
+
+    // Fill each small column up to 1.0 with part of a large one
+    table.columns.resize(n);
+    while (!small.empty() && !large.empty()) {
+        int s = small.back();
+        small.pop_back();
+        int l = large.back();
+
+        table.columns[s].threshold = (unsigned int)(scaled[s] * 4294967295.0);
+        table.columns[s].alias = l;
+
+        scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+        if (scaled[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+
+    // Whatever is left is full (up to rounding error): always take its own event
+    for (int i = 0; i < (int)large.size(); i++) {
+        table.columns[large[i]].threshold = 0xFFFFFFFFu;
+        table.columns[large[i]].alias = large[i];
+    }
+    for (int i = 0; i < (int)small.size(); i++) {
+        table.columns[small[i]].threshold = 0xFFFFFFFFu;
+        table.columns[small[i]].alias = small[i];
+    }
+}
+
+bool EventSampler::hasEvents(int pathType, int advisor) const {
+    if (pathType < 0 || pathType >= PATH_COUNT || advisor < 0 || advisor >= ADVISOR_COUNT) {
+        return false;
+    }
+    return !_tables[pathType][advisor].choices.empty();
+}
+
+SampledEvent EventSampler::sample(int pathType, int advisor, unsigned long long random) const {
+    const Table& table = _tables[pathType][advisor];
+
+    // Low 32 bits pick the column, high 32 bits are the biased coin
+    unsigned int n = table.columns.size();
+    unsigned int column = (unsigned int)(((random & 0xFFFFFFFFULL) * n) >> 32);
+    unsigned int coin = (unsigned int)(random >> 32);
+
+    if (coin < table.columns[column].threshold) {
+        return table.choices[column];
+    }
+    return table.choices[table.columns[column].alias];
+}
+
+void EventSampler::getOutcomes(int pathType, int advisor, vector<int>& dpDeltas,
+                               vector<double>& probabilities) const {
+    dpDeltas.clear();
+    probabilities.clear();
+    if (!hasEvents(pathType, advisor)) {
+        return;
+    }
+
+    const Table& table = _tables[pathType][advisor];
+    for (int i = 0; i < (int)table.choices.size(); i++) {
+        int delta = table.choices[i].dpDelta;
+
+        // Merge with an earlier outcome of the same size
+        int found = -1;
+        for (int j = 0; j < (int)dpDeltas.size(); j++) {
+            if (dpDeltas[j] == delta) {
+                found = j;
+                break;
+            }
+        }
+        if (found == -1) {
+            dpDeltas.push_back(delta);
+            probabilities.push_back(table.probabilities[i]);
+        } else {
+            probabilities[found] += table.probabilities[i];
+        }
+    }
+}
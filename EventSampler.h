@@ -0,0 +1,68 @@
+#ifndef EVENTSAMPLER_H
+#define EVENTSAMPLER_H
+
+#include <vector>
+
+using namespace std;
+
+// Picks random events for a player in O(1), based on their path and advisor
+//
+// For every (path, advisor) pair there is a Walker alias table over the events of
+// that path. Each column holds one event, a second "alias" event and a threshold:
+// pick a column at random, then flip a biased coin to take the event or its alias.
+// Advisor protection is worked out when the tables are built, so every entry
+// already stores the Discover Points change the player will really get.
+
+const int PATH_COUNT = 2;      // 0 = Training Fellowship, 1 = Direct Lab
+const int ADVISOR_COUNT = 6;   // 0 = none, 1..5 = the five advisors
+
+struct SampledEvent {
+    int eventIndex;    // index of the event in the order it was added
+    int dpDelta;       // Discover Points change after advisor protection
+    bool isProtected;  // true if the advisor cancelled a loss
+};
+
+class EventSampler {
+private:
+    struct Column {
+        unsigned int threshold;   // take this column's event if the coin is below this
+        int alias;                // otherwise take the event of this column
+    };
+
+    struct Table {
+        vector<SampledEvent> choices;
+        vector<double> probabilities;   // chance of each choice (sums to 1)
+        vector<Column> columns;
+    };
+
+    struct EventInfo {
+        int pathType;
+        int advisorType;
+        int dpDelta;
+        int weight;
+    };
+
+    vector<EventInfo> _events;
+    Table _tables[PATH_COUNT][ADVISOR_COUNT];
+
+    void buildTable(Table& table, int pathType, int advisor);
+
+public:
+    EventSampler();
+
+    void clear();
+    void addEvent(int pathType, int advisorType, int dpDelta, int weight);
+    // Builds all alias tables; call once after the last addEvent
+    void build();
+
+    bool hasEvents(int pathType, int advisor) const;
+    // random is any 64-bit random number (for example from nextRandom in Random.h)
+    SampledEvent sample(int pathType, int advisor, unsigned long long random) const;
+
+    // Lists every possible Discover Points change with its chance (equal changes merged)
+    // Used by the AI to plan ahead without sampling
+    void getOutcomes(int pathType, int advisor, vector<int>& dpDeltas,
+                     vector<double>& probabilities) const;
+};
+
+#endif
@@ -15,11 +15,18 @@
  */
 
 #include "Game.h"      // Declaration of the Game class and its members
+#include "Assets.h"    // Built-in copy of the data files
 #include "DNAUtils.h"  // DNA-related helper functions used on certain tiles
+#include "Random.h"    // SplitMix64 generator for board seeds
+#include "ResultCache.h" // Remembered answers for repeated DNA tasks
+#include "Rules.h"     // GameRules: reward values for paths and tiles
+#include "Trace.h"     // TRACE_SCOPE timing probes
 
-#include <iostream>    // For cout, cin
+#include <iostream>    // For _out, _in, cin, cout
 #include <fstream>     // For ifstream (file reading)
 #include <string>      // For std::string
+#include <cstring>     // For memset (clearing a GameState)
+#include <limits>      // For numeric_limits (skipping a bad line of input)
 
 using namespace std;   // So we don't have to write std:: everywhere
 
@@ -31,8 +38,9 @@ using namespace std;   // So we don't have to write std:: everywhere
  *
  * We manually check each character and, if it is between 'A' and 'Z',
  * convert it to the corresponding lowercase letter by shifting its ASCII code.
+ * The string is changed in place, so no copy is made.
  */
-string toLowerCaseSimple(string s) {
+void toLowerCaseSimple(ScratchString& s) {
     // Loop over every character in the string by index
     for (int i = 0; i < s.length(); i++) {
         // Check if s[i] is in the range 'A'..'Z'
@@ -42,20 +50,68 @@ string toLowerCaseSimple(string s) {
             s[i] = s[i] - 'A' + 'a';
         }
     }
-    // Return the modified lowercase string
-    return s;
 }
 
 /*
  * Game::Game (constructor)
  * ------------------------
- * Initializes the Game object by setting all counts to zero.
- * We do NOT seed any random number generator here, because we are not using rand().
+ * Initializes the Game object by setting all counters to zero.
+ * The event, riddle and character lists start out empty.
  */
-Game::Game() {
-    _eventCount = 0;       // No random events loaded yet
-    _riddleCount = 0;      // No riddles loaded yet
-    _characterCount = 0;   // No scientist characters loaded yet
+Game::Game() : _out(cout), _in(cin) {
+    initialize();
+}
+
+/*
+ * Game::Game (output constructor)
+ * -------------------------------
+ * Same as the default constructor, but everything the game prints goes to 'out'.
+ * Simulations pass a stream with no buffer, which silently drops all output.
+ */
+Game::Game(ostream& out) : _out(out), _in(cin) {
+    initialize();
+}
+
+/*
+ * Game::Game (input/output constructor)
+ * -------------------------------------
+ * Reads the players' input from 'in' as well, so a game can be played over a
+ * network connection (see Server.h) instead of the terminal.
+ */
+Game::Game(istream& in, ostream& out) : _out(out), _in(in) {
+    initialize();
+}
+
+void Game::initialize() {
+    _rules = defaultGameRules();  // Original reward values
+
+    _greenToggle = 0;      // First Green tile triggers an event
+    _nextRiddleIndex = 0;  // Start at the first riddle
+
+    _characterIds[0] = -1; // No characters picked yet
+    _characterIds[1] = -1;
+
+    // Fixed starting seed, so (like the old unseeded rand()) boards repeat between runs
+    _rngState = 1300;
+
+    _useDataFiles = false; // Use the built-in data unless asked otherwise
+
+    _isAI[0] = false;      // Both seats are human unless setAIPlayer is called
+    _isAI[1] = false;
+    _aiAdvisor[0] = 1;
+    _aiAdvisor[1] = 1;
+
+    _replaying = false;    // Normal games read from cin
+    _replayFailed = false;
+    _replayEvents = 0;
+
+    _spectators = nullptr;  // Nobody watching unless setSpectatorFeed is called
+    memset(&_spectatorSnapshot, 0, sizeof(_spectatorSnapshot));
+
+    _resultCache = nullptr;  // No caching unless setResultCache is called
+    _allowIndels = false;    // Blue tiles want equal-length strands unless setAllowIndels is called
+    _allocationCounter = nullptr;  // Turns are not counted unless setAllocationCounter is called
+    _turnAllocations = 0;
 }
 
 /*
@@ -68,65 +124,40 @@ Game::Game() {
  *  - Each following line:
  *      name|experience|accuracy|efficiency|insight|discoveryPoints
  *
- * The function parses each line, creates a Player object with those stats,
- * and stores it in the _characterOptions array. It also updates _characterCount.
+ * The file is memory-mapped and split into fields with DataFile (see DataLoader.h),
+ * so no temporary strings are made while parsing. Each line becomes a Player in
+ * _characterOptions, which grows to fit however many characters the file has.
  */
 void Game::loadCharactersFromFile(const char filename[]) {
-    ifstream fin(filename);  // Create an input file stream
+    DataFile file;
 
     // Check if the file opened successfully
-    if (!fin.is_open()) {
-        cout << "Error: could not open " << filename << endl;
+    if (!file.open(filename)) {
+        _out << "Error: could not open " << filename << endl;
         return;  // Exit the function early if file can't be opened
     }
 
-    _characterCount = 0;    // Reset the character count before reading
+    _characterOptions.clear();  // Reset the character list before reading
 
-    string line;
+    string_view line;
     // The first line is assumed to be a header, so we read and ignore it
-    getline(fin, line);
-
-    // Read each subsequent line from the file until EOF or we hit MAX_CHARACTERS
-    while (getline(fin, line) && _characterCount < MAX_CHARACTERS) {
-        // Skip completely empty lines
-        if (line.size() == 0) continue;
-
-        // Find the positions of the '|' separators
-        int pos1 = line.find('|');
-        int pos2 = line.find('|', pos1 + 1);
-        int pos3 = line.find('|', pos2 + 1);
-        int pos4 = line.find('|', pos3 + 1);
-        int pos5 = line.find('|', pos4 + 1);
-
-        // If any of the separators are missing, the line is malformed; skip it
-        if (pos1 == -1 || pos2 == -1 || pos3 == -1 || pos4 == -1 || pos5 == -1) {
-            continue;
-        }
-
-        // Extract the name: everything from start of line up to pos1
-        string name = line.substr(0, pos1);
+    file.nextLine(line);
 
-        // Extract and convert each numerical field using stoi
-        int exp = stoi(line.substr(pos1 + 1, pos2 - pos1 - 1));  // experience
-        int acc = stoi(line.substr(pos2 + 1, pos3 - pos2 - 1));  // accuracy
-        int eff = stoi(line.substr(pos3 + 1, pos4 - pos3 - 1));  // efficiency
-        int ins = stoi(line.substr(pos4 + 1, pos5 - pos4 - 1));  // insight
-        int dp  = stoi(line.substr(pos5 + 1));                   // discoveryPoints
+    // Read each subsequent line from the file until EOF
+    // (empty or malformed lines are skipped by parseCharacterLine)
+    CharacterFields c;
+    while (file.nextLine(line)) {
+        if (!parseCharacterLine(line, c)) continue;
 
         // Create a Player object with the read data.
         // The last parameter (0) is pathType here; the player chooses path later.
-        _characterOptions[_characterCount] = Player(name, exp, acc, eff, ins, dp, 0);
-
-        // Move to the next slot in the _characterOptions array
-        _characterCount++;
+        _characterOptions.push_back(Player(string(c.name), c.experience, c.accuracy,
+                                           c.efficiency, c.insight, c.discoverPoints, 0));
     }
 
-    // Always close the file when finished
-    fin.close();
-
     // If no characters were loaded, warn the user
-    if (_characterCount == 0) {
-        cout << "Warning: no characters loaded from " << filename << endl;
+    if (_characterOptions.empty()) {
+        _out << "Warning: no characters loaded from " << filename << endl;
     }
 }
 
@@ -137,58 +168,51 @@ void Game::loadCharactersFromFile(const char filename[]) {
  *
  * Expected format of each line (after header):
  *    description|pathType|advisorType|dpDelta
+ * or description|pathType|advisorType|dpDelta|weight
  *
  * description: text describing what happens
- * pathType   : int specifying which path it applies to (may not be used fully here)
- * advisorType: int representing which advisor might protect you (not fully used here)
+ * pathType   : which path the event can happen on (0 or 1)
+ * advisorType: which advisor protects you from this loss (0 = no one)
  * dpDelta    : change in Discover Points (can be positive or negative)
+ * weight     : optional, how likely the event is compared to the others (default 1)
  *
- * Each event is stored in the _events[] array, and _eventCount is updated.
+ * Lines starting with '/' are comments. Descriptions are copied into the _text
+ * arena and each event is added to _events.
  */
 void Game::loadRandomEvents(const char filename[]) {
-    ifstream fin(filename);  // Input file stream
+    DataFile file;
 
     // Check if file opened
-    if (!fin.is_open()) {
-        cout << "Error: could not open " << filename << endl;
+    if (!file.open(filename)) {
+        _out << "Error: could not open " << filename << endl;
         return;
     }
 
-    _eventCount = 0;  // Reset event count
+    _events.clear();  // Reset event list
+    // Rough guess of the event count so the list rarely has to grow
+    _events.reserve(file.size() / 48);
 
-    string line;
+    string_view line;
     // Skip header line
-    getline(fin, line);
+    file.nextLine(line);
 
     // Read each event line
-    while (getline(fin, line) && _eventCount < MAX_EVENTS) {
-        // Skip empty lines
-        if (line.size() == 0) continue;
-        // If we decide that lines starting with '/' are comments, skip them
-        if (line[0] == '/') continue;
-
-        // Find the '|' delimiters
-        int p1 = line.find('|');
-        int p2 = line.find('|', p1 + 1);
-        int p3 = line.find('|', p2 + 1);
-
-        // If the line doesn't have the right number of separators, skip it
-        if (p1 == -1 || p2 == -1 || p3 == -1) continue;
+    // (empty lines, '/' comments and malformed lines are skipped by parseEventLine)
+    EventFields fields;
+    while (file.nextLine(line)) {
+        if (!parseEventLine(line, fields)) continue;
 
         // Create a new RandomEvent struct and fill it from the line
         RandomEvent e;
-        e.description = line.substr(0, p1);
-        e.pathType    = stoi(line.substr(p1 + 1, p2 - p1 - 1));
-        e.advisorType = stoi(line.substr(p2 + 1, p3 - p2 - 1));
-        e.dpDelta     = stoi(line.substr(p3 + 1));
-
-        // Store the event in the array and increment the count
-        _events[_eventCount] = e;
-        _eventCount++;
+        e.description = _text.store(fields.description);
+        e.pathType    = fields.pathType;
+        e.advisorType = fields.advisorType;
+        e.dpDelta     = fields.dpDelta;
+        e.weight      = fields.weight;
+
+        // Store the event in the list
+        _events.push_back(e);
     }
-
-    // Close the file after reading
-    fin.close();
 }
 
 /*
@@ -199,44 +223,129 @@ void Game::loadRandomEvents(const char filename[]) {
  * Expected format per line (after header):
  *    question|answer
  *
- * Each riddle is stored in _riddles[], and _riddleCount is updated.
+ * Only the first '|' separates the two, so answers such as "||" still work.
+ * Each riddle is added to _riddles with its text in the _text arena.
  */
 void Game::loadRiddles(const char filename[]) {
-    ifstream fin(filename);  // Input file stream
+    DataFile file;
 
     // Check if file opened correctly
-    if (!fin.is_open()) {
-        cout << "Error: could not open " << filename << endl;
+    if (!file.open(filename)) {
+        _out << "Error: could not open " << filename << endl;
         return;
     }
 
-    _riddleCount = 0;  // Reset riddle count
+    _riddles.clear();  // Reset riddle list
+    _riddles.reserve(file.size() / 64);
 
-    string line;
+    string_view line;
     // Skip header line
-    getline(fin, line);
+    file.nextLine(line);
 
     // Read each riddle line
-    while (getline(fin, line) && _riddleCount < MAX_RIDDLES) {
-        // Skip empty lines
-        if (line.size() == 0) continue;
-
-        // Find the '|' between question and answer
-        int p = line.find('|');
-        if (p == -1) continue;  // If no '|' found, skip the line
+    // (lines without a '|' are skipped by parseRiddleLine)
+    RiddleFields fields;
+    while (file.nextLine(line)) {
+        if (!parseRiddleLine(line, fields)) continue;
 
         // Create a new Riddle struct
         Riddle r;
-        r.question = line.substr(0, p);    // text before '|'
-        r.answer   = line.substr(p + 1);   // text after '|'
+        r.question    = _text.store(fields.question);        // text before '|'
+        r.answer      = _text.store(fields.answer);          // text after '|'
+        r.answerLower = _text.storeLowerCase(fields.answer); // lowercase copy for checking
+
+        // Store it in the list
+        _riddles.push_back(r);
+    }
+}
+
+/*
+ * loadBundledAssets:
+ * ------------------
+ * Fills the character, event and riddle lists from the tables compiled into the
+ * program (GeneratedAssets.cpp, made by AssetCompiler.cpp). Nothing is read from
+ * disk and no text is copied: the string_views point straight into the tables.
+ */
+void Game::loadBundledAssets() {
+    const AssetBundle& assets = BUNDLED_ASSETS;
+
+    _characterOptions.clear();
+    for (int i = 0; i < assets.characterCount; i++) {
+        const AssetCharacter& c = assets.characters[i];
+        _characterOptions.push_back(Player(string(assets.text + c.name.offset, c.name.length),
+                                           c.experience, c.accuracy, c.efficiency,
+                                           c.insight, c.discoverPoints, 0));
+    }
+
+    _events.clear();
+    _events.reserve(assets.eventCount);
+    for (int i = 0; i < assets.eventCount; i++) {
+        const AssetEvent& a = assets.events[i];
+        RandomEvent e;
+        e.description = string_view(assets.text + a.description.offset, a.description.length);
+        e.pathType    = a.pathType;
+        e.advisorType = a.advisorType;
+        e.dpDelta     = a.dpDelta;
+        e.weight      = a.weight;
+        _events.push_back(e);
+    }
+
+    _riddles.clear();
+    _riddles.reserve(assets.riddleCount);
+    for (int i = 0; i < assets.riddleCount; i++) {
+        const AssetRiddle& a = assets.riddles[i];
+        Riddle r;
+        r.question    = string_view(assets.text + a.question.offset, a.question.length);
+        r.answer      = string_view(assets.text + a.answer.offset, a.answer.length);
+        r.answerLower = string_view(assets.text + a.answerLower.offset, a.answerLower.length);
+        _riddles.push_back(r);
+    }
+}
+
+/*
+ * loadAssets:
+ * -----------
+ * Loads the game data: the built-in tables by default, or the .txt files in the
+ * working directory after useDataFiles() (for trying out edited data without
+ * re-running the asset compiler).
+ */
+void Game::loadAssets() {
+    if (_useDataFiles) {
+        // Text from the last load is not needed any more; without this every
+        // new game would add another copy of it to the arena. The lists go
+        // first because they point into it (and stay empty if a file is missing)
+        _events.clear();
+        _riddles.clear();
+        _text.clear();
+        loadCharactersFromFile("characters.txt");
+        loadRandomEvents("random_events.txt");
+        loadRiddles("riddles.txt");
+    } else {
+        loadBundledAssets();
+    }
+    buildEventSampler();
+
+    // The AI plans with the same tile odds, event odds and rewards the game uses
+    _ai.setup(_board, _eventSampler, _rules);
+}
 
-        // Store it and increment riddle count
-        _riddles[_riddleCount] = r;
-        _riddleCount++;
+/*
+ * buildEventSampler:
+ * ------------------
+ * Hands every loaded event to the EventSampler, which builds one alias table per
+ * (path, advisor) pair. After this, picking an event is O(1) however many there are.
+ */
+void Game::buildEventSampler() {
+    _eventSampler.clear();
+    for (int i = 0; i < (int)_events.size(); i++) {
+        _eventSampler.addEvent(_events[i].pathType, _events[i].advisorType,
+                               _events[i].dpDelta, _events[i].weight);
     }
+    _eventSampler.build();
+}
 
-    // Close the file
-    fin.close();
+void Game::useDataFiles() {
+    _useDataFiles = true;
 }
 
 /*
@@ -249,18 +358,24 @@ void Game::loadRiddles(const char filename[]) {
  * The chosen characters are stored in _players[0] and _players[1].
  */
 void Game::chooseCharacters() {
+    int characterCount = _characterOptions.size();
+
     // If we don't have at least 2 characters loaded, just default to the first two
-    if (_characterCount < 2) {
-        cout << "Not enough characters in file. Using first two by default.\n";
+    if (characterCount < 2) {
+        _out << "Not enough characters in file. Using first two by default.\n";
+        // Pad with blank characters so there always are two to copy
+        _characterOptions.resize(2);
         _players[0] = _characterOptions[0];
         _players[1] = _characterOptions[1];
+        _characterIds[0] = 0;
+        _characterIds[1] = 1;
         return;
     }
 
     // Display all available scientists with their stats
-    cout << "\n===== AVAILABLE SCIENTISTS =====\n";
-    for (int i = 0; i < _characterCount; i++) {
-        cout << (i + 1) << ") " << _characterOptions[i].getName()
+    _out << "\n===== AVAILABLE SCIENTISTS =====\n";
+    for (int i = 0; i < characterCount; i++) {
+        _out << (i + 1) << ") " << _characterOptions[i].getName()
              << "  [Exp: " << _characterOptions[i].getExperience()
              << ", Acc: " << _characterOptions[i].getAccuracy()
              << ", Eff: " << _characterOptions[i].getEfficiency()
@@ -272,34 +387,26 @@ void Game::chooseCharacters() {
     int choice1 = 0;  // Player 1's choice index (1-based)
     int choice2 = 0;  // Player 2's choice index (1-based)
 
-    // Prompt Player 1 for a choice
-    cout << "\nPlayer 1: choose your scientist (1-" << _characterCount << "): ";
-    cin >> choice1;
-
-    // Validate Player 1's input
-    while (choice1 < 1 || choice1 > _characterCount) {
-        cout << "Invalid choice. Try again: ";
-        cin >> choice1;
-    }
+    // Prompt Player 1 for a choice (inputChoice keeps asking until it is valid)
+    _out << "\nPlayer 1: choose your scientist (1-" << characterCount << "): ";
+    choice1 = inputChoice(JOURNAL_CHARACTER_CHOICE, 0, 1, characterCount, -1,
+                          "Invalid choice. Try again: ");
 
     // Prompt Player 2 for a choice, which must be different from Player 1's
-    cout << "Player 2: choose your scientist (1-" << _characterCount
+    _out << "Player 2: choose your scientist (1-" << characterCount
          << "), but not " << choice1 << ": ";
-    cin >> choice2;
-
-    // Validate Player 2's input
-    while (choice2 < 1 || choice2 > _characterCount || choice2 == choice1) {
-        cout << "Invalid choice. Try again: ";
-        cin >> choice2;
-    }
+    choice2 = inputChoice(JOURNAL_CHARACTER_CHOICE, 1, 1, characterCount, choice1,
+                          "Invalid choice. Try again: ");
 
     // Copy the chosen characters into _players array
     _players[0] = _characterOptions[choice1 - 1];  // Player 1's character
     _players[1] = _characterOptions[choice2 - 1];  // Player 2's character
+    _characterIds[0] = choice1 - 1;
+    _characterIds[1] = choice2 - 1;
 
     // Show final character selections
-    cout << "\nPlayer 1 chose: " << _players[0].getName() << endl;
-    cout << "Player 2 chose: " << _players[1].getName() << endl;
+    _out << "\nPlayer 1 chose: " << _players[0].getName() << endl;
+    _out << "Player 2 chose: " << _players[1].getName() << endl;
 }
 
 /*
@@ -316,21 +423,30 @@ void Game::choosePaths() {
 
     // Repeat for both players (index 0 and 1)
     for (int i = 0; i < 2; i++) {
-        cout << "\nPath selection for Player " << (i + 1)
+        _out << "\nPath selection for Player " << (i + 1)
              << " (" << _players[i].getName() << ")\n";
-        cout << "0 = Training Fellowship (lower starting DP, higher stats)\n";
-        cout << "1 = Direct Lab Assignment (more starting DP, smaller stat boost)\n";
-        cout << "Your choice: ";
-        cin >> choice;
+        _out << "0 = Training Fellowship (lower starting DP, higher stats)\n";
+        _out << "1 = Direct Lab Assignment (more starting DP, smaller stat boost)\n";
+        _out << "Your choice: ";
 
         // Validate input; must be 0 or 1
-        while (choice != 0 && choice != 1) {
-            cout << "Invalid choice. Enter 0 or 1: ";
-            cin >> choice;
-        }
+        choice = inputChoice(JOURNAL_PATH_CHOICE, i, 0, 1, -1,
+                             "Invalid choice. Enter 0 or 1: ");
 
         // Store the path type in the Player object
         _players[i].setPathType(choice);
+
+        // Each scientist also picks an advisor, who protects them from some losses
+        _out << "\nChoose your advisor:\n";
+        _out << "1 = Dr. Aliquot\n";
+        _out << "2 = Dr. Assembler\n";
+        _out << "3 = Dr. Pop-Gen\n";
+        _out << "4 = Dr. Bio-Script\n";
+        _out << "5 = Dr. Loci\n";
+        _out << "Your choice: ";
+        int advisor = inputChoice(JOURNAL_ADVISOR_CHOICE, i, 1, 5, -1,
+                                  "Invalid choice. Enter 1 to 5: ");
+        _players[i].setAdvisor(advisor);
     }
 
     // After both players have chosen, adjust their stats/points accordingly
@@ -362,22 +478,22 @@ void Game::applyPathBonuses() {
         // Check which path the current player chose
         if (_players[i].getPathType() == 0) {
             // Training Fellowship path adjustments
-            _players[i].changeDiscoverPoints(-5000);
-            _players[i].changeAccuracy(500);
-            _players[i].changeEfficiency(500);
-            _players[i].changeInsight(1000);
+            _players[i].changeDiscoverPoints(_rules.fellowshipDP);
+            _players[i].changeAccuracy(_rules.fellowshipAccuracy);
+            _players[i].changeEfficiency(_rules.fellowshipEfficiency);
+            _players[i].changeInsight(_rules.fellowshipInsight);
 
-            cout << _players[i].getName()
-                 << " takes Training Fellowship: -5000 DP, big stat boosts.\n";
+            _out << _players[i].getName()
+                 << " takes Training Fellowship: " << _rules.fellowshipDP << " DP, big stat boosts.\n";
         } else {
             // Direct Lab Assignment path adjustments
-            _players[i].changeDiscoverPoints(5000);
-            _players[i].changeAccuracy(200);
-            _players[i].changeEfficiency(200);
-            _players[i].changeInsight(200);
+            _players[i].changeDiscoverPoints(_rules.directLabDP);
+            _players[i].changeAccuracy(_rules.directLabAccuracy);
+            _players[i].changeEfficiency(_rules.directLabEfficiency);
+            _players[i].changeInsight(_rules.directLabInsight);
 
-            cout << _players[i].getName()
-                 << " goes Direct Lab Assignment: +5000 DP, modest stat boosts.\n";
+            _out << _players[i].getName()
+                 << " goes Direct Lab Assignment: +" << _rules.directLabDP << " DP, modest stat boosts.\n";
         }
     }
 }
@@ -400,14 +516,35 @@ void Game::applyPathBonuses() {
  */
 void Game::play() {
     // Initialize the board (tiles, starting positions, etc.)
-    _board.initializeBoard();
+    // A fresh Board puts both players back on the first tile (like simulate)
+    // so one Game can play more than once
+    _board = Board(_board.getBoardSize(), 0);
+    // The board seed is journaled like an input so a replay sees the same tiles
+    if (_replaying) {
+        // Step the generator exactly like a live game would, so random events match
+        nextRandom(_rngState);
+        long long seed = 0;
+        if (nextReplayEntry(JOURNAL_BOARD_SEED, 0)) {
+            decodeJournalValues(_replayEntry, &seed, 1);
+        }
+        _board.initializeBoard((unsigned long long)seed);
+    } else {
+        _board.initializeBoard(nextRandom(_rngState));
+        long long seed = (long long)_board.getSeed();
+        _journal.writeValues(JOURNAL_BOARD_SEED, 0, &seed, 1);
+    }
 
     // Track whether each player has finished the race to the final tile
     bool finished[2] = {false, false};
+    _turnAllocations = 0;
 
-    cout << "\n===== BEGIN JOURNEY THROUGH THE GENOME =====\n";
-    // Show the starting Board layout
-    _board.displayBoard();
+    startSpectatorSnapshot();
+
+    _out << "\n===== BEGIN JOURNEY THROUGH THE GENOME =====\n";
+    // Show the starting Board layout (skipped when output is switched off)
+    if (_out) {
+        _board.displayBoard(_out);
+    }
 
     // Keep looping until both players are finished
     while (!(finished[0] && finished[1])) {
@@ -418,15 +555,21 @@ void Game::play() {
                 continue;
             }
 
-            cout << "\n--- Player " << (i + 1)
+            TRACE_SCOPE("turn");
+            // Everything typed last turn is done with: reuse the arena's memory
+            _scratch.reset();
+            long long allocationsBefore = (_allocationCounter != nullptr) ? _allocationCounter() : 0;
+            _out << "\n--- Player " << (i + 1)
                  << " (" << _players[i].getName() << ") turn ---" << endl;
-            cout << "Rolling and moving...\n";
+            _out << "Rolling and moving...\n";
 
             // Move the player; Board decides how far and returns true if final tile reached
             bool reachedEnd = _board.movePlayer(i);
 
             // Display the updated board
-            _board.displayBoard();
+            if (_out) {
+                _board.displayBoard(_out);
+            }
 
             // Get this player's current position index on their lane
             int pos = _board.getPlayerPosition(i);
@@ -434,9 +577,12 @@ void Game::play() {
             // Get the color of the tile at that position for this player
             char color = _board.getTileColor(i, pos);
 
+            long long move[2] = {pos, color};
+            recordValues(JOURNAL_MOVE, i, move, 2);
+
             // If the Board says final tile was reached
             if (reachedEnd) {
-                cout << "Player " << (i + 1)
+                _out << "Player " << (i + 1)
                      << " reached the Genome Conference (final tile)!\n";
                 finished[i] = true;           // Mark this player as finished
                 _players[i].setFinished(true); // Record in Player object as well
@@ -444,12 +590,21 @@ void Game::play() {
                 // If not at the end, we apply tile-specific effect
                 resolveTileEffect(i, color);
             }
+
+            publishSpectators(false);
+            if (_allocationCounter != nullptr) {
+                _turnAllocations += _allocationCounter() - allocationsBefore;
+            }
         }
     }
+    publishSpectators(true);
 
     // Once both players are done, announce the result
-    cout << "\nBoth players have reached the final tile!\n";
+    _out << "\nBoth players have reached the final tile!\n";
     announceWinner();
+
+    long long scores[2] = {calculateFinalScore(_players[0]), calculateFinalScore(_players[1])};
+    recordValues(JOURNAL_GAME_END, 0, scores, 2);
 }
 
 /*
@@ -468,23 +623,21 @@ void Game::play() {
  *  - Others: no special effect.
  *
  * Since we are not using rand(), we simulate a "50% chance" for Green tiles
- * by toggling between event/no-event using a static int called greenToggle.
+ * by toggling between event/no-event using the _greenToggle member.
  */
 void Game::resolveTileEffect(int player_index, char color) {
-    // Static variable keeps its value between calls.
-    // It starts at 0 by default the first time the function is called.
-    static int greenToggle = 0;
-
+    TRACE_SCOPE("resolveTileEffect");
+    // _greenToggle keeps its value between calls (it starts at 0 in the constructor)
     switch (color) {
         case 'G':
-            cout << "Green tile: Regular tile. 50% chance of random event (toggled).\n";
-            // If greenToggle is 0, we trigger an event; next time it will be 1, and no event
-            if (greenToggle == 0) {
+            _out << "Green tile: Regular tile. 50% chance of random event (toggled).\n";
+            // If _greenToggle is 0, we trigger an event; next time it will be 1, and no event
+            if (_greenToggle == 0) {
                 triggerRandomEvent(player_index);
-                greenToggle = 1;   // Next Green tile will do "no event"
+                _greenToggle = 1;   // Next Green tile will do "no event"
             } else {
-                cout << "No event this time.\n";
-                greenToggle = 0;   // Flip back for next time
+                _out << "No event this time.\n";
+                _greenToggle = 0;   // Flip back for next time
             }
             break;
 
@@ -503,55 +656,64 @@ void Game::resolveTileEffect(int player_index, char color) {
 
         default:
             // Yellow (start), Orange (end), or any unrecognized color: do nothing special
-            cout << "Nothing special on this tile.\n";
+            _out << "Nothing special on this tile.\n";
             break;
     }
+
+    // Record the player's stats after the tile so replay can check them
+    long long outcome[5] = {color,
+                            _players[player_index].getAccuracy(),
+                            _players[player_index].getEfficiency(),
+                            _players[player_index].getInsight(),
+                            _players[player_index].getDiscoverPoints()};
+    recordValues(JOURNAL_TILE_OUTCOME, player_index, outcome, 5);
 }
 
 /*
  * triggerRandomEvent:
  * -------------------
- * Applies a "random" event to the specified player. Since we are not using rand(),
- * we simply cycle through the event list in order using a static index.
+ * Applies a random event to the specified player. Only events of the player's
+ * path can happen, picked by weight with the EventSampler's alias tables.
  *
  * Behavior:
  *  - Print the event description.
- *  - Change the player's Discover Points by dpDelta (positive or negative).
+ *  - Change the player's Discover Points by dpDelta (positive or negative),
+ *    unless the player's advisor protects them from that loss.
  */
 void Game::triggerRandomEvent(int player_index) {
-    // If we have no events loaded, we can't do anything
-    if (_eventCount == 0) {
-        cout << "No random events loaded.\n";
+    int path = _players[player_index].getPathType();
+    int advisor = _players[player_index].getAdvisor();
+
+    // If no events fit this player's path, we can't do anything
+    if (!_eventSampler.hasEvents(path, advisor)) {
+        _out << "No random events loaded.\n";
         return;
     }
 
-    // static index that cycles: 0,1,2,...,_eventCount-1,0,1,2,...
-    static int nextEventIndex = 0;
-
-    int idx = nextEventIndex;        // Use the current index
-    nextEventIndex = nextEventIndex + 1;     // Move to the next one
-    if (nextEventIndex >= _eventCount) {
-        nextEventIndex = 0;          // Wrap around to 0 if we reach the end
-    }
+    // Pick an event of this player's path (weighted, O(1))
+    SampledEvent picked = _eventSampler.sample(path, advisor, nextRandom(_rngState));
 
     // Reference to the chosen event
-    RandomEvent &e = _events[idx];
+    RandomEvent &e = _events[picked.eventIndex];
 
-    cout << "\n--- RANDOM EVENT ---\n";
-    cout << e.description << endl;
+    _out << "\n--- RANDOM EVENT ---\n";
+    _out << e.description << endl;
 
     // Show whether the player gains or loses Discover Points
-    if (e.dpDelta >= 0) {
-        cout << "You gain " << e.dpDelta << " Discover Points!\n";
+    if (picked.isProtected) {
+        _out << "Your advisor steps in and protects you from losing "
+             << -e.dpDelta << " Discover Points!\n";
+    } else if (picked.dpDelta >= 0) {
+        _out << "You gain " << picked.dpDelta << " Discover Points!\n";
     } else {
-        cout << "You lose " << -e.dpDelta << " Discover Points...\n";
+        _out << "You lose " << -picked.dpDelta << " Discover Points...\n";
     }
 
-    // Apply dpDelta to player's Discover Points
-    _players[player_index].changeDiscoverPoints(e.dpDelta);
+    // Apply the change (already 0 if the advisor protected the player)
+    _players[player_index].changeDiscoverPoints(picked.dpDelta);
 
     // Show updated Discover Points
-    cout << "New Discover Points: "
+    _out << "New Discover Points: "
          << _players[player_index].getDiscoverPoints() << "\n";
 }
 
@@ -567,77 +729,86 @@ void Game::triggerRandomEvent(int player_index) {
  * After performing the DNA tasks, we also grant certain stat bonuses to the player.
  */
 void Game::handleDNATask(int player_index, char color) {
-    string s1, s2;  // s1 and s2 will store DNA strand inputs
+    TRACE_SCOPE("handleDNATask");
+    // s1 and s2 will store DNA strand inputs (in this turn's scratch arena)
+    ScratchString s1(&_scratch);
+    ScratchString s2(&_scratch);
 
-    cout << "\n--- DNA TASK ---\n";
+    _out << "\n--- DNA TASK ---\n";
 
     // BLUE TILE: DNA Task 1
     if (color == 'B') {
-        cout << "Blue tile: DNA Task 1 - Similarity (Equal-Length)\n";
-        cout << "Enter first DNA strand: ";
-        cin >> s1;
-        cout << "Enter second DNA strand (same length): ";
-        cin >> s2;
+        _out << "Blue tile: DNA Task 1 - Similarity (Equal-Length)\n";
+        _out << "Enter first DNA strand: ";
+        s1 = inputToken(JOURNAL_DNA_INPUT, player_index);
+        if (_allowIndels) {
+            _out << "Enter second DNA strand (a few bases may be added or missing): ";
+        } else {
+            _out << "Enter second DNA strand (same length): ";
+        }
+        s2 = inputToken(JOURNAL_DNA_INPUT, player_index);
 
         // strandSimilarity returns a double between 0 and 1
-        double score = strandSimilarity(s1, s2);
+        // (with indels allowed the strands are aligned first, see Alignment.h)
+        double score = cachedStrandSimilarity(_resultCache, s1, s2, _out, _allowIndels);
 
-        // Convert similarity score to an Accuracy bonus (up to +200)
+        // Convert similarity score to an Accuracy bonus (up to +_rules.blueMaxAccuracy)
         // We use a C-style cast to int to avoid static_cast
-        int bonus = (int)(score * 200.0);
+        int bonus = (int)(score * _rules.blueMaxAccuracy);
         _players[player_index].changeAccuracy(bonus);
 
-        cout << "Accuracy increased by " << bonus << " points.\n";
+        _out << "Accuracy increased by " << bonus << " points.\n";
     }
     // PINK TILE: DNA Task 2
     else if (color == 'P') {
-        cout << "Pink tile: DNA Task 2 - Best Strand Match (Unequal-Length)\n";
-        cout << "Enter input strand: ";
-        cin >> s1;
-        cout << "Enter target strand: ";
-        cin >> s2;
+        _out << "Pink tile: DNA Task 2 - Best Strand Match (Unequal-Length)\n";
+        _out << "Enter input strand: ";
+        s1 = inputToken(JOURNAL_DNA_INPUT, player_index);
+        _out << "Enter target strand: ";
+        s2 = inputToken(JOURNAL_DNA_INPUT, player_index);
 
         // bestStrandMatch returns the index of the best matching substring
-        int idx = bestStrandMatch(s1, s2);
+        int idx = cachedBestStrandMatch(_resultCache, s1, s2, _out);
 
         // If idx is not -1, we assume the operation succeeded and reward Efficiency
         if (idx != -1) {
-            _players[player_index].changeEfficiency(150);
-            cout << "Efficiency increased by 150 points.\n";
+            _players[player_index].changeEfficiency(_rules.pinkEfficiency);
+            _out << "Efficiency increased by " << _rules.pinkEfficiency << " points.\n";
         }
     }
     // RED TILE: DNA Task 3
     else if (color == 'R') {
-        cout << "Red tile: DNA Task 3 - Mutation Identification\n";
-        cout << "Enter input strand: ";
-        cin >> s1;
-        cout << "Enter target strand: ";
-        cin >> s2;
+        _out << "Red tile: DNA Task 3 - Mutation Identification\n";
+        _out << "Enter input strand: ";
+        s1 = inputToken(JOURNAL_DNA_INPUT, player_index);
+        _out << "Enter target strand: ";
+        s2 = inputToken(JOURNAL_DNA_INPUT, player_index);
 
         // identifyMutations prints information about differences between strands
-        identifyMutations(s1, s2);
+        cachedIdentifyMutations(_resultCache, s1, s2, _out);
 
-        _players[player_index].changeInsight(150);
-        cout << "Insight increased by 150 points.\n";
+        _players[player_index].changeInsight(_rules.redInsight);
+        _out << "Insight increased by " << _rules.redInsight << " points.\n";
     }
     // BROWN TILE: DNA Task 4
     else if (color == 'T') {
-        cout << "Brown tile: DNA Task 4 - Transcribe DNA to RNA\n";
-        cout << "Enter DNA strand: ";
-        cin >> s1;
+        _out << "Brown tile: DNA Task 4 - Transcribe DNA to RNA\n";
+        _out << "Enter DNA strand: ";
+        s1 = inputToken(JOURNAL_DNA_INPUT, player_index);
 
         // transcribeDNAtoRNA prints the RNA sequence (T → U)
-        transcribeDNAtoRNA(s1);
+        transcribeDNAtoRNA(s1, _out);
 
         // Small boosts to Accuracy and Efficiency
-        _players[player_index].changeAccuracy(50);
-        _players[player_index].changeEfficiency(50);
+        _players[player_index].changeAccuracy(_rules.brownAccuracy);
+        _players[player_index].changeEfficiency(_rules.brownEfficiency);
 
-        cout << "Accuracy and Efficiency increased by 50 points each.\n";
+        _out << "Accuracy increased by " << _rules.brownAccuracy << " and Efficiency by "
+             << _rules.brownEfficiency << " points.\n";
     }
 
     // Show updated stats after completing the DNA task
-    cout << "Current stats - Accuracy: " << _players[player_index].getAccuracy()
+    _out << "Current stats - Accuracy: " << _players[player_index].getAccuracy()
          << ", Efficiency: " << _players[player_index].getEfficiency()
          << ", Insight: " << _players[player_index].getInsight() << "\n";
 }
@@ -657,49 +828,41 @@ void Game::handleDNATask(int player_index, char color) {
  */
 void Game::triggerRiddle(int player_index) {
     // If there are no riddles, we cannot do anything
-    if (_riddleCount == 0) {
-        cout << "No riddles loaded.\n";
+    if (_riddles.empty()) {
+        _out << "No riddles loaded.\n";
         return;
     }
 
-    // static index cycles through riddle list
-    static int nextRiddleIndex = 0;
-
-    int idx = nextRiddleIndex;        // Current riddle index
-    nextRiddleIndex = nextRiddleIndex + 1;
-    if (nextRiddleIndex >= _riddleCount) {
-        nextRiddleIndex = 0;          // Wrap around when reaching the end
+    // Index cycles through riddle list
+    int idx = _nextRiddleIndex;        // Current riddle index
+    _nextRiddleIndex = _nextRiddleIndex + 1;
+    if (_nextRiddleIndex >= (int)_riddles.size()) {
+        _nextRiddleIndex = 0;          // Wrap around when reaching the end
     }
 
-    // Reference a riddle from the array
+    // Reference a riddle from the list
     Riddle &r = _riddles[idx];
 
-    cout << "\n--- RIDDLE TILE ---\n";
-    cout << r.question << endl;
-    cout << "Your answer: ";
-
-    string answer;
-
-    // Clear leftover newline in input buffer once
-    // so that getline reads the user's full answer correctly.
-    cin.ignore(1, '\n');
+    _out << "\n--- RIDDLE TILE ---\n";
+    _out << r.question << endl;
+    _out << "Your answer: ";
 
     // Read a full line for the player's answer (can include spaces)
-    getline(cin, answer);
+    ScratchString userAns = inputLine(JOURNAL_RIDDLE_ANSWER, player_index);
 
-    // Convert both player's answer and correct answer to lowercase
-    string userAns = toLowerCaseSimple(answer);
-    string correct = toLowerCaseSimple(r.answer);
+    // Convert the player's answer to lowercase (the correct one was lowercased when loaded)
+    toLowerCaseSimple(userAns);
+    string_view correct = r.answerLower;
 
     // Compare the two lowercase strings
     if (userAns == correct) {
-        cout << "Correct! Insight +500.\n";
-        _players[player_index].changeInsight(500);
+        _out << "Correct! Insight +" << _rules.riddleInsight << ".\n";
+        _players[player_index].changeInsight(_rules.riddleInsight);
     } else {
-        cout << "Incorrect. The correct answer was: " << r.answer << endl;
+        _out << "Incorrect. The correct answer was: " << r.answer << endl;
     }
 
-    cout << "Insight is now " << _players[player_index].getInsight() << "\n";
+    _out << "Insight is now " << _players[player_index].getInsight() << "\n";
 }
 
 /*
@@ -715,7 +878,7 @@ void Game::triggerRiddle(int player_index) {
  *
  * We use integer division by 100, so only full sets of 100 in each stat count.
  */
-int Game::calculateFinalScore(const Player& p) const {
+int Game::calculateFinalScore(const Player& p) {
     // Start with the player's Discover Points
     int total = p.getDiscoverPoints();
 
@@ -729,6 +892,38 @@ int Game::calculateFinalScore(const Player& p) const {
     return total;
 }
 
+/*
+ * startSpectatorSnapshot / publishSpectators:
+ * -------------------------------------------
+ * The parts of the snapshot that never change during a game (names, tile
+ * colors) are filled in once; each turn only the GameState is refreshed before
+ * the snapshot is copied into the shared segment.
+ */
+void Game::startSpectatorSnapshot() {
+    if (_spectators == nullptr) {
+        return;
+    }
+    memset(&_spectatorSnapshot, 0, sizeof(_spectatorSnapshot));
+    for (int i = 0; i < 2; i++) {
+        string name = _players[i].getName();
+        strncpy(_spectatorSnapshot.names[i], name.c_str(), sizeof(_spectatorSnapshot.names[i]) - 1);
+        for (int pos = 0; pos < _board.getBoardSize() && pos < SPECTATOR_MAX_TILES; pos++) {
+            _spectatorSnapshot.tileColors[i][pos] = _board.getTileColor(i, pos);
+        }
+    }
+    publishSpectators(false);
+}
+
+void Game::publishSpectators(bool gameOver) {
+    if (_spectators == nullptr) {
+        return;
+    }
+    _spectatorSnapshot.state = getState();
+    _spectatorSnapshot.gameOver = gameOver ? 1 : 0;
+    _spectators->publish(_spectatorSnapshot);
+    _spectatorSnapshot.turn++;
+}
+
 /*
  * announceWinner:
  * ---------------
@@ -740,19 +935,19 @@ void Game::announceWinner() const {
     int score1 = calculateFinalScore(_players[0]);
     int score2 = calculateFinalScore(_players[1]);
 
-    cout << "\n===== FINAL SCORES =====\n";
-    cout << _players[0].getName() << ": " << score1 << " total points\n";
-    cout << _players[1].getName() << ": " << score2 << " total points\n";
+    _out << "\n===== FINAL SCORES =====\n";
+    _out << _players[0].getName() << ": " << score1 << " total points\n";
+    _out << _players[1].getName() << ": " << score2 << " total points\n";
 
     // Compare scores and announce result
     if (score1 > score2) {
-        cout << "Winner: " << _players[0].getName()
+        _out << "Winner: " << _players[0].getName()
              << " is the new Lead Genomicist!\n";
     } else if (score2 > score1) {
-        cout << "Winner: " << _players[1].getName()
+        _out << "Winner: " << _players[1].getName()
              << " is the new Lead Genomicist!\n";
     } else {
-        cout << "It's a tie! Both players become Co-Lead Genomicists!\n";
+        _out << "It's a tie! Both players become Co-Lead Genomicists!\n";
     }
 }
 
@@ -762,16 +957,14 @@ void Game::announceWinner() const {
  * High-level "driver" function for the Game class.
  *
  * Steps:
- *  1) Load characters, random events, and riddles from their files.
+ *  1) Load characters, random events, and riddles.
  *  2) Let players choose characters.
  *  3) Let players choose their paths (Training or Direct Lab).
  *  4) Run the main gameplay loop via play().
  */
 void Game::run() {
-    // 1) Load all data files needed
-    loadCharactersFromFile("characters.txt");
-    loadRandomEvents("random_events.txt");
-    loadRiddles("riddles.txt");
+    // 1) Load all game data (built-in tables, or the .txt files if asked for)
+    loadAssets();
 
     // 2) Allow each player to choose a scientist character
     chooseCharacters();
@@ -782,3 +975,480 @@ void Game::run() {
     // 4) Run the main game loop
     play();
 }
+
+/*
+ * startJournal:
+ * -------------
+ * Opens a binary journal file. From now on every choice, board seed, move,
+ * tile outcome, DNA strand and riddle answer of this Game is appended to it.
+ * See Journal.h for the record layout.
+ */
+bool Game::startJournal(const char filename[]) {
+    if (!_journal.open(filename)) {
+        _out << "Error: could not open " << filename << endl;
+        return false;
+    }
+    return true;
+}
+
+/*
+ * replay:
+ * -------
+ * Re-runs a journaled game. Inputs come from the journal instead of cin, and every
+ * outcome the game produces is compared to the recorded one. Console output is
+ * switched off while replaying (a stream in a failed state skips all formatting),
+ * so a journal replays as fast as the game logic itself.
+ */
+bool Game::replay(const char filename[]) {
+    if (!_replayReader.open(filename)) {
+        _out << "Error: could not open " << filename << endl;
+        return false;
+    }
+
+    loadAssets();
+
+    _replaying = true;
+    _replayFailed = false;
+    _replayEvents = 0;
+
+    ios::iostate oldState = _out.rdstate();
+    _out.setstate(ios::badbit);
+    chooseCharacters();
+    choosePaths();
+    play();
+    _out.clear(oldState);
+
+    _replaying = false;
+
+    // Leftover entries also mean the replay went a different way than the recording
+    if (!_replayReader.atEnd()) {
+        _replayFailed = true;
+    }
+
+    if (_replayFailed) {
+        _out << "Replay diverged after " << _replayEvents << " matching events.\n";
+    } else {
+        _out << "Replay matched all " << _replayEvents << " events.\n";
+    }
+    return !_replayFailed;
+}
+
+/*
+ * nextReplayEntry:
+ * ----------------
+ * Moves the replay to the next journal entry and checks that it is the kind of
+ * entry (and the player) the game expects right now.
+ */
+bool Game::nextReplayEntry(int type, int player_index) {
+    if (_replayFailed) {
+        return false;
+    }
+    if (!_replayReader.next(_replayEntry) ||
+        _replayEntry.type != type || _replayEntry.player != player_index) {
+        _replayFailed = true;
+        return false;
+    }
+    _replayEvents++;
+    return true;
+}
+
+/*
+ * recordValues:
+ * -------------
+ * Records an outcome. While replaying, the outcome is compared to the journal instead.
+ */
+void Game::recordValues(int type, int player_index, const long long values[], int count) {
+    if (!_replaying) {
+        _journal.writeValues(type, player_index, values, count);
+        return;
+    }
+
+    if (nextReplayEntry(type, player_index)) {
+        long long recorded[8];
+        int recordedCount = decodeJournalValues(_replayEntry, recorded, 8);
+        bool same = (recordedCount == count);
+        for (int i = 0; same && i < count; i++) {
+            same = (recorded[i] == values[i]);
+        }
+        if (!same) {
+            _replayFailed = true;
+        }
+    }
+}
+
+/*
+ * inputChoice:
+ * ------------
+ * Reads a menu choice between low and high (inclusive) that is not equal to excluded.
+ * Keeps asking with invalidMessage until the choice is valid, then journals it.
+ * While replaying, the choice comes from the journal instead of cin.
+ */
+int Game::inputChoice(int type, int player_index, int low, int high, int excluded,
+                      const char invalidMessage[]) {
+    int choice = low;
+
+    // Computer seat: the AI decides, and the choice is journaled like a typed one
+    if (!_replaying && _isAI[player_index]) {
+        choice = aiChoice(type, player_index, excluded);
+        _out << choice << " (computer)\n";
+        long long value = choice;
+        _journal.writeValues(type, player_index, &value, 1);
+        return choice;
+    }
+
+    if (_replaying) {
+        long long value = 0;
+        if (nextReplayEntry(type, player_index) && decodeJournalValues(_replayEntry, &value, 1) == 1) {
+            choice = (int)value;
+        }
+        // A damaged journal must not leave the game with an invalid choice
+        if (choice < low || choice > high || choice == excluded) {
+            _replayFailed = true;
+            choice = (low == excluded) ? low + 1 : low;
+        }
+        return choice;
+    }
+
+    TRACE_SCOPE("waitForInput");
+    _in >> choice;
+    while (!_in || choice < low || choice > high || choice == excluded) {
+        if (!_in) {
+            // Input closed: nothing more will come, so take the first valid choice
+            if (_in.eof()) {
+                choice = (low == excluded) ? low + 1 : low;
+                break;
+            }
+            // Not a number: skip the rest of the line and ask again
+            _in.clear();
+            _in.ignore(numeric_limits<streamsize>::max(), '\n');
+        }
+        _out << invalidMessage;
+        _in >> choice;
+    }
+
+    long long value = choice;
+    _journal.writeValues(type, player_index, &value, 1);
+    return choice;
+}
+
+/*
+ * inputToken:
+ * -----------
+ * Reads one word (such as a DNA strand) with cin >>, or takes it from the journal.
+ */
+ScratchString Game::inputToken(int type, int player_index) {
+    ScratchString text(&_scratch);
+    if (_replaying) {
+        if (nextReplayEntry(type, player_index)) {
+            text.assign(_replayEntry.bytes);
+        }
+        return text;
+    }
+
+    if (_isAI[player_index]) {
+        // The same strand twice is a perfect answer to every DNA task
+        text = "ACGT";
+        _out << text << " (computer)\n";
+    } else {
+        TRACE_SCOPE("waitForInput");
+        _in >> text;
+    }
+    _journal.writeText(type, player_index, text);
+    return text;
+}
+
+/*
+ * inputLine:
+ * ----------
+ * Reads a whole line (such as a riddle answer), or takes it from the journal.
+ */
+ScratchString Game::inputLine(int type, int player_index) {
+    ScratchString text(&_scratch);
+    if (_replaying) {
+        if (nextReplayEntry(type, player_index)) {
+            text.assign(_replayEntry.bytes);
+        }
+        return text;
+    }
+
+    if (_isAI[player_index]) {
+        // The AI does not know the riddle answers and passes
+        _out << "(computer passes)\n";
+    } else {
+        // Clear leftover newline in input buffer once
+        // so that getline reads the user's full answer correctly.
+        TRACE_SCOPE("waitForInput");
+        _in.ignore(1, '\n');
+        getline(_in, text);
+    }
+    _journal.writeText(type, player_index, text);
+    return text;
+}
+
+void Game::setSpectatorFeed(SpectatorFeed* feed) {
+    _spectators = feed;
+}
+
+void Game::setResultCache(ResultCache* cache) {
+    _resultCache = cache;
+}
+
+void Game::setAllowIndels(bool allow) {
+    _allowIndels = allow;
+}
+
+void Game::setAllocationCounter(AllocationCounter counter) {
+    _allocationCounter = counter;
+}
+
+long long Game::getTurnAllocations() const {
+    return _turnAllocations;
+}
+
+/*
+ * getState:
+ * ---------
+ * Copies the changing part of the game (board seed and positions, player stats,
+ * counters and random generator) into a flat GameState. Names are stored as
+ * character indexes, so the copy never allocates.
+ */
+GameState Game::getState() const {
+    GameState state;
+    memset(&state, 0, sizeof(GameState));
+
+    state.boardSeed = _board.getSeed();
+    state.rngState = _rngState;
+    state.boardSize = _board.getBoardSize();
+    state.greenToggle = _greenToggle;
+    state.nextRiddleIndex = _nextRiddleIndex;
+
+    for (int i = 0; i < 2; i++) {
+        state.positions[i] = _board.getPlayerPosition(i);
+
+        PlayerState& p = state.players[i];
+        p.experience = _players[i].getExperience();
+        p.accuracy = _players[i].getAccuracy();
+        p.efficiency = _players[i].getEfficiency();
+        p.insight = _players[i].getInsight();
+        p.discoverPoints = _players[i].getDiscoverPoints();
+        p.nameId = (short)_characterIds[i];
+        p.pathType = (char)_players[i].getPathType();
+        p.advisor = (char)_players[i].getAdvisor();
+        p.finished = _players[i].getFinished() ? 1 : 0;
+    }
+    return state;
+}
+
+/*
+ * setState:
+ * ---------
+ * Puts the game back into a state taken with getState. Characters must already
+ * be loaded so the name indexes can be turned back into names.
+ */
+void Game::setState(const GameState& state) {
+    _board = Board(state.boardSize, state.boardSeed);
+    _rngState = state.rngState;
+    _greenToggle = state.greenToggle;
+    _nextRiddleIndex = state.nextRiddleIndex;
+
+    for (int i = 0; i < 2; i++) {
+        _board.setPlayerPosition(i, state.positions[i]);
+
+        const PlayerState& p = state.players[i];
+        string name = "";
+        if (p.nameId >= 0 && p.nameId < (int)_characterOptions.size()) {
+            name = _characterOptions[p.nameId].getName();
+        }
+        _players[i] = Player(name, p.experience, p.accuracy, p.efficiency,
+                             p.insight, p.discoverPoints, p.pathType);
+        _players[i].setAdvisor(p.advisor);
+        _players[i].setFinished(p.finished == 1);
+        _characterIds[i] = p.nameId;
+    }
+}
+
+bool Game::saveState(const char filename[]) const {
+    return saveGameState(filename, getState());
+}
+
+bool Game::loadState(const char filename[]) {
+    GameState state;
+    if (!loadGameState(filename, state)) {
+        _out << "Error: could not load game state from " << filename << endl;
+        return false;
+    }
+    setState(state);
+    return true;
+}
+
+/*
+ * setAIPlayer:
+ * ------------
+ * Hands a seat to the computer. The AI picks the character, path and advisor
+ * with the best expected final score (see AIPlayer.h) and answers DNA tasks itself.
+ */
+void Game::setAIPlayer(int player_index) {
+    if (player_index >= 0 && player_index < 2) {
+        _isAI[player_index] = true;
+    }
+}
+
+/*
+ * aiChoice:
+ * ---------
+ * Answers a menu prompt for a computer seat. Path and advisor are decided together
+ * when the path is asked for; the advisor prompt then repeats that decision.
+ */
+int Game::aiChoice(int type, int player_index, int excluded) {
+    if (type == JOURNAL_CHARACTER_CHOICE) {
+        // Menu numbers are 1-based, the AI works with 0-based indexes
+        return _ai.chooseCharacter(_characterOptions, excluded - 1) + 1;
+    }
+    if (type == JOURNAL_PATH_CHOICE) {
+        int path;
+        _ai.choosePath(_players[player_index], path, _aiAdvisor[player_index]);
+        return path;
+    }
+    if (type == JOURNAL_ADVISOR_CHOICE) {
+        return _aiAdvisor[player_index];
+    }
+    return 0;
+}
+
+/*
+ * setRules / loadRules:
+ * ---------------------
+ * Replace the reward values used by applyPathBonuses, handleDNATask and
+ * triggerRiddle (see Rules.h). The AI is told about the new values too.
+ */
+void Game::setRules(const GameRules& rules) {
+    _rules = rules;
+    _ai.setup(_board, _eventSampler, _rules);
+}
+
+bool Game::loadRules(const char filename[]) {
+    GameRules rules = _rules;
+    if (!loadGameRules(filename, rules)) {
+        _out << "Error: could not open " << filename << endl;
+        return false;
+    }
+    setRules(rules);
+    return true;
+}
+
+/*
+ * loadData / simulate:
+ * --------------------
+ * Headless games for batch runs (balance tuning, statistics). loadData loads the
+ * characters, events and riddles once; simulate can then be called many times.
+ * Each call starts a fresh game from 'seed', so results are repeatable.
+ */
+void Game::loadData() {
+    loadAssets();
+}
+
+int Game::getCharacterCount() const {
+    return _characterOptions.size();
+}
+
+const Player& Game::getCharacterOption(int index) const {
+    return _characterOptions[index];
+}
+
+const Player& Game::getPlayer(int player_index) const {
+    return _players[player_index];
+}
+
+void Game::simulate(const int characters[2], const int paths[2], const int advisors[2],
+                    unsigned long long seed, int scores[2]) {
+    _rngState = seed;
+    _greenToggle = 0;
+    _nextRiddleIndex = 0;
+    _board = Board(_board.getBoardSize(), 0);
+
+    for (int i = 0; i < 2; i++) {
+        _isAI[i] = true;
+        _characterIds[i] = characters[i];
+        _players[i] = _characterOptions[characters[i]];
+        _players[i].setPathType(paths[i]);
+        _players[i].setAdvisor(advisors[i]);
+    }
+    applyPathBonuses();
+
+    play();
+
+    for (int i = 0; i < 2; i++) {
+        scores[i] = calculateFinalScore(_players[i]);
+    }
+}
+
+/*
+ * simulateBatch:
+ * --------------
+ * The same games as simulate, but stepped together one tile at a time in a
+ * PlayerTable. Everyone moves one tile per turn, so after each step every row
+ * is on the same position and the DNA rewards for all rows are one batch update.
+ * Green tiles stay per game: the event toggle and the random generator are
+ * shared by both players of a game and must be used in turn order.
+ */
+void Game::simulateBatch(int games, const int characters[], const int paths[], const int advisors[],
+                         const unsigned long long seeds[], PlayerTable& table, int scores[]) {
+    int rows = games * 2;
+    table.resize(rows);
+
+    vector<string> names;
+    for (int c = 0; c < (int)_characterOptions.size(); c++) {
+        names.push_back(_characterOptions[c].getName());
+    }
+    table.setNames(names);
+
+    for (int r = 0; r < rows; r++) {
+        table.setRow(r, _characterOptions[characters[r]], characters[r]);
+        table[r].setPathType(paths[r]);
+        table[r].setAdvisor(advisors[r]);
+    }
+    table.applyPathBonuses(_rules);
+
+    // Per game: board, random generator and Green toggle, set up like play() does
+    int boardSize = _board.getBoardSize();
+    vector<Board> boards;
+    vector<unsigned long long> rng(seeds, seeds + games);
+    vector<int> greenToggle(games, 0);
+    for (int g = 0; g < games; g++) {
+        boards.push_back(Board(boardSize, nextRandom(rng[g])));
+    }
+
+    vector<char> colors(rows);
+    int* discoverPoints = table.column(PlayerTable::DISCOVER_POINTS);
+    const int* pathColumn = table.column(PlayerTable::PATH_TYPE);
+    const int* advisorColumn = table.column(PlayerTable::ADVISOR);
+
+    // Tiles 1 .. boardSize - 2 have effects; the last tile ends the game
+    for (int pos = 1; pos < boardSize - 1; pos++) {
+        for (int g = 0; g < games; g++) {
+            for (int i = 0; i < 2; i++) {
+                int r = g * 2 + i;
+                colors[r] = boards[g].getTileColor(i, pos);
+                if (colors[r] != 'G') {
+                    continue;
+                }
+                if (greenToggle[g] == 0) {
+                    if (_eventSampler.hasEvents(pathColumn[r], advisorColumn[r])) {
+                        SampledEvent picked = _eventSampler.sample(pathColumn[r], advisorColumn[r],
+                                                                   nextRandom(rng[g]));
+                        discoverPoints[r] += picked.dpDelta;
+                    }
+                    greenToggle[g] = 1;
+                } else {
+                    greenToggle[g] = 0;
+                }
+            }
+        }
+        table.applyTileEffects(colors.data(), _rules);
+    }
+
+    for (int r = 0; r < rows; r++) {
+        table[r].setFinished(true);
+    }
+    table.calculateFinalScores(scores);
+}
@@ -1,51 +1,121 @@
 #ifndef GAME_H
 #define GAME_H
 
+#include "AIPlayer.h"
 #include "Board.h"
+#include "DataLoader.h"
+#include "EventSampler.h"
+#include "GameState.h"
+#include "Journal.h"
 #include "Player.h"
+#include "PlayerTable.h"
+#include "ResultCache.h"
+#include "Rules.h"
+#include "ScratchArena.h"
+#include "SpectatorFeed.h"
+#include <iostream>
 #include <string>
+#include <string_view>
+#include <vector>
 using namespace std;
 
+// Returns how many heap allocations the calling thread has made so far
+typedef long long (*AllocationCounter)();
+
 class Game {
 private:
     // Store info about a single random event read from random_events.txt
+    // Text fields point into _text (no separate string per event)
     struct RandomEvent {
-        string description;
+        string_view description;
         int pathType;
         int advisorType;
         int dpDelta;
+        int weight;        // relative chance among events of the same path
     };
 
     // Store info about a single riddle from riddles.txt
     struct Riddle {
-        string question;
-        string answer;
+        string_view question;
+        string_view answer;
+        string_view answerLower;   // answer in lowercase, made once when loading
     };
 
+    ostream& _out;       // Where the game prints (cout unless told otherwise)
+    istream& _in;        // Where players type (cin unless told otherwise)
+
+    GameRules _rules;    // Reward values for paths and tiles
+
     Board _board;        // The game board
     Player _players[2];  // Two players in the game
 
-    // Limits for how many things we can store
-    static const int MAX_EVENTS = 60;
-    static const int MAX_RIDDLES = 30;
-    static const int MAX_CHARACTERS = 10;
+    // One arena holds the text of every loaded event and riddle
+    TextArena _text;
+
+    // Events / riddles / character options (grow to fit the files)
+    vector<RandomEvent> _events;
+    vector<Riddle> _riddles;
+    vector<Player> _characterOptions;
+
+    // Alias tables for picking random events by path and advisor
+    EventSampler _eventSampler;
+
+    // Read the .txt files instead of the built-in data
+    bool _useDataFiles;
+
+    // Computer-controlled seats
+    AIPlayer _ai;
+    bool _isAI[2];
+    int _aiAdvisor[2];   // advisor the AI picked together with its path
+
+    // Which character option each player picked (-1 = none yet)
+    int _characterIds[2];
 
-    // Arrays to hold events / riddles / character options
-    RandomEvent _events[MAX_EVENTS];
-    int _eventCount;
+    // Random generator state (SplitMix64, see Random.h); used for board seeds
+    unsigned long long _rngState;
 
-    Riddle _riddles[MAX_RIDDLES];
-    int _riddleCount;
+    // Turn-to-turn counters (kept here instead of as statics so a replay starts fresh)
+    int _greenToggle;
+    int _nextRiddleIndex;
 
-    Player _characterOptions[MAX_CHARACTERS];
-    int _characterCount;
+    // Session journal (recording) and replay state
+    JournalWriter _journal;
+    JournalReader _replayReader;
+    JournalEntry _replayEntry;
+    bool _replaying;
+    bool _replayFailed;
+    long _replayEvents;
+
+    // Live view for other processes (nullptr = nobody is watching)
+    SpectatorFeed* _spectators;
+    SpectatorSnapshot _spectatorSnapshot;
+
+    // Remembered DNA task results (nullptr = always run the task)
+    ResultCache* _resultCache;
+
+    // Blue tiles accept strands that differ by inserted/deleted bases
+    bool _allowIndels;
+
+    // Strands and answers typed during a turn live here; reset every turn
+    ScratchArena _scratch;
+    // Counts heap allocations, if set (see AllocationCheck.cpp)
+    AllocationCounter _allocationCounter;
+    // Heap allocations made during the turns of the last play()
+    long long _turnAllocations;
 
     // ----- Helper functions used inside the Game -----
 
+    // Shared by both constructors
+    void initialize();
+
     // File loaders
     void loadCharactersFromFile(const char filename[]);
     void loadRandomEvents(const char filename[]);
     void loadRiddles(const char filename[]);
+    // Built-in data (see Assets.h) or the files above, depending on _useDataFiles
+    void loadBundledAssets();
+    void loadAssets();
+    void buildEventSampler();
 
     // Setup choices
     void chooseCharacters();
@@ -60,12 +130,80 @@ private:
     void handleDNATask(int player_index, char color);
 
     // Scoring
-    int calculateFinalScore(const Player& p) const;
     void announceWinner() const;
 
+    // Spectator feed: tile colors and names once per game, state every turn
+    void startSpectatorSnapshot();
+    void publishSpectators(bool gameOver);
+
+    // Journal helpers: read input from cin (and record it) or from the replay journal
+    bool nextReplayEntry(int type, int player_index);
+    void recordValues(int type, int player_index, const long long values[], int count);
+    int inputChoice(int type, int player_index, int low, int high, int excluded,
+                    const char invalidMessage[]);
+    int aiChoice(int type, int player_index, int excluded);
+    ScratchString inputToken(int type, int player_index);
+    ScratchString inputLine(int type, int player_index);
+
 public:
     Game();   // constructor
+    explicit Game(ostream& out);   // constructor that prints to 'out' instead of cout
+    Game(istream& in, ostream& out);   // reads from 'in' instead of cin (server sessions)
     void run(); // entry point to run the whole game
+
+    // Load characters.txt, random_events.txt and riddles.txt instead of the built-in data
+    void useDataFiles();
+
+    // Let the computer play the given seat (0 = Player 1, 1 = Player 2)
+    void setAIPlayer(int player_index);
+
+    // Replace the reward values (call before run, or between simulations)
+    void setRules(const GameRules& rules);
+    bool loadRules(const char filename[]);
+
+    // Plays one whole game with no input: both seats are computer players with the
+    // given characters, paths and advisors. Returns the final scores in scores[]
+    // Data must be loaded first with loadData()
+    void loadData();
+    int getCharacterCount() const;
+    const Player& getCharacterOption(int index) const;
+    const Player& getPlayer(int player_index) const;
+    void simulate(const int characters[2], const int paths[2], const int advisors[2],
+                  unsigned long long seed, int scores[2]);
+    // Plays many games at once with the same results as simulate. Game g uses
+    // rows 2g and 2g+1 of characters/paths/advisors/scores and seeds[g]; the
+    // finished players are left in 'table' (same row numbers)
+    void simulateBatch(int games, const int characters[], const int paths[], const int advisors[],
+                       const unsigned long long seeds[], PlayerTable& table, int scores[]);
+
+    // Final score of a player (also used by the AI to judge positions)
+    static int calculateFinalScore(const Player& p);
+
+    // Record every input and outcome of the next run() into a binary journal
+    bool startJournal(const char filename[]);
+    // Re-run a recorded journal without reading stdin; returns true if every outcome matched
+    bool replay(const char filename[]);
+
+    // Publish every turn of the next run() to a spectator feed (see SpectatorFeed.h)
+    void setSpectatorFeed(SpectatorFeed* feed);
+
+    // Answer repeated DNA tasks from a result cache (see ResultCache.h); may be shared by many games
+    void setResultCache(ResultCache* cache);
+
+    // Let blue tiles compare strands of different lengths (aligned, see Alignment.h)
+    void setAllowIndels(bool allow);
+
+    // Count the heap allocations made during turns with 'counter' (a running
+    // total for the calling thread); only the allocation check program does this
+    void setAllocationCounter(AllocationCounter counter);
+    // Heap allocations made during the turns of the last game (0 without a counter)
+    long long getTurnAllocations() const;
+
+    // Snapshot / restore the changing part of the game (see GameState.h)
+    GameState getState() const;
+    void setState(const GameState& state);
+    bool saveState(const char filename[]) const;
+    bool loadState(const char filename[]);
 };
 
 #endif
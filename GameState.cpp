@@ -0,0 +1,85 @@
+#include "GameState.h"
+#include <cstring>
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+#ifdef _WIN32
+
+// No mmap on Windows: fall back to a normal binary file
+bool saveGameState(const char filename[], const GameState& state) {
+    ofstream fout(filename, ios::binary | ios::trunc);
+    if (!fout.is_open()) {
+        return false;
+    }
+    fout.write((const char*)&state, sizeof(GameState));
+    return fout.good();
+}
+
+bool loadGameState(const char filename[], GameState& state) {
+    ifstream fin(filename, ios::binary);
+    if (!fin.is_open()) {
+        return false;
+    }
+    fin.read((char*)&state, sizeof(GameState));
+    return fin.gcount() == sizeof(GameState);
+}
+
+#else
+
+// The file is exactly one GameState: size it, map it, and copy the bytes in
+bool saveGameState(const char filename[], const GameState& state) {
+    int fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    if (ftruncate(fd, sizeof(GameState)) != 0) {
+        close(fd);
+        return false;
+    }
+
+    void* map = mmap(0, sizeof(GameState), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+
+    memcpy(map, &state, sizeof(GameState));
+    bool ok = msync(map, sizeof(GameState), MS_SYNC) == 0;
+    munmap(map, sizeof(GameState));
+    return ok;
+}
+
+bool loadGameState(const char filename[], GameState& state) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    // Reject files that are not exactly one state (wrong file or older layout)
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size != (off_t)sizeof(GameState)) {
+        close(fd);
+        return false;
+    }
+
+    void* map = mmap(0, sizeof(GameState), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+
+    memcpy(&state, map, sizeof(GameState));
+    munmap(map, sizeof(GameState));
+    return true;
+}
+
+#endif
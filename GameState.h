@@ -0,0 +1,40 @@
+#ifndef GAMESTATE_H
+#define GAMESTATE_H
+
+#include <type_traits>
+
+// Flat copy of everything that changes during a game
+// No strings or pointers: names are stored as indexes into the character list,
+// so a whole game can be copied (forked) with a plain memcpy or assignment
+
+struct PlayerState {
+    int experience;
+    int accuracy;
+    int efficiency;
+    int insight;
+    int discoverPoints;
+    short nameId;        // index into the loaded characters (-1 = unknown)
+    char pathType;       // 0 = Fellowship Training, 1 = Direct Lab
+    char advisor;        // 0 = none, 1..5 = advisor
+    char finished;       // 1 once the final tile is reached
+};
+
+struct GameState {
+    unsigned long long boardSeed;   // tiles are generated from this seed
+    unsigned long long rngState;    // Game's random generator (also picks random events)
+    int boardSize;
+    int positions[2];
+    PlayerState players[2];
+    int greenToggle;                // event/no-event toggle for Green tiles
+    int nextRiddleIndex;            // riddle cursor
+};
+
+// Make sure a GameState really is safe to memcpy and stays small
+static_assert(std::is_trivially_copyable<GameState>::value, "GameState must be trivially copyable");
+static_assert(sizeof(GameState) <= 256, "GameState must fit in 256 bytes");
+
+// Save / load a state to a file (memory-mapped where the system supports it)
+bool saveGameState(const char filename[], const GameState& state);
+bool loadGameState(const char filename[], GameState& state);
+
+#endif
@@ -0,0 +1,178 @@
+// GENERATED by AssetCompiler.cpp from characters.txt, random_events.txt and riddles.txt
+// Do not edit by hand: rebuild with ./asset_compiler > GeneratedAssets.cpp
+
+#include "Assets.h"
+
+static constexpr char ASSET_TEXT[] =
+    "Dr.LeoDr.HelixDr.PantheraDr.AdenineDr.K-merA critical DNA sample"
+    " is contaminatedThe main DNA sequencer machine breaks downYour b"
+    "ioinformatics script has a bugYour population model overfits! Th"
+    "e results are meaninglessYou spill an entire 96-well plateData s"
+    "torage server is fullFatigue from long lab hours causes a major "
+    "errorYour mentor points out a fundamental flaw in your methodBud"
+    "get cuts! The lab is out of your favorite brand of pipettesFaile"
+    "d a pop quiz from your training fellowship mentorFailed an exper"
+    "iment due to the wrong temperatureYour data pipeline corrupts a "
+    "batch of other filesYour freezer breaks overnight, ruining 50 sa"
+    "mplesYour statistical analysis mistakes a lion family group for "
+    "an unrelated oneA lion tracking collar malfunctions, you lose a "
+    "month of field dataStruggled to understand a complex stats model"
+    " in trainingThe high-performance computer is down for maintenanc"
+    "eMisread and label and sequences the wrong lion's DNAYour analys"
+    "is of a lion's lineage is proven incorrect by new field dataA my"
+    "sterious contamination shows up in your control samplesA tip fro"
+    "m Dr. Bio-Script helps your script run 50% fasterYou discover an"
+    " overlooked, archived tissue sample from a key lionA senior scie"
+    "ntist praises your lab notesYour risky direct assignments pays o"
+    "ff with surprisingly clean resultsYou help a co-worker debug the"
+    "ir sequence alignment codeA breakthrough! Your new script works "
+    "on the first tryYour analysis correctly identifies the two most "
+    "inbred lions in the populationAn anonymous donor, impressed by t"
+    "he lion project, funds new sequencersYou find an extra box of a "
+    "rare, expensive enzymeThe lion conservation team sends a \042thank "
+    "you\042 card for your dataSequencing run has an incredibly high qua"
+    "lity scoreYou finally master Dr. Aliquot's difficult DNA extract"
+    "ion protocolA new sample works perfectly for sequencingA co-work"
+    "ers shares a bioinformatics script that saves you a day of workY"
+    "ou identify a rare DNA sequence in the lion populationA sales re"
+    "p leaves a box of free pipettesDr. Loci is impressed by your dee"
+    "p understanding of the new sequencer's manualDr. Aliquot's proto"
+    "col tip doubles your DNA yieldUse Dr. Bio-Script's C++ trick to "
+    "automate a boring data-entry taskFound a calculation error in th"
+    "e lion's genomic database, saving a future analysisYour data get"
+    "s added to the main lion conservation databseYour data is used t"
+    "o successfully reunite a lost lion cub with its prideLab-wide pi"
+    "zza party!Used Dr. Assembler's workflow to process a whole batch"
+    " in one afternoonYou noticed a pattern in the junk DNAYour analy"
+    "sis confirms that presence of a new gene variantThe machine you "
+    "need is available when you need itYour lab received new equipmen"
+    "tloopI can iterate endlessly or break on command. I\342\200\231m great at"
+    " looping through tasks. What am I\077 (single word, lowercase)==I a"
+    "m the symbol used to compare two values for equality. What am I\077"
+    " (symbol)voidI\342\200\231m a function without a return type. What am I\077 "
+    "(single word, lowercase)booleanI can be true or false, but never"
+    " both. What am I\077 (single word, lowercase)vectorI can hold many "
+    "values, but I\342\200\231m defined with a single keyword. What am I\077 (sin"
+    "gle word, lowercase)objectI\342\200\231m a class that hides its data, but"
+    " exposes its behavior. What am I\077 (single word, lowercase)0I am "
+    "the first number of an array index in C++. What am I\077 (integer)8"
+    "I am the number of bits in a byte. What am I\077 (integer)codeI con"
+    "tain instructions but no emotions. When you debug me, I feel no "
+    "pain. What am I\077 (single word, lowercase)constantI\342\200\231m a variabl"
+    "e, but I don\342\200\231t change my value. What am I\077 (single word, lower"
+    "case)operatorI\342\200\231m overloaded but not stressed. What am I\077 (sing"
+    "le word, lowercase)programI take input, process it, and give out"
+    "put, but I\342\200\231m not human. What am I\077 (single word, lowercase)alg"
+    "orithmI split problems into smaller parts to solve them efficien"
+    "tly. What am I\077 (single word, lowercase)commentI\342\200\231m written in "
+    "code but never executed. What am I\077 (single word, lowercase)%I a"
+    "m the C++ operator used to determine the remainder of a division"
+    ". What am I\077 (symbol)arrayI store values sequentially, but I\342\200\231m"
+    " not a line of text. What am I\077 (single word, lowercase)stackI\342\200"
+    "\231m the place where local variables go to live and die. What am I"
+    "\077 (single word, lowercase)mainI\342\200\231m a single word, but I can bri"
+    "ng a function to life. What am I\077 (single word, lowercase)ifI ca"
+    "n compare two things, but I don\342\200\231t judge. What am I\077 (single wo"
+    "rd, lowercase)//I start a comment in C++. What am I\077 (symbol)4I "
+    "am the number of spaces a tab character is typically equivalent "
+    "to. What am I\077 (integer)functionI\342\200\231m called, but I never come. "
+    "I\342\200\231m always executed. What am I\077 (single word, lowercase)infini"
+    "teI\342\200\231m a condition that never resolves to true or false. What a"
+    "m I\077 (single word, lowercase).I am the symbol used to access a m"
+    "ember of a class. What am I\077 (symbol)classI can hold multiple fu"
+    "nctions, but I\342\200\231m not a list. What am I\077 (single word, lowercas"
+    "e)";
+
+static constexpr AssetCharacter ASSET_CHARACTERS[] = {
+    {{0, 6}, 5, 500, 500, 1000, 20000},
+    {{6, 8}, 8, 900, 600, 600, 20000},
+    {{14, 11}, 12, 900, 700, 500, 20000},
+    {{25, 10}, 7, 600, 500, 900, 20000},
+    {{35, 8}, 18, 1000, 500, 500, 20000},
+};
+
+static constexpr AssetEvent ASSET_EVENTS[] = {
+    {{43, 37}, 1, 1, -500, 1},
+    {{80, 42}, 0, 2, -200, 1},
+    {{122, 36}, 1, 4, -400, 1},
+    {{158, 59}, 0, 3, -700, 1},
+    {{217, 33}, 1, 1, -800, 1},
+    {{250, 27}, 0, 2, -300, 1},
+    {{277, 48}, 1, 5, -1000, 1},
+    {{325, 56}, 0, 2, -500, 1},
+    {{381, 62}, 1, 0, -300, 1},
+    {{443, 54}, 0, 5, -800, 1},
+    {{497, 49}, 1, 1, -600, 1},
+    {{546, 50}, 0, 4, -800, 1},
+    {{596, 49}, 1, 2, -400, 1},
+    {{645, 75}, 0, 3, -600, 1},
+    {{720, 67}, 1, 0, -700, 1},
+    {{787, 57}, 0, 5, -500, 1},
+    {{844, 53}, 1, 2, -300, 1},
+    {{897, 52}, 0, 4, -500, 1},
+    {{949, 71}, 1, 3, -400, 1},
+    {{1020, 59}, 0, 1, -300, 1},
+    {{1079, 58}, 1, 0, 800, 1},
+    {{1137, 66}, 0, 0, 600, 1},
+    {{1203, 41}, 1, 0, 500, 1},
+    {{1244, 70}, 0, 0, 500, 1},
+    {{1314, 56}, 1, 0, 700, 1},
+    {{1370, 54}, 0, 0, 300, 1},
+    {{1424, 78}, 1, 0, 1000, 1},
+    {{1502, 71}, 0, 0, 400, 1},
+    {{1573, 49}, 1, 0, 500, 1},
+    {{1622, 65}, 0, 0, 300, 1},
+    {{1687, 51}, 1, 0, 400, 1},
+    {{1738, 66}, 0, 0, 600, 1},
+    {{1804, 43}, 1, 0, 500, 1},
+    {{1847, 72}, 0, 0, 400, 1},
+    {{1919, 55}, 1, 0, 500, 1},
+    {{1974, 41}, 0, 0, 600, 1},
+    {{2015, 78}, 1, 0, 600, 1},
+    {{2093, 49}, 0, 0, 700, 1},
+    {{2142, 67}, 1, 0, 500, 1},
+    {{2209, 82}, 0, 0, 700, 1},
+    {{2291, 58}, 1, 0, 200, 1},
+    {{2349, 72}, 1, 0, 400, 1},
+    {{2421, 21}, 0, 0, 300, 1},
+    {{2442, 71}, 1, 0, 500, 1},
+    {{2513, 37}, 0, 0, 800, 1},
+    {{2550, 58}, 1, 0, 500, 1},
+    {{2608, 50}, 0, 0, 600, 1},
+    {{2658, 31}, 1, 0, 700, 1},
+};
+
+static constexpr AssetRiddle ASSET_RIDDLES[] = {
+    {{2693, 118}, {2689, 4}, {2689, 4}},
+    {{2813, 76}, {2811, 2}, {2811, 2}},
+    {{2893, 75}, {2889, 4}, {2889, 4}},
+    {{2975, 75}, {2968, 7}, {2968, 7}},
+    {{3056, 100}, {3050, 6}, {3050, 6}},
+    {{3162, 96}, {3156, 6}, {3156, 6}},
+    {{3259, 68}, {3258, 1}, {3258, 1}},
+    {{3328, 55}, {3327, 1}, {3327, 1}},
+    {{3387, 110}, {3383, 4}, {3383, 4}},
+    {{3505, 84}, {3497, 8}, {3497, 8}},
+    {{3597, 70}, {3589, 8}, {3589, 8}},
+    {{3674, 99}, {3667, 7}, {3667, 7}},
+    {{3782, 98}, {3773, 9}, {3773, 9}},
+    {{3887, 77}, {3880, 7}, {3880, 7}},
+    {{3965, 88}, {3964, 1}, {3964, 1}},
+    {{4058, 94}, {4053, 5}, {4053, 5}},
+    {{4157, 93}, {4152, 5}, {4152, 5}},
+    {{4254, 92}, {4250, 4}, {4250, 4}},
+    {{4348, 82}, {4346, 2}, {4346, 2}},
+    {{4432, 45}, {4430, 2}, {4430, 2}},
+    {{4478, 90}, {4477, 1}, {4477, 1}},
+    {{4576, 90}, {4568, 8}, {4568, 8}},
+    {{4674, 91}, {4666, 8}, {4666, 8}},
+    {{4766, 71}, {4765, 1}, {4765, 1}},
+    {{4842, 88}, {4837, 5}, {4837, 5}},
+};
+
+extern const AssetBundle BUNDLED_ASSETS = {
+    ASSET_TEXT,
+    ASSET_CHARACTERS, 5,
+    ASSET_EVENTS, 48,
+    ASSET_RIDDLES, 25
+};
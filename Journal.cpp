@@ -0,0 +1,185 @@
+#include "Journal.h"
+
+using namespace std;
+
+// =========================== Varint helpers ===========================
+
+// Zigzag maps small negative numbers to small positive ones (0,-1,1,-2 -> 0,1,2,3)
+// so they still take only one or two varint bytes
+int encodeJournalValues(const long long values[], int count, unsigned char out[], int capacity) {
+    int used = 0;
+    for (int i = 0; i < count; i++) {
+        unsigned long long zigzag = ((unsigned long long)values[i] << 1) ^ (unsigned long long)(values[i] >> 63);
+        // 7 bits per byte, high bit set while more bytes follow
+        do {
+            if (used == capacity) {
+                return -1;
+            }
+            unsigned char byte = zigzag & 0x7F;
+            zigzag >>= 7;
+            if (zigzag != 0) {
+                byte |= 0x80;
+            }
+            out[used] = byte;
+            used++;
+        } while (zigzag != 0);
+    }
+    return used;
+}
+
+int decodeJournalValues(const JournalEntry& entry, long long values[], int max_count) {
+    int count = 0;
+    int pos = 0;
+    int size = entry.bytes.size();
+
+    while (pos < size && count < max_count) {
+        unsigned long long zigzag = 0;
+        int shift = 0;
+        unsigned char byte;
+        do {
+            byte = entry.bytes[pos];
+            pos++;
+            zigzag |= (unsigned long long)(byte & 0x7F) << shift;
+            shift += 7;
+        } while ((byte & 0x80) && pos < size && shift < 64);
+
+        values[count] = (long long)(zigzag >> 1) ^ -(long long)(zigzag & 1);
+        count++;
+    }
+    return count;
+}
+
+// =========================== JournalWriter ===========================
+
+JournalWriter::JournalWriter() {
+    _buffered = 0;
+}
+
+JournalWriter::~JournalWriter() {
+    close();
+}
+
+bool JournalWriter::open(const char filename[]) {
+    close();
+    _out.open(filename, ios::binary | ios::trunc);
+    if (!_out.is_open()) {
+        return false;
+    }
+    _buffer.resize(_BUFFER_RECORDS);
+    _buffered = 0;
+    return true;
+}
+
+void JournalWriter::close() {
+    if (_out.is_open()) {
+        flush();
+        _out.close();
+    }
+}
+
+bool JournalWriter::isOpen() const {
+    return _out.is_open();
+}
+
+void JournalWriter::flush() {
+    if (_buffered > 0) {
+        _out.write((const char*)&_buffer[0], (long)_buffered * sizeof(JournalRecord));
+        _out.flush();
+        _buffered = 0;
+    }
+}
+
+void JournalWriter::writeBytes(int type, int player, const unsigned char bytes[], int count) {
+    int pos = 0;
+    // Always write at least one record, even for an empty payload
+    do {
+        if (_buffered == _BUFFER_RECORDS) {
+            flush();
+        }
+        JournalRecord& record = _buffer[_buffered];
+        int chunk = count - pos;
+        if (chunk > JOURNAL_PAYLOAD_SIZE) {
+            chunk = JOURNAL_PAYLOAD_SIZE;
+        }
+
+        record.type = (unsigned char)type;
+        record.player = (unsigned char)player;
+        record.length = (unsigned char)chunk;
+        record.more = (pos + chunk < count) ? 1 : 0;
+        for (int i = 0; i < JOURNAL_PAYLOAD_SIZE; i++) {
+            record.payload[i] = (i < chunk) ? bytes[pos + i] : 0;
+        }
+
+        _buffered++;
+        pos += chunk;
+    } while (pos < count);
+}
+
+void JournalWriter::writeValues(int type, int player, const long long values[], int count) {
+    if (!_out.is_open()) {
+        return;
+    }
+    // A 64-bit varint is at most 10 bytes
+    unsigned char bytes[10 * 8];
+    if (count > 8) {
+        count = 8;
+    }
+    int used = encodeJournalValues(values, count, bytes, sizeof(bytes));
+    writeBytes(type, player, bytes, used);
+}
+
+void JournalWriter::writeText(int type, int player, string_view text) {
+    if (!_out.is_open()) {
+        return;
+    }
+    writeBytes(type, player, (const unsigned char*)text.data(), text.size());
+}
+
+// =========================== JournalReader ===========================
+
+JournalReader::JournalReader() {
+    _next = 0;
+}
+
+bool JournalReader::open(const char filename[]) {
+    ifstream fin(filename, ios::binary | ios::ate);
+    if (!fin.is_open()) {
+        return false;
+    }
+
+    // ios::ate opened the file at the end, so the position is the file size
+    long size = fin.tellg();
+    fin.seekg(0);
+
+    _records.resize(size / sizeof(JournalRecord));
+    _next = 0;
+    if (!_records.empty()) {
+        fin.read((char*)&_records[0], (long)_records.size() * sizeof(JournalRecord));
+    }
+    fin.close();
+    return true;
+}
+
+bool JournalReader::atEnd() const {
+    return _next >= (int)_records.size();
+}
+
+bool JournalReader::next(JournalEntry& entry) {
+    if (atEnd()) {
+        return false;
+    }
+
+    // Reuse the entry's buffer so replay does not allocate per event
+    entry.bytes.clear();
+    entry.type = _records[_next].type;
+    entry.player = _records[_next].player;
+
+    bool more = true;
+    while (more && !atEnd()) {
+        const JournalRecord& record = _records[_next];
+        entry.bytes.append((const char*)record.payload, record.length);
+        more = record.more == 1;
+        _next++;
+    }
+    return true;
+}
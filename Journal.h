@@ -0,0 +1,92 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// Kinds of entries stored in a game journal
+// Inputs (choices, seeds, typed strands and answers) are what replay feeds back into the Game,
+// outcomes (moves, tile results, final scores) are what replay checks against
+enum JournalEventType {
+    JOURNAL_CHARACTER_CHOICE = 1,
+    JOURNAL_PATH_CHOICE = 2,
+    JOURNAL_BOARD_SEED = 3,
+    JOURNAL_MOVE = 4,
+    JOURNAL_TILE_OUTCOME = 5,
+    JOURNAL_DNA_INPUT = 6,
+    JOURNAL_RIDDLE_ANSWER = 7,
+    JOURNAL_GAME_END = 8,
+    JOURNAL_ADVISOR_CHOICE = 9
+};
+
+// Every record on disk has the same size (32 bytes)
+// Numbers are packed in the payload as zigzag varints, text as raw bytes
+// A payload longer than one record continues in the next record (more == 1)
+const int JOURNAL_PAYLOAD_SIZE = 28;
+
+struct JournalRecord {
+    unsigned char type;
+    unsigned char player;
+    unsigned char length;   // payload bytes used in this record
+    unsigned char more;     // 1 if the entry continues in the next record
+    unsigned char payload[JOURNAL_PAYLOAD_SIZE];
+};
+
+// One logical entry after its records have been joined back together
+struct JournalEntry {
+    int type;
+    int player;
+    string bytes;
+};
+
+// Varint helpers (shared by the writer and the reader)
+int encodeJournalValues(const long long values[], int count, unsigned char out[], int capacity);
+int decodeJournalValues(const JournalEntry& entry, long long values[], int max_count);
+
+// Append-only journal writer
+// Records are collected in memory and written in large blocks, so the game loop
+// only copies a few bytes per event
+class JournalWriter {
+private:
+    static const int _BUFFER_RECORDS = 1024;
+
+    ofstream _out;
+    vector<JournalRecord> _buffer;
+    int _buffered;
+
+    void writeBytes(int type, int player, const unsigned char bytes[], int count);
+    void flush();
+
+public:
+    JournalWriter();
+    ~JournalWriter();
+
+    bool open(const char filename[]);
+    void close();
+    bool isOpen() const;
+
+    void writeValues(int type, int player, const long long values[], int count);
+    void writeText(int type, int player, string_view text);
+};
+
+// Journal reader used by replay
+// The whole file is loaded with one read, then entries are handed out in order
+class JournalReader {
+private:
+    vector<JournalRecord> _records;
+    int _next;
+
+public:
+    JournalReader();
+
+    bool open(const char filename[]);
+    bool atEnd() const;
+    // Fills entry with the next logical entry; returns false at the end of the journal
+    bool next(JournalEntry& entry);
+};
+
+#endif
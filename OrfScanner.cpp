@@ -0,0 +1,346 @@
+#include "OrfScanner.h"
+#include "Bits.h"
+#include "StrandStream.h"
+
+#include <algorithm>
+#include <climits>
+#include <string>
+
+using namespace std;
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// The codons that matter, and what they are on each strand
+enum CodonKind {
+    CODON_START = 0,           // ATG
+    CODON_STOP = 1,            // TAA, TAG, TGA
+    CODON_REVERSE_START = 2,   // CAT (ATG on the other strand)
+    CODON_REVERSE_STOP = 3,    // TTA, CTA, TCA
+    CODON_KINDS = 4
+};
+
+enum Letter { LETTER_A, LETTER_C, LETTER_G, LETTER_T, LETTERS };
+
+// Bit j of masks[letter] is set if bases[j] is that letter (j < count <= 64)
+// Lowercase counts, and U counts as T
+static void letterMasks(const char bases[], int count, unsigned long long masks[]) {
+    const char letters[LETTERS] = {'A', 'C', 'G', 'T'};
+#if defined(__AVX2__)
+    if (count == 64) {
+        // Clearing bit 5 uppercases letters (and leaves nothing else looking like one)
+        __m256i upper = _mm256_set1_epi8((char)0xDF);
+        __m256i low = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)bases), upper);
+        __m256i high = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(bases + 32)), upper);
+        for (int l = 0; l < LETTERS; l++) {
+            __m256i letter = _mm256_set1_epi8(letters[l]);
+            __m256i lowMatch = _mm256_cmpeq_epi8(low, letter);
+            __m256i highMatch = _mm256_cmpeq_epi8(high, letter);
+            if (l == LETTER_T) {
+                __m256i u = _mm256_set1_epi8('U');
+                lowMatch = _mm256_or_si256(lowMatch, _mm256_cmpeq_epi8(low, u));
+                highMatch = _mm256_or_si256(highMatch, _mm256_cmpeq_epi8(high, u));
+            }
+            masks[l] = (unsigned int)_mm256_movemask_epi8(lowMatch) |
+                       ((unsigned long long)(unsigned int)_mm256_movemask_epi8(highMatch) << 32);
+        }
+        return;
+    }
+#elif defined(__SSE2__)
+    if (count == 64) {
+        __m128i upper = _mm_set1_epi8((char)0xDF);
+        __m128i parts[4];
+        for (int q = 0; q < 4; q++) {
+            parts[q] = _mm_and_si128(_mm_loadu_si128((const __m128i*)(bases + 16 * q)), upper);
+        }
+        for (int l = 0; l < LETTERS; l++) {
+            __m128i letter = _mm_set1_epi8(letters[l]);
+            __m128i u = _mm_set1_epi8(l == LETTER_T ? 'U' : letters[l]);
+            unsigned long long mask = 0;
+            for (int q = 0; q < 4; q++) {
+                __m128i match = _mm_or_si128(_mm_cmpeq_epi8(parts[q], letter), _mm_cmpeq_epi8(parts[q], u));
+                mask |= (unsigned long long)(unsigned int)_mm_movemask_epi8(match) << (16 * q);
+            }
+            masks[l] = mask;
+        }
+        return;
+    }
+#endif
+    // Short blocks (or no SIMD): one base at a time
+    for (int l = 0; l < LETTERS; l++) {
+        masks[l] = 0;
+    }
+    for (int j = 0; j < count; j++) {
+        char base = bases[j] & 0xDF;
+        if (base == 'U') {
+            base = 'T';
+        }
+        for (int l = 0; l < LETTERS; l++) {
+            if (base == letters[l]) {
+                masks[l] |= 1ULL << j;
+            }
+        }
+    }
+}
+
+// Turns letter masks into codon masks: bit j is set if a codon of that kind
+// starts at j. 'next' holds the letters of the following 64 bases (a codon
+// starting near the end of the block finishes there)
+static void codonMasks(const unsigned long long letters[], const unsigned long long next[],
+                       unsigned long long kinds[]) {
+    unsigned long long second[LETTERS];
+    unsigned long long third[LETTERS];
+    for (int l = 0; l < LETTERS; l++) {
+        second[l] = (letters[l] >> 1) | (next[l] << 63);
+        third[l] = (letters[l] >> 2) | (next[l] << 62);
+    }
+    const unsigned long long* first = letters;
+    kinds[CODON_START] = first[LETTER_A] & second[LETTER_T] & third[LETTER_G];
+    kinds[CODON_STOP] = first[LETTER_T] & ((second[LETTER_A] & third[LETTER_A]) |
+                                           (second[LETTER_A] & third[LETTER_G]) |
+                                           (second[LETTER_G] & third[LETTER_A]));
+    kinds[CODON_REVERSE_START] = first[LETTER_C] & second[LETTER_A] & third[LETTER_T];
+    kinds[CODON_REVERSE_STOP] = third[LETTER_A] & ((first[LETTER_T] & second[LETTER_T]) |
+                                                   (first[LETTER_C] & second[LETTER_T]) |
+                                                   (first[LETTER_T] & second[LETTER_C]));
+}
+
+// "Nothing open" markers, chosen so an ORF missing its start or stop gets a
+// hugely negative length: length = stop + 3 - start going forward, and
+// reverse start + 3 - reverse stop on the other strand
+static const long long NO_START = LLONG_MAX / 4;
+static const long long NO_REVERSE_START = -(LLONG_MAX / 4);
+static const long long NO_STOP = LLONG_MAX / 4;
+
+// Bits below position p
+static inline unsigned long long bitsBelow(int p) {
+    return (1ULL << p) - 1;
+}
+
+OrfScanner::OrfScanner(int minLength) {
+    // Start and stop codon together are 6 bases, so shorter limits mean the same
+    _minLength = max(minLength, 6);
+    reset();
+}
+
+void OrfScanner::reset() {
+    _position = 0;
+    _pendingCount = 0;
+    for (int f = 0; f < 3; f++) {
+        _forwardStart[f] = NO_START;
+        _reverseStop[f] = NO_STOP;
+        _reverseStart[f] = NO_REVERSE_START;
+    }
+    _found.clear();
+}
+
+// The reverse-strand ORF between the last reverse stop and the last CAT after it
+// (with no stop yet, or no CAT since it, the length comes out negative)
+void OrfScanner::closeReverse(int frame) {
+    long long length = _reverseStart[frame] + 3 - _reverseStop[frame];
+    if (length >= _minLength) {
+        _found.push_back({_reverseStop[frame], length, '-', frame + 1});
+    }
+}
+
+void OrfScanner::codonAt(long long start, const char codon[]) {
+    unsigned long long letters[LETTERS];
+    unsigned long long none[LETTERS] = {0, 0, 0, 0};
+    unsigned long long kinds[CODON_KINDS];
+    letterMasks(codon, 3, letters);
+    codonMasks(letters, none, kinds);
+    // Only bit 0 is a whole codon
+    for (int k = 0; k < CODON_KINDS; k++) {
+        kinds[k] &= 1;
+    }
+    blockCodons(start, kinds);
+}
+
+// Bit j of each mask is the codon starting at blockStart + j
+//
+// Stops are visited in one loop per strand (not one per frame), and the
+// "nothing open" states are numbers that make the length test fail, so the
+// only branch that depends on the bases is writing out an ORF, which is rare
+void OrfScanner::blockCodons(long long blockStart, const unsigned long long kinds[]) {
+    // Bits whose position is 0, 1 or 2 mod 3 (when the block starts at a multiple of 3)
+    const unsigned long long everyThird[3] = {0x9249249249249249ULL, 0x2492492492492492ULL,
+                                              0x4924924924924924ULL};
+    int offset = blockStart % 3;
+    long long minLength = _minLength;
+
+    // Forward strand: each stop ends the ORF from the first ATG after the previous stop
+    unsigned long long starts[3];
+    for (int frame = 0; frame < 3; frame++) {
+        starts[frame] = kinds[CODON_START] & everyThird[(frame - offset + 3) % 3];
+    }
+    unsigned long long stops = kinds[CODON_STOP];
+    while (stops != 0) {
+        int p = trailingZeros(stops);
+        int frame = (offset + p) % 3;
+        unsigned long long before = starts[frame] & bitsBelow(p);
+        long long start = before != 0 ? blockStart + trailingZeros(before) : NO_START;
+        // An ORF already open started before anything in this block
+        start = min(start, _forwardStart[frame]);
+        long long length = blockStart + p + 3 - start;
+        if (length >= minLength) {
+            _found.push_back({start, length, '+', frame + 1});
+        }
+        _forwardStart[frame] = NO_START;
+        starts[frame] &= ~bitsBelow(p);
+        stops &= stops - 1;
+    }
+    for (int frame = 0; frame < 3; frame++) {
+        long long start = starts[frame] != 0 ? blockStart + trailingZeros(starts[frame]) : NO_START;
+        _forwardStart[frame] = min(_forwardStart[frame], start);
+    }
+
+    // Reverse strand: each reverse stop closes the ORF that ends at the
+    // previous one and starts at the last CAT before this one
+    unsigned long long reverseStarts[3];
+    for (int frame = 0; frame < 3; frame++) {
+        reverseStarts[frame] = kinds[CODON_REVERSE_START] & everyThird[(frame - offset + 3) % 3];
+    }
+    unsigned long long reverseStops = kinds[CODON_REVERSE_STOP];
+    while (reverseStops != 0) {
+        int p = trailingZeros(reverseStops);
+        int frame = (offset + p) % 3;
+        unsigned long long before = reverseStarts[frame] & bitsBelow(p);
+        long long start = before != 0 ? blockStart + 63 - leadingZeros(before) : _reverseStart[frame];
+        long long length = start + 3 - _reverseStop[frame];
+        if (length >= minLength) {
+            _found.push_back({_reverseStop[frame], length, '-', frame + 1});
+        }
+        _reverseStop[frame] = blockStart + p;
+        _reverseStart[frame] = NO_REVERSE_START;
+        reverseStarts[frame] &= ~bitsBelow(p);
+        reverseStops &= reverseStops - 1;
+    }
+    for (int frame = 0; frame < 3; frame++) {
+        if (reverseStarts[frame] != 0) {
+            _reverseStart[frame] = blockStart + 63 - leadingZeros(reverseStarts[frame]);
+        }
+    }
+}
+
+void OrfScanner::scan(string_view bases) {
+    long long size = bases.size();
+
+    // Codons that start in the last piece and end in this one
+    if (_pendingCount > 0) {
+        char joined[4];
+        int count = 0;
+        for (int k = 0; k < _pendingCount; k++) {
+            joined[count] = _pending[k];
+            count++;
+        }
+        for (int k = 0; k < 2 && k < size; k++) {
+            joined[count] = bases[k];
+            count++;
+        }
+        long long joinedStart = _position - _pendingCount;
+        for (int k = 0; k + 3 <= count && k < _pendingCount; k++) {
+            codonAt(joinedStart + k, joined + k);
+        }
+    }
+
+    // Codons that start at 0 .. size - 3 of this piece, 64 starts per block
+    long long codonStarts = size - 2;
+    if (codonStarts > 0) {
+        unsigned long long letters[LETTERS];
+        unsigned long long next[LETTERS];
+        unsigned long long kinds[CODON_KINDS];
+        letterMasks(bases.data(), (int)min(size, 64LL), letters);
+        for (long long block = 0; block < codonStarts; block += 64) {
+            long long nextCount = min(size - (block + 64), 64LL);
+            if (nextCount > 0) {
+                letterMasks(bases.data() + block + 64, (int)nextCount, next);
+            } else {
+                for (int l = 0; l < LETTERS; l++) {
+                    next[l] = 0;
+                }
+            }
+            codonMasks(letters, next, kinds);
+            if (codonStarts - block < 64) {
+                for (int k = 0; k < CODON_KINDS; k++) {
+                    kinds[k] &= bitsBelow(codonStarts - block);
+                }
+            }
+            blockCodons(_position + block, kinds);
+            for (int l = 0; l < LETTERS; l++) {
+                letters[l] = next[l];
+            }
+        }
+    }
+
+    // Keep the last two bases for the next piece
+    char keep[2];
+    int keepCount = 0;
+    long long from = max(0LL, size - 2);
+    if (size < 2) {
+        // A tiny piece: some of the old pending bases are still needed
+        for (int k = max(0, _pendingCount + (int)size - 2); k < _pendingCount; k++) {
+            keep[keepCount] = _pending[k];
+            keepCount++;
+        }
+    }
+    for (long long k = from; k < size; k++) {
+        keep[keepCount] = bases[k];
+        keepCount++;
+    }
+    _pendingCount = keepCount;
+    for (int k = 0; k < keepCount; k++) {
+        _pending[k] = keep[k];
+    }
+    _position += size;
+}
+
+void OrfScanner::finish() {
+    for (int f = 0; f < 3; f++) {
+        closeReverse(f);
+        _reverseStop[f] = NO_STOP;
+        _reverseStart[f] = NO_REVERSE_START;
+        // Forward ORFs with no stop before the end are not complete
+        _forwardStart[f] = NO_START;
+    }
+}
+
+const vector<OpenReadingFrame>& OrfScanner::getFound() const {
+    return _found;
+}
+
+void OrfScanner::clearFound() {
+    _found.clear();
+}
+
+int printOpenReadingFrames(const char strandFile[], int minLength, ostream& out) {
+    StrandStream input;
+    if (!input.open(strandFile, STRAND_CHUNK_BASES, 0)) {
+        out << "Error: could not read " << strandFile << endl;
+        return 1;
+    }
+    OrfScanner scanner(minLength);
+    long long total = 0;
+    string_view bases;
+    long long chunkStart;
+    bool more = true;
+    while (more) {
+        more = input.nextChunk(bases, chunkStart);
+        if (more) {
+            scanner.scan(bases);
+        } else {
+            scanner.finish();
+        }
+        // Print as we go, so memory stays the same however long the strand is
+        const vector<OpenReadingFrame>& found = scanner.getFound();
+        for (size_t o = 0; o < found.size(); o++) {
+            out << found[o].strand << found[o].frame << "\t" << found[o].start
+                << "\t" << found[o].length << "\n";
+        }
+        total += found.size();
+        scanner.clearFound();
+    }
+    out << total << " open reading frames of at least " << minLength << " bases in "
+        << input.basesRead() << " bases" << endl;
+    return 0;
+}
@@ -0,0 +1,79 @@
+#ifndef ORFSCANNER_H
+#define ORFSCANNER_H
+
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// Finds open reading frames (ORFs) in all six reading frames of a strand
+//
+// An ORF runs from a start codon (ATG) to the next stop codon (TAA, TAG or
+// TGA) in the same frame. For each stop we report the longest ORF: the one
+// from the first ATG after the previous stop. The other strand of the DNA is
+// read backwards and complemented, so there the same codons show up as CAT
+// (start) and TTA, CTA, TCA (stops), read from right to left.
+//
+// One pass covers all six frames. The bases are looked at 64 at a time: SIMD
+// compares give a 64-bit mask per letter, and a few shifts and ANDs of those
+// turn them into masks of where each kind of codon starts. Only the stop
+// codons are then visited one by one; the start codon that goes with a stop
+// is found with a bit scan. The position mod 3 picks the frame.
+// RNA (U instead of T) and lowercase bases work too.
+//
+// Strands can be fed in pieces (scan is called once per chunk), so memory
+// does not grow with the strand. ORFs are reported when their stop is found
+// on the forward strand, and when the next stop is reached on the reverse
+// strand, so they are not in position order.
+
+struct OpenReadingFrame {
+    long long start;    // 0-based position of the leftmost base
+    long long length;   // bases, including the start and stop codons
+    char strand;        // '+' (as given) or '-' (reverse complement)
+    int frame;          // 1, 2 or 3: (start % 3) + 1
+};
+
+class OrfScanner {
+private:
+    int _minLength;
+    long long _position;   // bases scanned so far
+    // The last two bases of the previous piece (a codon may start there)
+    char _pending[2];
+    int _pendingCount;
+
+    // Forward frames: first ATG since the last stop
+    long long _forwardStart[3];
+    // Reverse frames: last reverse stop and the last CAT after it
+    // (see OrfScanner.cpp for the values that mean "none")
+    long long _reverseStop[3];
+    long long _reverseStart[3];
+
+    vector<OpenReadingFrame> _found;
+
+    void closeReverse(int frame);
+    // One codon, the slow way (for codons split between two pieces)
+    void codonAt(long long start, const char codon[]);
+    // Every codon starting in the (up to) 64 positions from blockStart, given as masks
+    void blockCodons(long long blockStart, const unsigned long long kinds[]);
+
+public:
+    // ORFs shorter than minLength bases are skipped
+    OrfScanner(int minLength);
+
+    void reset();
+    // Scans the next piece of the strand
+    void scan(string_view bases);
+    // Reports the reverse-strand ORFs still waiting for the end of the strand
+    void finish();
+
+    // ORFs found since the last clearFound
+    const vector<OpenReadingFrame>& getFound() const;
+    void clearFound();
+};
+
+// Command line helper: scans the first strand of a strand file (streamed, see
+// StrandStream.h) and prints every ORF of at least minLength bases. Returns the exit code
+int printOpenReadingFrames(const char strandFile[], int minLength, ostream& out);
+
+#endif
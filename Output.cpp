@@ -0,0 +1,209 @@
+#include "Output.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+Output::Output(int fd, OutputLevel level) {
+    _fd = fd;
+    _level = level;
+
+    // Slot i starts out free for the producer that claims position i
+    _slots = new Slot[_RING_SIZE];
+    for (size_t i = 0; i < _RING_SIZE; i++) {
+        _slots[i].sequence.store(i, memory_order_relaxed);
+        _slots[i].length = 0;
+    }
+    _tail.store(0);
+    _head = 0;
+    _writerSleeping.store(false);
+    _stopping.store(false);
+
+    _writer = thread(&Output::writerLoop, this);
+}
+
+Output::~Output() {
+    _stopping.store(true);
+    {
+        lock_guard<mutex> guard(_sleepLock);
+        _wake.notify_one();
+    }
+    _writer.join();
+    delete[] _slots;
+}
+
+OutputLevel Output::getLevel() const {
+    return _level;
+}
+
+bool Output::enabled(OutputLevel level) const {
+    return level != OUTPUT_NONE && level <= _level;
+}
+
+void Output::enqueue(const char* text, size_t length) {
+    while (length > 0) {
+        size_t part = (length < (size_t)_TEXT_SIZE) ? length : (size_t)_TEXT_SIZE;
+
+        // Claim the next slot. Its sequence equals our position when it is free;
+        // a smaller sequence means the writer has not emptied it yet (ring full)
+        size_t position = _tail.load(memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &_slots[position & (_RING_SIZE - 1)];
+            size_t sequence = slot->sequence.load(memory_order_acquire);
+            long difference = (long)(sequence - position);
+            if (difference == 0) {
+                if (_tail.compare_exchange_weak(position, position + 1, memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                // Full: make sure the writer is awake, then wait for it
+                {
+                    lock_guard<mutex> guard(_sleepLock);
+                    _wake.notify_one();
+                }
+                this_thread::yield();
+                position = _tail.load(memory_order_relaxed);
+            } else {
+                // Another producer took this slot first
+                position = _tail.load(memory_order_relaxed);
+            }
+        }
+
+        memcpy(slot->text, text, part);
+        slot->length = (int)part;
+        // Publish: sequence + 1 tells the writer the slot is full
+        slot->sequence.store(position + 1, memory_order_release);
+
+        text += part;
+        length -= part;
+    }
+
+    // Only wake the writer (a system call) if it is actually asleep
+    atomic_thread_fence(memory_order_seq_cst);
+    if (_writerSleeping.load(memory_order_relaxed)) {
+        lock_guard<mutex> guard(_sleepLock);
+        _wake.notify_one();
+    }
+}
+
+// Copies every ready record (up to batchSize bytes) into 'batch' and writes it
+// in one go. Returns false if there was nothing to write.
+bool Output::drain(char* batch, size_t batchSize) {
+    size_t used = 0;
+    while (true) {
+        Slot& slot = _slots[_head & (_RING_SIZE - 1)];
+        if (slot.sequence.load(memory_order_acquire) != _head + 1) {
+            break;   // not filled yet
+        }
+        if (used + slot.length > batchSize) {
+            break;   // next batch
+        }
+        memcpy(batch + used, slot.text, slot.length);
+        used += slot.length;
+        // Free the slot for the producer one lap later
+        slot.sequence.store(_head + _RING_SIZE, memory_order_release);
+        _head++;
+    }
+
+    if (used == 0) {
+        return false;
+    }
+    writeAll(batch, used);
+    return true;
+}
+
+void Output::writeAll(const char* data, size_t length) {
+    while (length > 0) {
+#ifdef _WIN32
+        int written = _write(_fd, data, (unsigned int)length);
+#else
+        ssize_t written = write(_fd, data, length);
+#endif
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;   // nowhere to report it; drop the text
+        }
+        data += written;
+        length -= written;
+    }
+}
+
+void Output::writerLoop() {
+    // The whole ring fits in one batch
+    size_t batchSize = _RING_SIZE * _TEXT_SIZE;
+    char* batch = new char[batchSize];
+
+    while (true) {
+        if (drain(batch, batchSize)) {
+            continue;
+        }
+        if (_stopping.load()) {
+            // Producers are done; one last look for anything published meanwhile
+            if (!drain(batch, batchSize)) {
+                break;
+            }
+            continue;
+        }
+
+        // Nothing to do: sleep until a producer wakes us. The timeout is only
+        // a safety net; producers check _writerSleeping after publishing.
+        unique_lock<mutex> guard(_sleepLock);
+        _writerSleeping.store(true);
+        atomic_thread_fence(memory_order_seq_cst);
+        Slot& next = _slots[_head & (_RING_SIZE - 1)];
+        if (next.sequence.load(memory_order_acquire) != _head + 1 && !_stopping.load()) {
+            _wake.wait_for(guard, chrono::milliseconds(50));
+        }
+        _writerSleeping.store(false);
+    }
+
+    delete[] batch;
+}
+
+// ---------- QueuedBuffer ----------
+
+QueuedBuffer::QueuedBuffer(Output& output) : _output(output) {
+    setp(_buffer, _buffer + sizeof(_buffer));
+}
+
+QueuedBuffer::~QueuedBuffer() {
+    sync();
+}
+
+int QueuedBuffer::overflow(int c) {
+    sync();
+    if (c != traits_type::eof()) {
+        *pptr() = (char)c;
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+int QueuedBuffer::sync() {
+    if (pptr() > pbase()) {
+        _output.enqueue(pbase(), pptr() - pbase());
+        setp(_buffer, _buffer + sizeof(_buffer));
+    }
+    return 0;
+}
+
+// ---------- QueuedStream ----------
+
+QueuedStream::QueuedStream(Output& output, OutputLevel level)
+    : ostream(nullptr), _buffer(output) {
+    // A muted stream keeps no buffer, so it stays failed and prints nothing
+    if (output.enabled(level)) {
+        rdbuf(&_buffer);
+    }
+}
@@ -0,0 +1,110 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <thread>
+
+using namespace std;
+
+// Console output without making the game wait for the terminal
+//
+// Text written to a QueuedStream is collected in the stream's own buffer and,
+// at each flush (endl, a full buffer, or cin asking for input), copied into a
+// bounded ring of fixed-size records. One writer thread empties the ring and
+// hands everything it finds to the system in a single large write().
+//
+// The ring takes records from any number of threads (each thread uses its own
+// QueuedStream) without locks: a producer claims a slot by bumping the tail
+// with compare-and-swap, and each slot has a sequence number that tells the
+// writer when the slot is full and the producers when it is free again.
+//
+// Every stream has a level. A stream whose level is above the Output's level
+// gets no buffer at all, so it is permanently failed and << does no formatting
+// (the same trick Game uses for silent simulations).
+
+enum OutputLevel {
+    OUTPUT_NONE = 0,     // nothing is printed
+    OUTPUT_ERROR = 1,    // errors only
+    OUTPUT_NORMAL = 2,   // normal game text
+    OUTPUT_VERBOSE = 3   // extra detail
+};
+
+class Output {
+private:
+    // One ring slot: up to _TEXT_SIZE bytes of text
+    static const int _TEXT_SIZE = 248;
+    struct Slot {
+        atomic<size_t> sequence;
+        int length;
+        char text[_TEXT_SIZE];
+    };
+
+    static const size_t _RING_SIZE = 1024;   // slots (power of two)
+
+    Slot* _slots;
+    atomic<size_t> _tail;   // next slot a producer will claim
+    size_t _head;           // next slot the writer will read (writer thread only)
+
+    int _fd;
+    OutputLevel _level;
+
+    // The writer sleeps when the ring is empty; producers only touch the
+    // mutex when they see it is asleep
+    mutex _sleepLock;
+    condition_variable _wake;
+    atomic<bool> _writerSleeping;
+    atomic<bool> _stopping;
+    thread _writer;
+
+    void writerLoop();
+    bool drain(char* batch, size_t batchSize);
+    void writeAll(const char* data, size_t length);
+
+public:
+    // Prints to file descriptor 'fd' (1 = standard output); streams above 'level' are muted
+    Output(int fd, OutputLevel level);
+    // Prints everything still in the ring, then stops the writer thread
+    ~Output();
+
+    Output(const Output&) = delete;
+    Output& operator=(const Output&) = delete;
+
+    OutputLevel getLevel() const;
+    bool enabled(OutputLevel level) const;
+
+    // Adds text to the ring (split over several records if it is long).
+    // Waits only if the ring is full.
+    void enqueue(const char* text, size_t length);
+};
+
+// Stream buffer of one producer: collects text and enqueues it on flush
+class QueuedBuffer : public streambuf {
+private:
+    Output& _output;
+    char _buffer[4096];
+
+protected:
+    int overflow(int c) override;
+    int sync() override;
+
+public:
+    explicit QueuedBuffer(Output& output);
+    ~QueuedBuffer();
+};
+
+// An ostream that prints through an Output at a given level
+// Use one per thread; it can be passed anywhere an ostream& is expected (Game, Board, DNAUtils)
+class QueuedStream : public ostream {
+private:
+    QueuedBuffer _buffer;
+
+public:
+    QueuedStream(Output& output, OutputLevel level);
+};
+
+#endif
@@ -0,0 +1,304 @@
+#include "Pipeline.h"
+#include "DNAUtils.h"
+#include "StrandIO.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <thread>
+
+using namespace std;
+
+static double secondsSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// =========================== BatchQueue ===========================
+
+BatchQueue::BatchQueue(size_t capacity) {
+    size_t slots = 2;
+    while (slots < capacity) {
+        slots *= 2;
+    }
+    _slots = new Slot[slots];
+    _mask = slots - 1;
+    // Slot i starts out free for the pusher that claims position i
+    for (size_t i = 0; i < slots; i++) {
+        _slots[i].sequence.store(i, memory_order_relaxed);
+        _slots[i].batch = nullptr;
+    }
+    _tail.store(0);
+    _head.store(0);
+    _sleepers.store(0);
+}
+
+BatchQueue::~BatchQueue() {
+    delete[] _slots;
+}
+
+bool BatchQueue::tryPush(StrandBatch* batch) {
+    size_t position = _tail.load(memory_order_relaxed);
+    while (true) {
+        Slot& slot = _slots[position & _mask];
+        long difference = (long)(slot.sequence.load(memory_order_acquire) - position);
+        if (difference == 0) {
+            if (_tail.compare_exchange_weak(position, position + 1, memory_order_relaxed)) {
+                slot.batch = batch;
+                // sequence = position + 1 tells poppers the slot is filled
+                slot.sequence.store(position + 1, memory_order_release);
+                return true;
+            }
+        } else if (difference < 0) {
+            return false;   // full: the popper one lap behind has not emptied this slot
+        } else {
+            position = _tail.load(memory_order_relaxed);   // another pusher took it
+        }
+    }
+}
+
+bool BatchQueue::tryPop(StrandBatch*& batch) {
+    size_t position = _head.load(memory_order_relaxed);
+    while (true) {
+        Slot& slot = _slots[position & _mask];
+        long difference = (long)(slot.sequence.load(memory_order_acquire) - (position + 1));
+        if (difference == 0) {
+            if (_head.compare_exchange_weak(position, position + 1, memory_order_relaxed)) {
+                batch = slot.batch;
+                // Free the slot for the pusher one lap later
+                slot.sequence.store(position + _mask + 1, memory_order_release);
+                return true;
+            }
+        } else if (difference < 0) {
+            return false;   // empty
+        } else {
+            position = _head.load(memory_order_relaxed);   // another popper took it
+        }
+    }
+}
+
+// Only touches the mutex when somebody is actually asleep
+void BatchQueue::wakeSleepers() {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (_sleepers.load(memory_order_relaxed) > 0) {
+        lock_guard<mutex> guard(_sleepLock);
+        _wake.notify_all();
+    }
+}
+
+void BatchQueue::push(StrandBatch* batch) {
+    int attempts = 0;
+    while (!tryPush(batch)) {
+        if (attempts < 64) {
+            attempts++;
+            this_thread::yield();
+            continue;
+        }
+        // Sleep until a pop makes room (the timeout is only a safety net)
+        unique_lock<mutex> guard(_sleepLock);
+        _sleepers.fetch_add(1);
+        bool pushed = tryPush(batch);
+        if (!pushed) {
+            _wake.wait_for(guard, chrono::milliseconds(10));
+        }
+        _sleepers.fetch_sub(1);
+        if (pushed) {
+            break;
+        }
+    }
+    wakeSleepers();
+}
+
+StrandBatch* BatchQueue::pop() {
+    StrandBatch* batch = nullptr;
+    int attempts = 0;
+    while (!tryPop(batch)) {
+        if (attempts < 64) {
+            attempts++;
+            this_thread::yield();
+            continue;
+        }
+        // Sleep until a push fills a slot
+        unique_lock<mutex> guard(_sleepLock);
+        _sleepers.fetch_add(1);
+        bool popped = tryPop(batch);
+        if (!popped) {
+            _wake.wait_for(guard, chrono::milliseconds(10));
+        }
+        _sleepers.fetch_sub(1);
+        if (popped) {
+            break;
+        }
+    }
+    wakeSleepers();
+    return batch;
+}
+
+// =========================== StrandPipeline ===========================
+
+StrandPipeline::StrandPipeline(int workerCount, size_t batchBases, int batchStrands) {
+    _workerCount = max(workerCount, 1);
+    _batchBases = max(batchBases, (size_t)1);
+    _batchStrands = max(batchStrands, 1);
+    _stats = {0, 0, 0, 0, 0, 0, 0};
+}
+
+bool StrandPipeline::run(const char filename[], const BatchKernel& kernel, ostream& out) {
+    _stats = {0, 0, 0, 0, 0, 0, 0};
+    StrandReader reader;
+    if (!reader.open(filename)) {
+        return false;
+    }
+    auto started = chrono::steady_clock::now();
+
+    // Enough batches for every worker to hold one while the reader fills one
+    // and the writer prints one, with a spare for each so nobody waits on a turn
+    int poolSize = 2 * _workerCount + 2;
+    vector<StrandBatch> pool(poolSize);
+    // Room for the whole pool plus one stop signal per worker, so a push
+    // never has to wait; only the reader waits (for a free batch)
+    BatchQueue freeBatches(poolSize);
+    BatchQueue filledBatches(poolSize + _workerCount);
+    BatchQueue doneBatches(poolSize);
+    for (int b = 0; b < poolSize; b++) {
+        freeBatches.push(&pool[b]);
+    }
+
+    // ---------- Reader ----------
+    thread readerThread([&]() {
+        long long number = 0;
+        bool more = true;
+        while (more) {
+            StrandBatch* batch = freeBatches.pop();
+            auto busy = chrono::steady_clock::now();
+            batch->number = number;
+            batch->count = 0;
+            size_t bases = 0;
+            while (batch->count < _batchStrands && bases < _batchBases) {
+                int k = batch->count;
+                if (k == (int)batch->strands.size()) {
+                    batch->names.emplace_back();
+                    batch->strands.emplace_back();
+                }
+                if (!reader.next(batch->names[k], batch->strands[k])) {
+                    more = false;
+                    break;
+                }
+                bases += batch->strands[k].size();
+                batch->count++;
+            }
+            batch->last = !more;
+            number++;
+            _stats.bases += bases;
+            _stats.readSeconds += secondsSince(busy);
+            filledBatches.push(batch);
+        }
+        // nullptr tells a worker there is nothing more
+        for (int t = 0; t < _workerCount; t++) {
+            filledBatches.push(nullptr);
+        }
+    });
+
+    // ---------- Compute ----------
+    vector<double> computeSeconds(_workerCount, 0);
+    vector<thread> workers;
+    for (int t = 0; t < _workerCount; t++) {
+        workers.push_back(thread([&, t]() {
+            for (StrandBatch* batch = filledBatches.pop(); batch != nullptr; batch = filledBatches.pop()) {
+                auto busy = chrono::steady_clock::now();
+                batch->output.clear();
+                kernel(*batch);
+                computeSeconds[t] += secondsSince(busy);
+                doneBatches.push(batch);
+            }
+        }));
+    }
+
+    // ---------- Writer (this thread) ----------
+    // Batches that arrived before the ones ahead of them, by number. At most
+    // poolSize batches exist, so numbers waiting here never share a place
+    vector<StrandBatch*> waiting(poolSize, nullptr);
+    long long next = 0;
+    bool finished = false;
+    while (!finished) {
+        StrandBatch* batch = doneBatches.pop();
+        auto busy = chrono::steady_clock::now();
+        waiting[batch->number % poolSize] = batch;
+        while (!finished && waiting[next % poolSize] != nullptr) {
+            StrandBatch* ready = waiting[next % poolSize];
+            waiting[next % poolSize] = nullptr;
+            out.write(ready->output.data(), ready->output.size());
+            _stats.strands += ready->count;
+            _stats.batches++;
+            finished = ready->last;
+            next++;
+            freeBatches.push(ready);
+        }
+        _stats.writeSeconds += secondsSince(busy);
+    }
+    out.flush();
+
+    readerThread.join();
+    for (int t = 0; t < _workerCount; t++) {
+        workers[t].join();
+        _stats.computeSeconds += computeSeconds[t];
+    }
+    _stats.wallSeconds = secondsSince(started);
+    return true;
+}
+
+PipelineStats StrandPipeline::getStats() const {
+    return _stats;
+}
+
+void printPipelineStats(const PipelineStats& stats, int workerCount, ostream& out) {
+    out << fixed << setprecision(3);
+    out << stats.strands << " strands (" << stats.bases / 1000000.0 << " M bases) in "
+        << stats.batches << " batches: " << stats.wallSeconds << " s; stages busy: read "
+        << stats.readSeconds << " s, compute " << stats.computeSeconds / workerCount
+        << " s per worker (" << workerCount << " workers), write " << stats.writeSeconds << " s" << endl;
+}
+
+// =========================== Best match of every strand ===========================
+
+int pipelineBestMatch(const char strandFile[], const char targetFile[], double minSimilarity,
+                      int workerCount, ostream& out) {
+    vector<string> targetNames;
+    vector<string> targets;
+    if (!readStrands(targetFile, targetNames, targets) || targets.size() == 0 || targets[0].size() == 0) {
+        out << "Error: could not read a target strand from " << targetFile << endl;
+        return 1;
+    }
+    const string& target = targets[0];
+    int length = target.size();
+
+    atomic<long long> matched(0);
+    BatchKernel kernel = [&](StrandBatch& batch) {
+        long long found = 0;
+        char line[64];
+        for (int s = 0; s < batch.count; s++) {
+            if (batch.strands[s].size() < target.size()) {
+                continue;
+            }
+            StrandMatch best = findBestMatch(batch.strands[s], target);
+            double similarity = best.matches / (double)length;
+            if (similarity >= minSimilarity) {
+                // Same line as --filter-match prints
+                int size = snprintf(line, sizeof(line), "\tindex %d\tsimilarity %.4f\n", best.index, similarity);
+                batch.output += batch.names[s];
+                batch.output.append(line, size);
+                found++;
+            }
+        }
+        matched += found;
+    };
+
+    StrandPipeline pipeline(workerCount);
+    if (!pipeline.run(strandFile, kernel, out)) {
+        out << "Error: could not read " << strandFile << endl;
+        return 1;
+    }
+    out << matched << " matches" << endl;
+    printPipelineStats(pipeline.getStats(), max(workerCount, 1), out);
+    return 0;
+}
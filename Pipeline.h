@@ -0,0 +1,125 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Processes a strand file in three stages that run at the same time
+//
+//   reader (1 thread)  ->  compute (N threads)  ->  writer (the caller)
+//   parses strands         runs a DNA kernel        prints the output of
+//   into batches           on a batch               each batch in file order
+//
+// Done one after the other, a file costs read + compute + write time. Here
+// the reader fills the next batch while the workers compute and the writer
+// prints, so a file costs about as long as the slowest stage.
+//
+// Stages hand each other batches of strands (thousands of records, so the
+// queues are touched once per batch, not once per strand) through bounded
+// lock-free queues. There is a fixed pool of batches: the reader has to wait
+// for the writer to give one back before it can read more, so a slow stage
+// holds up the ones before it instead of letting memory grow (backpressure).
+// Workers may finish batches out of order; the writer keeps them until the
+// batches before them are printed.
+
+// A group of consecutive strands from the file
+struct StrandBatch {
+    long long number;         // position in the file: batches are printed in this order
+    bool last;                // the file ends with this batch (it may be empty)
+    int count;                // strands in use (the vectors keep their memory between uses)
+    vector<string> names;
+    vector<string> strands;
+    string output;            // text the kernel produced, printed by the writer
+};
+
+// Bounded queue of batches for any number of threads on each side
+//
+// A ring of slots, each with a sequence number, like the console ring in
+// Output.h: a thread claims a position by compare-and-swap and the slot's
+// sequence says whether it is filled yet. A thread that finds the queue
+// empty (or full) yields a few times, then sleeps until the other side
+// wakes it.
+class BatchQueue {
+private:
+    struct Slot {
+        atomic<size_t> sequence;
+        StrandBatch* batch;
+    };
+
+    Slot* _slots;
+    size_t _mask;   // slot count - 1 (slot count is a power of two)
+    alignas(64) atomic<size_t> _tail;   // next position to push
+    alignas(64) atomic<size_t> _head;   // next position to pop
+
+    mutex _sleepLock;
+    condition_variable _wake;
+    atomic<int> _sleepers;
+
+    bool tryPush(StrandBatch* batch);
+    bool tryPop(StrandBatch*& batch);
+    void wakeSleepers();
+
+public:
+    // Room for at least 'capacity' batches
+    explicit BatchQueue(size_t capacity);
+    ~BatchQueue();
+
+    BatchQueue(const BatchQueue&) = delete;
+    BatchQueue& operator=(const BatchQueue&) = delete;
+
+    // Waits while the queue is full
+    void push(StrandBatch* batch);
+    // Waits while the queue is empty
+    StrandBatch* pop();
+};
+
+// Runs on a worker thread: reads batch.names/strands[0 .. count), appends to batch.output
+typedef function<void(StrandBatch& batch)> BatchKernel;
+
+// How long each stage was busy (not waiting for another stage)
+struct PipelineStats {
+    long long strands;
+    long long bases;
+    long long batches;
+    double readSeconds;
+    double computeSeconds;   // all workers added up
+    double writeSeconds;
+    double wallSeconds;
+};
+
+class StrandPipeline {
+private:
+    int _workerCount;
+    size_t _batchBases;    // a batch is full at this many bases ...
+    int _batchStrands;     // ... or this many strands
+    PipelineStats _stats;
+
+public:
+    StrandPipeline(int workerCount, size_t batchBases = 1 << 20, int batchStrands = 4096);
+
+    // Runs 'kernel' on every strand of a strand file (see StrandIO.h) and
+    // prints the output to 'out' in file order. False if the file cannot be read
+    bool run(const char filename[], const BatchKernel& kernel, ostream& out);
+
+    // Counts and timings of the last run
+    PipelineStats getStats() const;
+};
+
+// Prints the stage timings of a run on one line
+void printPipelineStats(const PipelineStats& stats, int workerCount, ostream& out);
+
+// Command line helper: bestStrandMatch of the target (first strand of
+// targetFile) in every strand of strandFile, which may be any size.
+// Prints the strands at least minSimilarity alike. Returns the exit code
+int pipelineBestMatch(const char strandFile[], const char targetFile[], double minSimilarity,
+                      int workerCount, ostream& out);
+
+#endif
@@ -8,6 +8,7 @@ Player::Player() {
     _insight = 0;
     _discoverPoints = 0;
     _pathType = 0;
+    _advisor = 0;
     _finished = false;
 }
 
@@ -20,17 +21,19 @@ Player::Player(std::string name, int experience, int accuracy,
     _insight = insight;
     _discoverPoints = discoverPoints;
     _pathType = pathType;
+    _advisor = 0;
     _finished = false;
 }
 
 // Getters
-std::string Player::getName() const { return _name; }
+const std::string& Player::getName() const { return _name; }
 int Player::getExperience() const { return _experience; }
 int Player::getAccuracy() const { return _accuracy; }
 int Player::getEfficiency() const { return _efficiency; }
 int Player::getInsight() const { return _insight; }
 int Player::getDiscoverPoints() const { return _discoverPoints; }
 int Player::getPathType() const { return _pathType; }
+int Player::getAdvisor() const { return _advisor; }
 bool Player::getFinished() const { return _finished; }
 
 // Setters
@@ -41,6 +44,7 @@ void Player::setEfficiency(int efficiency) { _efficiency = efficiency; }
 void Player::setInsight(int insight) { _insight = insight; }
 void Player::setDiscoverPoints(int discoverPoints) { _discoverPoints = discoverPoints; }
 void Player::setPathType(int pathType) { _pathType = pathType; }
+void Player::setAdvisor(int advisor) { _advisor = advisor; }
 void Player::setFinished(bool finished) { _finished = finished; }
 
 // Stat adjust helpers
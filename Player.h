@@ -14,6 +14,7 @@ private:
     int _insight;
     int _discoverPoints;
     int _pathType;   // 0 = Fellowship Training, 1 = Direct Lab
+    int _advisor;    // 0 = none, 1 = Dr. Aliquot ... 5 = Dr. Loci
     bool _finished;  // reached final tile?
 
 public:
@@ -25,13 +26,14 @@ public:
            int efficiency, int insight, int discoverPoints, int pathType);
 
     // Getters
-    string getName() const;
+    const string& getName() const;
     int getExperience() const;
     int getAccuracy() const;
     int getEfficiency() const;
     int getInsight() const;
     int getDiscoverPoints() const;
     int getPathType() const;
+    int getAdvisor() const;
     bool getFinished() const;
 
     // Setters
@@ -42,6 +44,7 @@ public:
     void setInsight(int insight);
     void setDiscoverPoints(int discoverPoints);
     void setPathType(int pathType);
+    void setAdvisor(int advisor);
     void setFinished(bool finished);
 
     // Helper functions to adjust stats
@@ -0,0 +1,248 @@
+#include "PlayerTable.h"
+
+#include <cstring>
+#include <new>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// ---------- PlayerRow ----------
+
+PlayerRow::PlayerRow(PlayerTable* table, int row) {
+    _table = table;
+    _row = row;
+}
+
+string PlayerRow::getName() const {
+    return _table->getName(_table->column(PlayerTable::NAME_ID)[_row]);
+}
+int PlayerRow::getExperience() const { return _table->column(PlayerTable::EXPERIENCE)[_row]; }
+int PlayerRow::getAccuracy() const { return _table->column(PlayerTable::ACCURACY)[_row]; }
+int PlayerRow::getEfficiency() const { return _table->column(PlayerTable::EFFICIENCY)[_row]; }
+int PlayerRow::getInsight() const { return _table->column(PlayerTable::INSIGHT)[_row]; }
+int PlayerRow::getDiscoverPoints() const { return _table->column(PlayerTable::DISCOVER_POINTS)[_row]; }
+int PlayerRow::getPathType() const { return _table->column(PlayerTable::PATH_TYPE)[_row]; }
+int PlayerRow::getAdvisor() const { return _table->column(PlayerTable::ADVISOR)[_row]; }
+bool PlayerRow::getFinished() const { return _table->column(PlayerTable::FINISHED)[_row] != 0; }
+
+void PlayerRow::setExperience(int experience) { _table->column(PlayerTable::EXPERIENCE)[_row] = experience; }
+void PlayerRow::setAccuracy(int accuracy) { _table->column(PlayerTable::ACCURACY)[_row] = accuracy; }
+void PlayerRow::setEfficiency(int efficiency) { _table->column(PlayerTable::EFFICIENCY)[_row] = efficiency; }
+void PlayerRow::setInsight(int insight) { _table->column(PlayerTable::INSIGHT)[_row] = insight; }
+void PlayerRow::setDiscoverPoints(int discoverPoints) { _table->column(PlayerTable::DISCOVER_POINTS)[_row] = discoverPoints; }
+void PlayerRow::setPathType(int pathType) { _table->column(PlayerTable::PATH_TYPE)[_row] = pathType; }
+void PlayerRow::setAdvisor(int advisor) { _table->column(PlayerTable::ADVISOR)[_row] = advisor; }
+void PlayerRow::setFinished(bool finished) { _table->column(PlayerTable::FINISHED)[_row] = finished ? 1 : 0; }
+
+void PlayerRow::changeExperience(int delta) { _table->column(PlayerTable::EXPERIENCE)[_row] += delta; }
+void PlayerRow::changeAccuracy(int delta) { _table->column(PlayerTable::ACCURACY)[_row] += delta; }
+void PlayerRow::changeEfficiency(int delta) { _table->column(PlayerTable::EFFICIENCY)[_row] += delta; }
+void PlayerRow::changeInsight(int delta) { _table->column(PlayerTable::INSIGHT)[_row] += delta; }
+void PlayerRow::changeDiscoverPoints(int delta) { _table->column(PlayerTable::DISCOVER_POINTS)[_row] += delta; }
+
+// ---------- PlayerTable ----------
+
+PlayerTable::PlayerTable() {
+    for (int c = 0; c < COLUMN_COUNT; c++) {
+        _columns[c] = nullptr;
+    }
+    _rows = 0;
+    _capacity = 0;
+}
+
+PlayerTable::~PlayerTable() {
+    for (int c = 0; c < COLUMN_COUNT; c++) {
+        ::operator delete[](_columns[c], align_val_t(32));
+    }
+}
+
+void PlayerTable::resize(int rows) {
+    if (rows < 0) {
+        rows = 0;
+    }
+    if (rows > _capacity) {
+        // Round up to whole groups of 8, so the AVX2 loops never need a tail
+        int capacity = (rows + 7) & ~7;
+        for (int c = 0; c < COLUMN_COUNT; c++) {
+            int* column = (int*)::operator new[](capacity * sizeof(int), align_val_t(32));
+            memset(column, 0, capacity * sizeof(int));
+            if (_columns[c] != nullptr) {
+                memcpy(column, _columns[c], _rows * sizeof(int));
+                ::operator delete[](_columns[c], align_val_t(32));
+            }
+            _columns[c] = column;
+        }
+        _capacity = capacity;
+    } else {
+        // Shrinking (or growing inside the capacity): clear the rows that leave
+        for (int c = 0; c < COLUMN_COUNT; c++) {
+            if (rows < _rows) {
+                memset(_columns[c] + rows, 0, (_rows - rows) * sizeof(int));
+            }
+        }
+    }
+    _rows = rows;
+}
+
+int PlayerTable::size() const {
+    return _rows;
+}
+
+void PlayerTable::setNames(const vector<string>& names) {
+    _names = names;
+}
+
+const string& PlayerTable::getName(int nameId) const {
+    static const string noName = "";
+    if (nameId < 0 || nameId >= (int)_names.size()) {
+        return noName;
+    }
+    return _names[nameId];
+}
+
+void PlayerTable::setRow(int row, const Player& p, int nameId) {
+    _columns[EXPERIENCE][row] = p.getExperience();
+    _columns[ACCURACY][row] = p.getAccuracy();
+    _columns[EFFICIENCY][row] = p.getEfficiency();
+    _columns[INSIGHT][row] = p.getInsight();
+    _columns[DISCOVER_POINTS][row] = p.getDiscoverPoints();
+    _columns[PATH_TYPE][row] = p.getPathType();
+    _columns[ADVISOR][row] = p.getAdvisor();
+    _columns[FINISHED][row] = p.getFinished() ? 1 : 0;
+    _columns[NAME_ID][row] = nameId;
+}
+
+Player PlayerTable::getPlayer(int row) const {
+    Player p(getName(_columns[NAME_ID][row]), _columns[EXPERIENCE][row], _columns[ACCURACY][row],
+             _columns[EFFICIENCY][row], _columns[INSIGHT][row], _columns[DISCOVER_POINTS][row],
+             _columns[PATH_TYPE][row]);
+    p.setAdvisor(_columns[ADVISOR][row]);
+    p.setFinished(_columns[FINISHED][row] != 0);
+    return p;
+}
+
+PlayerRow PlayerTable::operator[](int row) {
+    return PlayerRow(this, row);
+}
+
+int* PlayerTable::column(Column c) {
+    return _columns[c];
+}
+
+const int* PlayerTable::column(Column c) const {
+    return _columns[c];
+}
+
+void PlayerTable::applyPathBonuses(const GameRules& rules) {
+    const int* path = _columns[PATH_TYPE];
+    int* dp = _columns[DISCOVER_POINTS];
+    int* accuracy = _columns[ACCURACY];
+    int* efficiency = _columns[EFFICIENCY];
+    int* insight = _columns[INSIGHT];
+
+    // Written as selects with no branches, so the compiler can vectorize it
+    for (int i = 0; i < _rows; i++) {
+        bool fellowship = (path[i] == 0);
+        dp[i] += fellowship ? rules.fellowshipDP : rules.directLabDP;
+        accuracy[i] += fellowship ? rules.fellowshipAccuracy : rules.directLabAccuracy;
+        efficiency[i] += fellowship ? rules.fellowshipEfficiency : rules.directLabEfficiency;
+        insight[i] += fellowship ? rules.fellowshipInsight : rules.directLabInsight;
+    }
+}
+
+void PlayerTable::applyTileEffects(const char colors[], const GameRules& rules) {
+    int* accuracy = _columns[ACCURACY];
+    int* efficiency = _columns[EFFICIENCY];
+    int* insight = _columns[INSIGHT];
+    int i = 0;
+
+#if defined(__AVX2__)
+    // 8 rows at a time: widen 8 colors to ints, compare with each tile color,
+    // and add the reward only in the lanes that match (the mask is all ones there)
+    const __m256i blue = _mm256_set1_epi32('B');
+    const __m256i pink = _mm256_set1_epi32('P');
+    const __m256i red = _mm256_set1_epi32('R');
+    const __m256i brown = _mm256_set1_epi32('T');
+    const __m256i blueAccuracy = _mm256_set1_epi32(rules.blueMaxAccuracy);
+    const __m256i pinkEfficiency = _mm256_set1_epi32(rules.pinkEfficiency);
+    const __m256i redInsight = _mm256_set1_epi32(rules.redInsight);
+    const __m256i brownAccuracy = _mm256_set1_epi32(rules.brownAccuracy);
+    const __m256i brownEfficiency = _mm256_set1_epi32(rules.brownEfficiency);
+
+    for (; i + 8 <= _rows; i += 8) {
+        __m256i color = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(colors + i)));
+        __m256i isBlue = _mm256_cmpeq_epi32(color, blue);
+        __m256i isPink = _mm256_cmpeq_epi32(color, pink);
+        __m256i isRed = _mm256_cmpeq_epi32(color, red);
+        __m256i isBrown = _mm256_cmpeq_epi32(color, brown);
+
+        __m256i acc = _mm256_load_si256((const __m256i*)(accuracy + i));
+        acc = _mm256_add_epi32(acc, _mm256_and_si256(isBlue, blueAccuracy));
+        acc = _mm256_add_epi32(acc, _mm256_and_si256(isBrown, brownAccuracy));
+        _mm256_store_si256((__m256i*)(accuracy + i), acc);
+
+        __m256i eff = _mm256_load_si256((const __m256i*)(efficiency + i));
+        eff = _mm256_add_epi32(eff, _mm256_and_si256(isPink, pinkEfficiency));
+        eff = _mm256_add_epi32(eff, _mm256_and_si256(isBrown, brownEfficiency));
+        _mm256_store_si256((__m256i*)(efficiency + i), eff);
+
+        __m256i ins = _mm256_load_si256((const __m256i*)(insight + i));
+        ins = _mm256_add_epi32(ins, _mm256_and_si256(isRed, redInsight));
+        _mm256_store_si256((__m256i*)(insight + i), ins);
+    }
+#endif
+
+    // Rows left over (or every row without AVX2)
+    for (; i < _rows; i++) {
+        char c = colors[i];
+        accuracy[i] += (c == 'B') ? rules.blueMaxAccuracy : 0;
+        accuracy[i] += (c == 'T') ? rules.brownAccuracy : 0;
+        efficiency[i] += (c == 'P') ? rules.pinkEfficiency : 0;
+        efficiency[i] += (c == 'T') ? rules.brownEfficiency : 0;
+        insight[i] += (c == 'R') ? rules.redInsight : 0;
+    }
+}
+
+#if defined(__AVX2__)
+// x / 100 for signed ints, rounded toward zero like C++ division
+// There is no vector divide, so multiply by 2^37 / 100 (rounded up) and keep the
+// top bits: (x * 0x51EB851F) >> 37, plus 1 for negative x
+static inline __m256i divideBy100(__m256i x) {
+    const __m256i magic = _mm256_set1_epi32(0x51EB851F);
+    // _mm256_mul_epi32 only multiplies the even lanes, so do the odd lanes separately
+    __m256i even = _mm256_mul_epi32(x, magic);
+    __m256i odd = _mm256_mul_epi32(_mm256_srli_epi64(x, 32), magic);
+    // High 32 bits of each product back into its own lane
+    __m256i high = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+    __m256i q = _mm256_srai_epi32(high, 5);
+    return _mm256_sub_epi32(q, _mm256_srai_epi32(x, 31));
+}
+#endif
+
+void PlayerTable::calculateFinalScores(int scores[]) const {
+    const int* dp = _columns[DISCOVER_POINTS];
+    const int* accuracy = _columns[ACCURACY];
+    const int* efficiency = _columns[EFFICIENCY];
+    const int* insight = _columns[INSIGHT];
+    int i = 0;
+
+#if defined(__AVX2__)
+    const __m256i thousand = _mm256_set1_epi32(1000);
+    for (; i + 8 <= _rows; i += 8) {
+        __m256i sets = divideBy100(_mm256_load_si256((const __m256i*)(accuracy + i)));
+        sets = _mm256_add_epi32(sets, divideBy100(_mm256_load_si256((const __m256i*)(efficiency + i))));
+        sets = _mm256_add_epi32(sets, divideBy100(_mm256_load_si256((const __m256i*)(insight + i))));
+        __m256i total = _mm256_add_epi32(_mm256_load_si256((const __m256i*)(dp + i)),
+                                         _mm256_mullo_epi32(sets, thousand));
+        _mm256_storeu_si256((__m256i*)(scores + i), total);
+    }
+#endif
+
+    for (; i < _rows; i++) {
+        scores[i] = dp[i] + (accuracy[i] / 100) * 1000 + (efficiency[i] / 100) * 1000 +
+                    (insight[i] / 100) * 1000;
+    }
+}
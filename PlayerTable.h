@@ -0,0 +1,108 @@
+#ifndef PLAYERTABLE_H
+#define PLAYERTABLE_H
+
+#include "Player.h"
+#include "Rules.h"
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Many players stored column by column (struct of arrays) for batch simulation
+// Each stat is one contiguous int array, 32-byte aligned, so a whole column can
+// be updated 8 rows at a time with AVX2 (or a plain loop without it).
+// Names are stored as indexes into a shared name list, like PlayerState.
+
+class PlayerTable;
+
+// One row of a PlayerTable, with the same getters and setters as Player
+class PlayerRow {
+private:
+    PlayerTable* _table;
+    int _row;
+
+public:
+    PlayerRow(PlayerTable* table, int row);
+
+    string getName() const;
+    int getExperience() const;
+    int getAccuracy() const;
+    int getEfficiency() const;
+    int getInsight() const;
+    int getDiscoverPoints() const;
+    int getPathType() const;
+    int getAdvisor() const;
+    bool getFinished() const;
+
+    void setExperience(int experience);
+    void setAccuracy(int accuracy);
+    void setEfficiency(int efficiency);
+    void setInsight(int insight);
+    void setDiscoverPoints(int discoverPoints);
+    void setPathType(int pathType);
+    void setAdvisor(int advisor);
+    void setFinished(bool finished);
+
+    void changeExperience(int delta);
+    void changeAccuracy(int delta);
+    void changeEfficiency(int delta);
+    void changeInsight(int delta);
+    void changeDiscoverPoints(int delta);
+};
+
+class PlayerTable {
+public:
+    enum Column {
+        EXPERIENCE,
+        ACCURACY,
+        EFFICIENCY,
+        INSIGHT,
+        DISCOVER_POINTS,
+        PATH_TYPE,
+        ADVISOR,
+        FINISHED,
+        NAME_ID,
+        COLUMN_COUNT
+    };
+
+    PlayerTable();
+    ~PlayerTable();
+
+    // Columns are raw arrays, so the table is not copied by accident
+    PlayerTable(const PlayerTable&) = delete;
+    PlayerTable& operator=(const PlayerTable&) = delete;
+
+    // Changes the number of rows; existing rows are kept, new rows are zero
+    void resize(int rows);
+    int size() const;
+
+    // Names used by getName (rows store an index into this list, -1 = no name)
+    void setNames(const vector<string>& names);
+    const string& getName(int nameId) const;
+
+    // Copies a Player into a row, or a row back out into a Player
+    void setRow(int row, const Player& p, int nameId);
+    Player getPlayer(int row) const;
+    PlayerRow operator[](int row);
+
+    int* column(Column c);
+    const int* column(Column c) const;
+
+    // Batch operations over every row
+    // Path bonuses by each row's path type (same as Game::applyPathBonuses)
+    void applyPathBonuses(const GameRules& rules);
+    // DNA task rewards for one tile per row, played perfectly (like the AI does);
+    // colors[row] is the tile color, and rows on other colors are not changed
+    void applyTileEffects(const char colors[], const GameRules& rules);
+    // Final score of every row (same as Game::calculateFinalScore)
+    void calculateFinalScores(int scores[]) const;
+
+private:
+    int* _columns[COLUMN_COUNT];
+    int _rows;
+    int _capacity;   // rows allocated, always a multiple of 8
+    vector<string> _names;
+};
+
+#endif
@@ -0,0 +1,28 @@
+// Recognized as "include guards"
+#ifndef RANDOM_H
+#define RANDOM_H
+
+// SplitMix64 helpers
+// A counter-based generator: the output only depends on the input counter,
+// so any value can be computed directly without stepping through the ones before it
+
+// Scrambles a 64-bit counter into a well mixed 64-bit value
+inline unsigned long long splitMix64(unsigned long long x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// Combines a key with one more counter value (used for seed + lane + position)
+inline unsigned long long mixKey(unsigned long long key, unsigned long long value) {
+    return splitMix64(key ^ splitMix64(value));
+}
+
+// Sequential use: advance the state and return the next random value
+inline unsigned long long nextRandom(unsigned long long& state) {
+    state += 0x9E3779B97F4A7C15ULL;
+    return splitMix64(state);
+}
+
+#endif
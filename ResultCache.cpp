@@ -0,0 +1,437 @@
+#include "ResultCache.h"
+#include "DNAUtils.h"
+#include "Random.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// =========================== Hashing ===========================
+
+// 64 x 64 -> 128-bit multiply, folded back to 64 bits. One multiply mixes
+// every input bit into the middle of the product
+static inline unsigned long long foldMultiply(unsigned long long a, unsigned long long b) {
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 product = (unsigned __int128)a * b;
+    return (unsigned long long)product ^ (unsigned long long)(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long long high;
+    unsigned long long low = _umul128(a, b, &high);
+    return low ^ high;
+#else
+    // No 128-bit multiply: build it from four 32 x 32 -> 64-bit ones
+    unsigned long long aLow = a & 0xffffffffULL;
+    unsigned long long aHigh = a >> 32;
+    unsigned long long bLow = b & 0xffffffffULL;
+    unsigned long long bHigh = b >> 32;
+    unsigned long long lowLow = aLow * bLow;
+    unsigned long long lowHigh = aLow * bHigh;
+    unsigned long long highLow = aHigh * bLow;
+    unsigned long long highHigh = aHigh * bHigh;
+    unsigned long long middle = (lowLow >> 32) + (lowHigh & 0xffffffffULL) + (highLow & 0xffffffffULL);
+    unsigned long long low = (middle << 32) | (lowLow & 0xffffffffULL);
+    unsigned long long high = highHigh + (lowHigh >> 32) + (highLow >> 32) + (middle >> 32);
+    return low ^ high;
+#endif
+}
+
+static const unsigned long long HASH_KEYS[4] = {
+    0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL, 0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL};
+
+// Mixes 'bytes' into the two 64-bit halves (a, b) of the running hash.
+// Each multiply has to wait for the one before it in the same chain, so long
+// inputs use four chains side by side (64 bytes per step) and fold them into
+// a and b afterwards; the last 0 to 63 bytes go 16 at a time
+static void hashBytes(string_view bytes, unsigned long long& a, unsigned long long& b) {
+    const char* p = bytes.data();
+    size_t n = bytes.size();
+    a ^= foldMultiply(n ^ HASH_KEYS[0], HASH_KEYS[1]);
+    if (n >= 64) {
+        unsigned long long lanes[4] = {a, b, a ^ HASH_KEYS[2], b ^ HASH_KEYS[3]};
+        for (; n >= 64; p += 64, n -= 64) {
+            for (int j = 0; j < 4; j++) {
+                unsigned long long w0;
+                unsigned long long w1;
+                memcpy(&w0, p + 16 * j, 8);
+                memcpy(&w1, p + 16 * j + 8, 8);
+                lanes[j] = foldMultiply(w0 ^ lanes[j] ^ HASH_KEYS[j], w1 ^ HASH_KEYS[(j + 1) & 3]);
+            }
+        }
+        a = foldMultiply(lanes[0] ^ HASH_KEYS[0], lanes[1] ^ HASH_KEYS[1]);
+        b = foldMultiply(lanes[2] ^ HASH_KEYS[2], lanes[3] ^ HASH_KEYS[3]);
+    }
+    for (; n >= 16; p += 16, n -= 16) {
+        unsigned long long w0;
+        unsigned long long w1;
+        memcpy(&w0, p, 8);
+        memcpy(&w1, p + 8, 8);
+        a = foldMultiply(w0 ^ a ^ HASH_KEYS[0], w1 ^ HASH_KEYS[1]);
+        b = foldMultiply(w1 ^ b ^ HASH_KEYS[2], w0 ^ HASH_KEYS[3]);
+    }
+    // Last 0 to 15 bytes, zero padded (the length was mixed in above)
+    unsigned long long tail[2] = {0, 0};
+    memcpy(tail, p, n);
+    a = foldMultiply(tail[0] ^ a ^ HASH_KEYS[0], tail[1] ^ HASH_KEYS[1]);
+    b = foldMultiply(tail[1] ^ b ^ HASH_KEYS[2], tail[0] ^ HASH_KEYS[3]);
+}
+
+Hash128 hashQuery(int task, string_view strand1, string_view strand2) {
+    unsigned long long a = splitMix64(task);
+    unsigned long long b = splitMix64(a);
+    hashBytes(strand1, a, b);
+    hashBytes(strand2, a, b);
+    Hash128 hash;
+    hash.low = splitMix64(a ^ (b >> 17));
+    hash.high = splitMix64(b ^ hash.low);
+    return hash;
+}
+
+// =========================== Disk layout ===========================
+
+// Layout (native byte order, shared by every process that opens the file):
+//   64-byte header, then slotCount slots of 256 bytes.
+//   Slots are used in buckets of 4: the key picks the bucket, a result goes
+//   into its own key's slot, an empty one, or replaces one picked by the key.
+
+const unsigned int CACHE_FILE_MAGIC = 0x31435247;   // "GRC1"
+const int CACHE_SLOT_OUTPUT = 224;
+const int CACHE_BUCKET = 4;
+
+struct CacheFileHeader {
+    unsigned int magic;
+    unsigned int slotSize;
+    unsigned long long slotCount;
+    char unused[48];
+};
+
+struct CacheSlot {
+    atomic<unsigned int> sequence;   // 0 = empty, odd = being written
+    unsigned int outputLength;
+    unsigned long long keyLow;
+    unsigned long long keyHigh;
+    double value;
+    char output[CACHE_SLOT_OUTPUT];
+};
+
+static_assert(sizeof(CacheFileHeader) == 64, "CacheFileHeader must be 64 bytes");
+static_assert(sizeof(CacheSlot) == 256, "CacheSlot must be 256 bytes");
+static_assert(atomic<unsigned int>::is_always_lock_free,
+              "the slot sequence must be lock-free to work across processes");
+
+static CacheSlot* slotsOf(CacheFileHeader* header) {
+    return (CacheSlot*)(header + 1);
+}
+
+// =========================== ResultCache ===========================
+
+ResultCache::ResultCache(size_t memoryBytes) {
+    _shardBytes = memoryBytes / RESULT_CACHE_SHARDS;
+    for (int s = 0; s < RESULT_CACHE_SHARDS; s++) {
+        _shards[s].bytes = 0;
+        _shards[s].memoryHits = 0;
+        _shards[s].diskHits = 0;
+        _shards[s].misses = 0;
+    }
+    _file = nullptr;
+    _fileBytes = 0;
+    _slotCount = 0;
+}
+
+ResultCache::~ResultCache() {
+    closeFile();
+}
+
+ResultCache::Shard& ResultCache::shardFor(const Hash128& key) {
+    // The low bits pick the slot in the unordered_map, so use high bits here
+    return _shards[key.high >> 60];
+}
+
+bool ResultCache::lookup(const Hash128& key, CachedResult& result) {
+    Shard& shard = shardFor(key);
+    {
+        lock_guard<mutex> guard(shard.lock);
+        auto found = shard.index.find(key);
+        if (found != shard.index.end()) {
+            // Move to the front: splice only relinks the node
+            shard.order.splice(shard.order.begin(), shard.order, found->second);
+            result = found->second->result;
+            shard.memoryHits.fetch_add(1, memory_order_relaxed);
+            return true;
+        }
+    }
+    if (_file != nullptr && lookupDisk(key, result)) {
+        storeInMemory(shard, key, result);
+        shard.diskHits.fetch_add(1, memory_order_relaxed);
+        return true;
+    }
+    shard.misses.fetch_add(1, memory_order_relaxed);
+    return false;
+}
+
+void ResultCache::store(const Hash128& key, const CachedResult& result) {
+    storeInMemory(shardFor(key), key, result);
+    if (_file != nullptr) {
+        storeOnDisk(key, result);
+    }
+}
+
+void ResultCache::storeInMemory(Shard& shard, const Hash128& key, const CachedResult& result) {
+    // Rough size of an entry: the text plus list and map nodes
+    size_t size = result.output.size() + 128;
+    if (size > _shardBytes) {
+        return;
+    }
+    lock_guard<mutex> guard(shard.lock);
+    if (shard.index.count(key) > 0) {
+        return;
+    }
+    while (shard.bytes + size > _shardBytes && !shard.order.empty()) {
+        Entry& oldest = shard.order.back();
+        shard.bytes -= oldest.result.output.size() + 128;
+        shard.index.erase(oldest.key);
+        shard.order.pop_back();
+    }
+    shard.order.push_front({key, result});
+    shard.index[key] = shard.order.begin();
+    shard.bytes += size;
+}
+
+ResultCacheCounters ResultCache::getCounters() {
+    ResultCacheCounters counters = {0, 0, 0, 0};
+    for (int s = 0; s < RESULT_CACHE_SHARDS; s++) {
+        counters.memoryHits += _shards[s].memoryHits.load(memory_order_relaxed);
+        counters.diskHits += _shards[s].diskHits.load(memory_order_relaxed);
+        counters.misses += _shards[s].misses.load(memory_order_relaxed);
+        lock_guard<mutex> guard(_shards[s].lock);
+        counters.entries += _shards[s].order.size();
+    }
+    return counters;
+}
+
+#ifdef _WIN32
+
+// No shared memory-mapped files on Windows: memory tier only
+bool ResultCache::openFile(const char /*filename*/[], unsigned long long /*slots*/) {
+    return false;
+}
+
+void ResultCache::closeFile() {
+}
+
+bool ResultCache::lookupDisk(const Hash128& /*key*/, CachedResult& /*result*/) const {
+    return false;
+}
+
+void ResultCache::storeOnDisk(const Hash128& /*key*/, const CachedResult& /*result*/) {
+}
+
+#else
+
+bool ResultCache::openFile(const char filename[], unsigned long long slots) {
+    closeFile();
+    int fd = open(filename, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return false;
+    }
+    // New file: size it (the zero bytes are empty slots). Two processes creating
+    // it at once both set the same size, and the header is written the same too
+    slots = max((slots + CACHE_BUCKET - 1) / CACHE_BUCKET * CACHE_BUCKET, (unsigned long long)CACHE_BUCKET);
+    size_t bytes = info.st_size;
+    if (bytes == 0) {
+        bytes = sizeof(CacheFileHeader) + slots * sizeof(CacheSlot);
+        if (ftruncate(fd, bytes) != 0) {
+            close(fd);
+            return false;
+        }
+    }
+    if (bytes < sizeof(CacheFileHeader) + CACHE_BUCKET * sizeof(CacheSlot)) {
+        close(fd);
+        return false;
+    }
+    void* map = mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+
+    CacheFileHeader* header = (CacheFileHeader*)map;
+    if (header->magic == 0) {
+        header->slotSize = sizeof(CacheSlot);
+        header->slotCount = (bytes - sizeof(CacheFileHeader)) / sizeof(CacheSlot);
+        header->magic = CACHE_FILE_MAGIC;
+    }
+    // Reject other files and other layouts
+    if (header->magic != CACHE_FILE_MAGIC || header->slotSize != sizeof(CacheSlot) ||
+        header->slotCount % CACHE_BUCKET != 0 ||
+        sizeof(CacheFileHeader) + header->slotCount * sizeof(CacheSlot) > bytes) {
+        munmap(map, bytes);
+        return false;
+    }
+    _file = header;
+    _fileBytes = bytes;
+    _slotCount = header->slotCount;
+    return true;
+}
+
+void ResultCache::closeFile() {
+    if (_file == nullptr) {
+        return;
+    }
+    munmap(_file, _fileBytes);
+    _file = nullptr;
+    _fileBytes = 0;
+    _slotCount = 0;
+}
+
+bool ResultCache::lookupDisk(const Hash128& key, CachedResult& result) const {
+    CacheSlot* bucket = slotsOf(_file) + (key.low % (_slotCount / CACHE_BUCKET)) * CACHE_BUCKET;
+    for (int i = 0; i < CACHE_BUCKET; i++) {
+        CacheSlot& slot = bucket[i];
+        unsigned int before = slot.sequence.load(memory_order_acquire);
+        if (before == 0 || (before & 1) != 0) {
+            continue;
+        }
+        if (slot.keyLow != key.low || slot.keyHigh != key.high) {
+            continue;
+        }
+        double value = slot.value;
+        unsigned int length = min(slot.outputLength, (unsigned int)CACHE_SLOT_OUTPUT);
+        char output[CACHE_SLOT_OUTPUT];
+        memcpy(output, slot.output, length);
+        // Everything read above must come before the second look at the sequence
+        atomic_thread_fence(memory_order_acquire);
+        if (slot.sequence.load(memory_order_relaxed) != before ||
+            slot.keyLow != key.low || slot.keyHigh != key.high) {
+            // Overwritten while we read it: treat as a miss
+            return false;
+        }
+        result.value = value;
+        result.output.assign(output, length);
+        return true;
+    }
+    return false;
+}
+
+void ResultCache::storeOnDisk(const Hash128& key, const CachedResult& result) {
+    if (result.output.size() > CACHE_SLOT_OUTPUT) {
+        return;
+    }
+    CacheSlot* bucket = slotsOf(_file) + (key.low % (_slotCount / CACHE_BUCKET)) * CACHE_BUCKET;
+    // Same key (another process got there first), else an empty slot, else a victim
+    int chosen = -1;
+    for (int i = 0; i < CACHE_BUCKET && chosen < 0; i++) {
+        if (bucket[i].keyLow == key.low && bucket[i].keyHigh == key.high) {
+            return;
+        }
+        if (bucket[i].sequence.load(memory_order_relaxed) == 0) {
+            chosen = i;
+        }
+    }
+    if (chosen < 0) {
+        chosen = key.high % CACHE_BUCKET;
+    }
+
+    CacheSlot& slot = bucket[chosen];
+    // Claim the slot by making the sequence odd; if another writer holds it, skip
+    unsigned int sequence = slot.sequence.load(memory_order_relaxed);
+    if ((sequence & 1) != 0 ||
+        !slot.sequence.compare_exchange_strong(sequence, sequence + 1, memory_order_relaxed)) {
+        return;
+    }
+    // The odd number must be visible before any of the new bytes
+    atomic_thread_fence(memory_order_release);
+    slot.keyLow = key.low;
+    slot.keyHigh = key.high;
+    slot.value = result.value;
+    slot.outputLength = result.output.size();
+    memcpy(slot.output, result.output.data(), result.output.size());
+    slot.sequence.store(sequence + 2, memory_order_release);
+}
+
+#endif
+
+// =========================== Cached DNA tasks ===========================
+
+// Where lookups copy a hit. Kept per thread so its string keeps its capacity
+// and a hit does not allocate
+static CachedResult& hitBuffer() {
+    static thread_local CachedResult result;
+    return result;
+}
+
+double cachedStrandSimilarity(ResultCache* cache, string_view strand1, string_view strand2,
+                              ostream& out, bool allowIndels) {
+    if (cache == nullptr) {
+        return strandSimilarity(strand1, strand2, out, allowIndels);
+    }
+    Hash128 key = hashQuery(allowIndels ? CACHE_SIMILARITY_INDELS : CACHE_SIMILARITY, strand1, strand2);
+    CachedResult& result = hitBuffer();
+    if (!cache->lookup(key, result)) {
+        ostringstream text;
+        result.value = strandSimilarity(strand1, strand2, text, allowIndels);
+        result.output = text.str();
+        cache->store(key, result);
+    }
+    out << result.output;
+    return result.value;
+}
+
+int cachedBestStrandMatch(ResultCache* cache, string_view input_strand,
+                          string_view target_strand, ostream& out) {
+    if (cache == nullptr) {
+        return bestStrandMatch(input_strand, target_strand, out);
+    }
+    Hash128 key = hashQuery(CACHE_BEST_MATCH, input_strand, target_strand);
+    CachedResult& result = hitBuffer();
+    if (!cache->lookup(key, result)) {
+        ostringstream text;
+        result.value = bestStrandMatch(input_strand, target_strand, text);
+        result.output = text.str();
+        cache->store(key, result);
+    }
+    out << result.output;
+    return (int)result.value;
+}
+
+void cachedIdentifyMutations(ResultCache* cache, string_view input_strand,
+                             string_view target_strand, ostream& out) {
+    if (cache == nullptr) {
+        identifyMutations(input_strand, target_strand, out);
+        return;
+    }
+    Hash128 key = hashQuery(CACHE_MUTATIONS, input_strand, target_strand);
+    CachedResult& result = hitBuffer();
+    if (!cache->lookup(key, result)) {
+        ostringstream text;
+        identifyMutations(input_strand, target_strand, text);
+        result.value = 0;
+        result.output = text.str();
+        cache->store(key, result);
+    }
+    out << result.output;
+}
+
+void printCacheCounters(ResultCache& cache, ostream& out) {
+    ResultCacheCounters counters = cache.getCounters();
+    out << "Result cache: " << counters.memoryHits << " memory hits, " << counters.diskHits
+        << " disk hits, " << counters.misses << " misses, " << counters.entries << " results held"
+        << endl;
+}
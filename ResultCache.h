@@ -0,0 +1,135 @@
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include <atomic>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+using namespace std;
+
+// Remembers the results of the DNA tasks so repeated questions are answered
+// without running them again
+//
+// The key is a 128-bit hash of the task and both strands (collisions are not
+// a practical worry at 128 bits, so the strands themselves are not stored).
+// A result is the returned value plus everything the task printed, so a hit
+// prints exactly what the task would have printed.
+//
+// Two tiers:
+//  - Memory: a least-recently-used list split into 16 shards, each with its
+//    own lock. The hash picks the shard, so threads (server workers) rarely
+//    wait for each other. Holds up to 'memoryBytes' of results.
+//  - Disk (optional): a memory-mapped file of fixed 256-byte slots that any
+//    number of processes can share. Each slot has a seqlock like the
+//    spectator feed (see SpectatorFeed.h): writers make the sequence odd,
+//    fill the slot and make it even again; readers keep a copy only if the
+//    sequence did not change. Results printing more than fits in a slot
+//    stay in memory only. Linux/macOS only.
+//
+// A hit costs one hash of the strands and one short lock, well under a
+// microsecond for strands of a few hundred bases.
+
+struct Hash128 {
+    unsigned long long low;
+    unsigned long long high;
+
+    bool operator==(const Hash128& other) const {
+        return low == other.low && high == other.high;
+    }
+};
+
+// Task numbers used in the key
+const int CACHE_SIMILARITY = 1;
+const int CACHE_BEST_MATCH = 2;
+const int CACHE_MUTATIONS = 3;
+const int CACHE_SIMILARITY_INDELS = 4;   // strandSimilarity with allowIndels
+
+// Hash of (task, strand1, strand2); several bytes per cycle
+Hash128 hashQuery(int task, string_view strand1, string_view strand2);
+
+struct CachedResult {
+    double value;    // the returned number (unused for identifyMutations)
+    string output;   // everything the task printed
+};
+
+struct ResultCacheCounters {
+    long long memoryHits;
+    long long diskHits;
+    long long misses;
+    long long entries;   // results held in memory
+};
+
+// Layout of the disk file (see ResultCache.cpp)
+struct CacheFileHeader;
+struct CacheSlot;
+
+const int RESULT_CACHE_SHARDS = 16;
+
+class ResultCache {
+private:
+    struct Entry {
+        Hash128 key;
+        CachedResult result;
+    };
+    struct HashOfHash {
+        size_t operator()(const Hash128& key) const {
+            return key.low;
+        }
+    };
+    // Most recently used at the front of 'order'
+    struct alignas(64) Shard {
+        mutex lock;
+        list<Entry> order;
+        unordered_map<Hash128, list<Entry>::iterator, HashOfHash> index;
+        size_t bytes;
+        atomic<long long> memoryHits;
+        atomic<long long> diskHits;
+        atomic<long long> misses;
+    };
+
+    Shard _shards[RESULT_CACHE_SHARDS];
+    size_t _shardBytes;   // memory budget of one shard
+
+    // Disk tier (nullptr = memory only)
+    CacheFileHeader* _file;
+    size_t _fileBytes;
+    unsigned long long _slotCount;
+
+    Shard& shardFor(const Hash128& key);
+    void storeInMemory(Shard& shard, const Hash128& key, const CachedResult& result);
+    bool lookupDisk(const Hash128& key, CachedResult& result) const;
+    void storeOnDisk(const Hash128& key, const CachedResult& result);
+
+public:
+    explicit ResultCache(size_t memoryBytes = 64 << 20);
+    ~ResultCache();
+
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    // Opens (or creates with room for 'slots' results) a shared disk tier
+    bool openFile(const char filename[], unsigned long long slots = 1 << 18);
+    void closeFile();
+
+    bool lookup(const Hash128& key, CachedResult& result);
+    void store(const Hash128& key, const CachedResult& result);
+
+    ResultCacheCounters getCounters();
+};
+
+// The DNA tasks of DNAUtils.h through a cache (nullptr = no cache, run the task)
+double cachedStrandSimilarity(ResultCache* cache, string_view strand1, string_view strand2,
+                              ostream& out, bool allowIndels = false);
+int cachedBestStrandMatch(ResultCache* cache, string_view input_strand,
+                          string_view target_strand, ostream& out);
+void cachedIdentifyMutations(ResultCache* cache, string_view input_strand,
+                             string_view target_strand, ostream& out);
+
+// Prints the hit/miss counters on one line
+void printCacheCounters(ResultCache& cache, ostream& out);
+
+#endif
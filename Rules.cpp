@@ -0,0 +1,84 @@
+#include "Rules.h"
+#include "DataLoader.h"
+
+#include <fstream>
+#include <string>
+
+using namespace std;
+
+const RuleField RULE_FIELDS[RULE_FIELD_COUNT] = {
+    {"fellowshipDP", &GameRules::fellowshipDP},
+    {"fellowshipAccuracy", &GameRules::fellowshipAccuracy},
+    {"fellowshipEfficiency", &GameRules::fellowshipEfficiency},
+    {"fellowshipInsight", &GameRules::fellowshipInsight},
+    {"directLabDP", &GameRules::directLabDP},
+    {"directLabAccuracy", &GameRules::directLabAccuracy},
+    {"directLabEfficiency", &GameRules::directLabEfficiency},
+    {"directLabInsight", &GameRules::directLabInsight},
+    {"blueMaxAccuracy", &GameRules::blueMaxAccuracy},
+    {"pinkEfficiency", &GameRules::pinkEfficiency},
+    {"redInsight", &GameRules::redInsight},
+    {"brownAccuracy", &GameRules::brownAccuracy},
+    {"brownEfficiency", &GameRules::brownEfficiency},
+    {"riddleInsight", &GameRules::riddleInsight},
+};
+
+GameRules defaultGameRules() {
+    GameRules rules;
+
+    rules.fellowshipDP = -5000;
+    rules.fellowshipAccuracy = 500;
+    rules.fellowshipEfficiency = 500;
+    rules.fellowshipInsight = 1000;
+
+    rules.directLabDP = 5000;
+    rules.directLabAccuracy = 200;
+    rules.directLabEfficiency = 200;
+    rules.directLabInsight = 200;
+
+    rules.blueMaxAccuracy = 200;
+    rules.pinkEfficiency = 150;
+    rules.redInsight = 150;
+    rules.brownAccuracy = 50;
+    rules.brownEfficiency = 50;
+    rules.riddleInsight = 500;
+
+    return rules;
+}
+
+bool loadGameRules(const char filename[], GameRules& rules) {
+    DataFile file;
+    if (!file.open(filename)) {
+        return false;
+    }
+
+    string_view line;
+    while (file.nextLine(line)) {
+        string_view fields[2];
+        if (line.empty() || line[0] == '/' || splitFields(line, fields, 2) != 2) {
+            continue;
+        }
+
+        int value;
+        if (!parseIntField(fields[1], value)) {
+            continue;
+        }
+        for (int i = 0; i < RULE_FIELD_COUNT; i++) {
+            if (fields[0] == RULE_FIELDS[i].name) {
+                rules.*(RULE_FIELDS[i].value) = value;
+            }
+        }
+    }
+    return true;
+}
+
+bool saveGameRules(const char filename[], const GameRules& rules) {
+    ofstream fout(filename);
+    if (!fout.is_open()) {
+        return false;
+    }
+    for (int i = 0; i < RULE_FIELD_COUNT; i++) {
+        fout << RULE_FIELDS[i].name << "|" << rules.*(RULE_FIELDS[i].value) << "\n";
+    }
+    return fout.good();
+}
@@ -0,0 +1,45 @@
+#ifndef RULES_H
+#define RULES_H
+
+// Reward values used by the game (and by the AI when it plans ahead)
+// The defaults are the original hand-picked values; a rules file can override them
+
+struct GameRules {
+    // Training Fellowship (pathType 0)
+    int fellowshipDP;
+    int fellowshipAccuracy;
+    int fellowshipEfficiency;
+    int fellowshipInsight;
+
+    // Direct Lab Assignment (pathType 1)
+    int directLabDP;
+    int directLabAccuracy;
+    int directLabEfficiency;
+    int directLabInsight;
+
+    // Tiles
+    int blueMaxAccuracy;    // scaled by the similarity score
+    int pinkEfficiency;
+    int redInsight;
+    int brownAccuracy;
+    int brownEfficiency;
+    int riddleInsight;
+};
+
+// Name of each value in a rules file, and where it lives in GameRules
+struct RuleField {
+    const char* name;
+    int GameRules::* value;
+};
+
+const int RULE_FIELD_COUNT = 14;
+extern const RuleField RULE_FIELDS[RULE_FIELD_COUNT];
+
+GameRules defaultGameRules();
+
+// Rules files have one "name|value" line per setting (see RULE_FIELDS for the names)
+// Settings that are missing keep their current value
+bool loadGameRules(const char filename[], GameRules& rules);
+bool saveGameRules(const char filename[], const GameRules& rules);
+
+#endif
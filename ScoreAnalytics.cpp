@@ -0,0 +1,287 @@
+#include "ScoreAnalytics.h"
+#include "Random.h"
+
+#include <algorithm>
+#include <iomanip>
+
+using namespace std;
+
+// =========================== Histogram ===========================
+
+Histogram::Histogram(double low, double high, int binCount) {
+    _low = low;
+    _width = (high - low) / binCount;
+    _bins.assign(binCount, 0);
+    _below = 0;
+    _above = 0;
+}
+
+void Histogram::add(double value) {
+    if (value < _low) {
+        _below++;
+        return;
+    }
+    long long bin = (long long)((value - _low) / _width);
+    if (bin >= (long long)_bins.size()) {
+        _above++;
+    } else {
+        _bins[bin]++;
+    }
+}
+
+void Histogram::merge(const Histogram& other) {
+    for (int i = 0; i < (int)_bins.size() && i < (int)other._bins.size(); i++) {
+        _bins[i] += other._bins[i];
+    }
+    _below += other._below;
+    _above += other._above;
+}
+
+void Histogram::print(ostream& out, int width) const {
+    long long largest = max(_below, _above);
+    for (int i = 0; i < (int)_bins.size(); i++) {
+        largest = max(largest, _bins[i]);
+    }
+    if (largest == 0) {
+        return;
+    }
+
+    if (_below > 0) {
+        out << setw(8) << "below" << " " << setw(8) << (long long)_low << " | "
+            << string((size_t)(_below * width / largest), '#') << " " << _below << "\n";
+    }
+    for (int i = 0; i < (int)_bins.size(); i++) {
+        if (_bins[i] == 0) {
+            continue;
+        }
+        out << setw(8) << (long long)(_low + i * _width) << " - "
+            << setw(6) << (long long)(_low + (i + 1) * _width) << " | "
+            << string((size_t)(_bins[i] * width / largest), '#') << " " << _bins[i] << "\n";
+    }
+    if (_above > 0) {
+        out << setw(8) << "above" << " " << setw(8) << (long long)(_low + _bins.size() * _width)
+            << " | " << string((size_t)(_above * width / largest), '#') << " " << _above << "\n";
+    }
+}
+
+// =========================== QuantileSketch ===========================
+
+QuantileSketch::QuantileSketch(int k) {
+    _k = k;
+    _levels.resize(1);
+    _count = 0;
+    _rng = 1300;
+}
+
+// Lower levels get smaller (2/3 per level down from the top), at least 2 values
+int QuantileSketch::capacity(int level) const {
+    int depth = _levels.size() - 1 - level;
+    double size = _k;
+    for (int i = 0; i < depth; i++) {
+        size *= 2.0 / 3.0;
+    }
+    return max(2, (int)size);
+}
+
+void QuantileSketch::compress() {
+    for (int level = 0; level < (int)_levels.size(); level++) {
+        if ((int)_levels[level].size() <= capacity(level)) {
+            continue;
+        }
+        if (level + 1 == (int)_levels.size()) {
+            _levels.push_back(vector<double>());
+        }
+
+        vector<double>& items = _levels[level];
+        sort(items.begin(), items.end());
+
+        // An odd value out stays behind, so the weights still add up
+        double leftover = 0.0;
+        bool hasLeftover = items.size() % 2 == 1;
+        if (hasLeftover) {
+            leftover = items.back();
+            items.pop_back();
+        }
+
+        // Randomly keep the even or the odd positions; each kept value now counts double
+        int offset = nextRandom(_rng) & 1;
+        for (int i = offset; i < (int)items.size(); i += 2) {
+            _levels[level + 1].push_back(items[i]);
+        }
+        items.clear();
+        if (hasLeftover) {
+            items.push_back(leftover);
+        }
+    }
+}
+
+void QuantileSketch::add(double value) {
+    _levels[0].push_back(value);
+    _count++;
+    if ((int)_levels[0].size() > capacity(0)) {
+        compress();
+    }
+}
+
+void QuantileSketch::merge(const QuantileSketch& other) {
+    while (_levels.size() < other._levels.size()) {
+        _levels.push_back(vector<double>());
+    }
+    for (int level = 0; level < (int)other._levels.size(); level++) {
+        _levels[level].insert(_levels[level].end(),
+                              other._levels[level].begin(), other._levels[level].end());
+    }
+    _count += other._count;
+    compress();
+}
+
+long long QuantileSketch::count() const {
+    return _count;
+}
+
+double QuantileSketch::quantile(double q) const {
+    // Every value at level h stands for 2^h original values
+    vector<pair<double, long long>> weighted;
+    long long total = 0;
+    for (int level = 0; level < (int)_levels.size(); level++) {
+        for (int i = 0; i < (int)_levels[level].size(); i++) {
+            weighted.push_back(make_pair(_levels[level][i], 1LL << level));
+            total += 1LL << level;
+        }
+    }
+    if (weighted.empty()) {
+        return 0.0;
+    }
+
+    sort(weighted.begin(), weighted.end());
+    long long target = (long long)(q * total);
+    long long seen = 0;
+    for (int i = 0; i < (int)weighted.size(); i++) {
+        seen += weighted[i].second;
+        if (seen > target) {
+            return weighted[i].first;
+        }
+    }
+    return weighted.back().first;
+}
+
+// =========================== ScoreGroup ===========================
+
+// Scores usually land between 0 and 160,000; bins are 2,500 points wide
+ScoreGroup::ScoreGroup() : histogram(0.0, 160000.0, 64), quantiles(200) {
+    count = 0;
+    sum = 0.0;
+    minimum = 0;
+    maximum = 0;
+    discoverPointsSum = 0.0;
+    accuracySum = 0.0;
+    efficiencySum = 0.0;
+    insightSum = 0.0;
+}
+
+void ScoreGroup::add(int discoverPoints, int accuracy, int efficiency, int insight, int score) {
+    if (count == 0 || score < minimum) minimum = score;
+    if (count == 0 || score > maximum) maximum = score;
+    count++;
+    sum += score;
+
+    // Same parts as Game::calculateFinalScore
+    discoverPointsSum += discoverPoints;
+    accuracySum += (accuracy / 100) * 1000;
+    efficiencySum += (efficiency / 100) * 1000;
+    insightSum += (insight / 100) * 1000;
+
+    histogram.add(score);
+    quantiles.add(score);
+}
+
+void ScoreGroup::merge(const ScoreGroup& other) {
+    if (other.count == 0) {
+        return;
+    }
+    if (count == 0 || other.minimum < minimum) minimum = other.minimum;
+    if (count == 0 || other.maximum > maximum) maximum = other.maximum;
+    count += other.count;
+    sum += other.sum;
+    discoverPointsSum += other.discoverPointsSum;
+    accuracySum += other.accuracySum;
+    efficiencySum += other.efficiencySum;
+    insightSum += other.insightSum;
+    histogram.merge(other.histogram);
+    quantiles.merge(other.quantiles);
+}
+
+// =========================== ScoreAnalytics ===========================
+
+ScoreAnalytics::ScoreAnalytics(const vector<string>& characterNames) {
+    _characterNames = characterNames;
+    _groups.resize(characterNames.size() * 2);
+}
+
+void ScoreAnalytics::add(int characterId, const Player& p, int score) {
+    addValues(characterId, p.getPathType(), p.getDiscoverPoints(), p.getAccuracy(),
+              p.getEfficiency(), p.getInsight(), score);
+}
+
+void ScoreAnalytics::add(int characterId, const PlayerRow& p, int score) {
+    addValues(characterId, p.getPathType(), p.getDiscoverPoints(), p.getAccuracy(),
+              p.getEfficiency(), p.getInsight(), score);
+}
+
+void ScoreAnalytics::addValues(int characterId, int path, int discoverPoints, int accuracy,
+                               int efficiency, int insight, int score) {
+    _overall.add(discoverPoints, accuracy, efficiency, insight, score);
+
+    if (characterId >= 0 && characterId < (int)_characterNames.size() && (path == 0 || path == 1)) {
+        _groups[characterId * 2 + path].add(discoverPoints, accuracy, efficiency, insight, score);
+    }
+}
+
+void ScoreAnalytics::merge(const ScoreAnalytics& other) {
+    _overall.merge(other._overall);
+    for (int i = 0; i < (int)_groups.size() && i < (int)other._groups.size(); i++) {
+        _groups[i].merge(other._groups[i]);
+    }
+}
+
+void ScoreAnalytics::report(ostream& out) const {
+    const char* pathNames[2] = {"Fellowship", "Direct Lab"};
+
+    out << "\n===== SCORE DISTRIBUTION (" << _overall.count << " players) =====\n";
+    if (_overall.count == 0) {
+        return;
+    }
+    out << fixed << setprecision(0);
+    out << "Mean " << _overall.sum / _overall.count
+        << "  Min " << _overall.minimum << "  Max " << _overall.maximum
+        << "  P10 " << _overall.quantiles.quantile(0.10)
+        << "  P50 " << _overall.quantiles.quantile(0.50)
+        << "  P90 " << _overall.quantiles.quantile(0.90)
+        << "  P99 " << _overall.quantiles.quantile(0.99) << "\n\n";
+    _overall.histogram.print(out, 50);
+
+    out << "\n===== BY CHARACTER AND PATH =====\n";
+    out << left << setw(14) << "Character" << setw(12) << "Path" << right
+        << setw(9) << "Players" << setw(9) << "Mean" << setw(9) << "P50" << setw(9) << "P90"
+        << " | avg from DP" << setw(8) << "Acc" << setw(8) << "Eff" << setw(8) << "Ins" << "\n";
+
+    for (int c = 0; c < (int)_characterNames.size(); c++) {
+        for (int path = 0; path < 2; path++) {
+            const ScoreGroup& g = _groups[c * 2 + path];
+            if (g.count == 0) {
+                continue;
+            }
+            out << left << setw(14) << _characterNames[c] << setw(12) << pathNames[path] << right
+                << setw(9) << g.count
+                << setw(9) << g.sum / g.count
+                << setw(9) << g.quantiles.quantile(0.5)
+                << setw(9) << g.quantiles.quantile(0.9)
+                << " | " << setw(11) << g.discoverPointsSum / g.count
+                << setw(8) << g.accuracySum / g.count
+                << setw(8) << g.efficiencySum / g.count
+                << setw(8) << g.insightSum / g.count << "\n";
+        }
+    }
+    out.unsetf(ios::fixed);
+    out << setprecision(6);
+}
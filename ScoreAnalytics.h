@@ -0,0 +1,97 @@
+#ifndef SCOREANALYTICS_H
+#define SCOREANALYTICS_H
+
+#include "Player.h"
+#include "PlayerTable.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Streaming statistics for final scores of many games
+// Memory does not grow with the number of games: each group keeps a fixed
+// histogram, a small quantile sketch and a few running totals.
+// Every worker thread fills its own ScoreAnalytics, and they are merged at the end.
+
+// Fixed-width bins between low and high, plus counts below and above the range
+class Histogram {
+private:
+    double _low;
+    double _width;
+    vector<long long> _bins;
+    long long _below;
+    long long _above;
+
+public:
+    Histogram(double low, double high, int binCount);
+
+    void add(double value);
+    void merge(const Histogram& other);
+    // Prints one bar per non-empty bin, scaled to 'width' characters
+    void print(ostream& out, int width) const;
+};
+
+// KLL quantile sketch: keeps about k values per level, and each level up stands
+// for twice as many values. When a level is full it is sorted and every other
+// value moves up. Estimates are within about 1-2% in rank for k = 200.
+class QuantileSketch {
+private:
+    int _k;
+    vector<vector<double>> _levels;
+    long long _count;
+    unsigned long long _rng;
+
+    int capacity(int level) const;
+    void compress();
+
+public:
+    explicit QuantileSketch(int k = 200);
+
+    void add(double value);
+    void merge(const QuantileSketch& other);
+    long long count() const;
+    // q between 0 and 1 (0.5 = median)
+    double quantile(double q) const;
+};
+
+// Score totals for one group of players (for example one character on one path)
+struct ScoreGroup {
+    long long count;
+    double sum;
+    int minimum;
+    int maximum;
+    // How much of the final score came from each part (see Game::calculateFinalScore)
+    double discoverPointsSum;
+    double accuracySum;
+    double efficiencySum;
+    double insightSum;
+    Histogram histogram;
+    QuantileSketch quantiles;
+
+    ScoreGroup();
+    void add(int discoverPoints, int accuracy, int efficiency, int insight, int score);
+    void merge(const ScoreGroup& other);
+};
+
+class ScoreAnalytics {
+private:
+    vector<string> _characterNames;
+    ScoreGroup _overall;
+    vector<ScoreGroup> _groups;   // [character * 2 + path]
+
+    void addValues(int characterId, int path, int discoverPoints, int accuracy,
+                   int efficiency, int insight, int score);
+
+public:
+    explicit ScoreAnalytics(const vector<string>& characterNames);
+
+    // Records one player's final result
+    void add(int characterId, const Player& p, int score);
+    void add(int characterId, const PlayerRow& p, int score);
+    void merge(const ScoreAnalytics& other);
+    void report(ostream& out) const;
+};
+
+#endif
@@ -0,0 +1,86 @@
+#include "ScratchArena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+using namespace std;
+
+ScratchArena::ScratchArena(size_t firstBlock) {
+    _block = 0;
+    _used = 0;
+    _firstBlock = max(firstBlock, (size_t)64);
+}
+
+ScratchArena::~ScratchArena() {
+    for (size_t b = 0; b < _blocks.size(); b++) {
+        ::operator delete(_blocks[b].data);
+    }
+}
+
+void* ScratchArena::do_allocate(size_t bytes, size_t alignment) {
+    if (_blocks.empty()) {
+        size_t size = max(_firstBlock, bytes + alignment);
+        _blocks.push_back({(char*)::operator new(size), size});
+    }
+    while (true) {
+        Block& block = _blocks[_block];
+        uintptr_t next = (uintptr_t)(block.data + _used);
+        size_t start = ((next + alignment - 1) & ~(uintptr_t)(alignment - 1)) - (uintptr_t)block.data;
+        if (start + bytes <= block.size) {
+            _used = start + bytes;
+            return block.data + start;
+        }
+        // This block is full: move on to the next one, or add a bigger one
+        // (this is the only place the arena uses the heap)
+        if (_block + 1 == _blocks.size()) {
+            size_t size = max(block.size * 2, bytes + alignment);
+            _blocks.push_back({(char*)::operator new(size), size});
+        }
+        _block++;
+        _used = 0;
+    }
+}
+
+void ScratchArena::do_deallocate(void* /*pointer*/, size_t /*bytes*/, size_t /*alignment*/) {
+    // Nothing to do: memory comes back all at once with reset or rewind
+}
+
+bool ScratchArena::do_is_equal(const pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+void ScratchArena::reset() {
+    _block = 0;
+    _used = 0;
+}
+
+ScratchArena::Mark ScratchArena::mark() const {
+    return {_block, _used};
+}
+
+void ScratchArena::rewind(const Mark& position) {
+    _block = position.block;
+    _used = position.used;
+}
+
+size_t ScratchArena::getCapacity() const {
+    size_t total = 0;
+    for (size_t b = 0; b < _blocks.size(); b++) {
+        total += _blocks[b].size;
+    }
+    return total;
+}
+
+ScratchArena& threadScratch() {
+    static thread_local ScratchArena arena(64 << 10);
+    return arena;
+}
+
+ScratchScope::ScratchScope(ScratchArena& arena) : _arena(arena) {
+    _mark = arena.mark();
+}
+
+ScratchScope::~ScratchScope() {
+    _arena.rewind(_mark);
+}
@@ -0,0 +1,91 @@
+#ifndef SCRATCHARENA_H
+#define SCRATCHARENA_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Scratch memory for temporaries that only live for one turn or one query
+//
+// Strands typed in a turn, lowercased riddle answers and alignment rows used
+// to be std::strings and vectors, each a malloc and a free. An arena hands
+// out memory by moving a pointer forward through big blocks and frees nothing
+// until it is reset, which rewinds the pointer in one step. The blocks are
+// kept, so once the arena has grown to fit a turn (warm-up), later turns do
+// not touch the heap at all.
+//
+// It is a std::pmr::memory_resource, so the standard containers can use it:
+//   ScratchString text(&arena);                 // like a string
+//   pmr::vector<int> row(width, &arena);        // like a vector
+//
+// Two ways to give memory back:
+//  - reset(): everything at once (Game does this at the start of each turn)
+//  - ScratchScope: remembers the position and rewinds to it when it goes out
+//    of scope, for a function that uses scratch and then returns
+// Nothing allocated after the reset/mark may be used afterwards.
+//
+// Each Game has its own arena (server games on one thread take turns in the
+// middle of a turn, so they cannot share one). threadScratch() is one arena
+// per thread for kernels that finish before returning, like alignStrands.
+
+using ScratchString = pmr::string;
+
+class ScratchArena : public pmr::memory_resource {
+private:
+    struct Block {
+        char* data;
+        size_t size;
+    };
+
+    vector<Block> _blocks;
+    size_t _block;        // block being handed out
+    size_t _used;         // bytes of it handed out
+    size_t _firstBlock;   // size of the first block (allocated on first use)
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const pmr::memory_resource& other) const noexcept override;
+
+public:
+    explicit ScratchArena(size_t firstBlock = 4096);
+    ~ScratchArena();
+
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    // Frees everything handed out (the blocks are kept for next time)
+    void reset();
+
+    // A position to rewind to (see ScratchScope)
+    struct Mark {
+        size_t block;
+        size_t used;
+    };
+    Mark mark() const;
+    void rewind(const Mark& position);
+
+    // Bytes in all blocks
+    size_t getCapacity() const;
+};
+
+// This thread's arena
+ScratchArena& threadScratch();
+
+// Rewinds an arena to where it was when the scope started
+class ScratchScope {
+private:
+    ScratchArena& _arena;
+    ScratchArena::Mark _mark;
+
+public:
+    explicit ScratchScope(ScratchArena& arena);
+    ~ScratchScope();
+
+    ScratchScope(const ScratchScope&) = delete;
+    ScratchScope& operator=(const ScratchScope&) = delete;
+};
+
+#endif
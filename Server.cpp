@@ -0,0 +1,618 @@
+#include "Server.h"
+
+#ifndef __linux__
+
+// epoll and ucontext are Linux features
+int runServer(const string& address, int workerCount, ResultCache* results, ostream& log) {
+    log << "Error: server mode is only available on Linux" << endl;
+    return 1;
+}
+
+#else
+
+#include "Game.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+const size_t STACK_SIZE = 128 * 1024;   // each session's coroutine stack
+const size_t MAX_INPUT = 16 * 1024;     // typed text not yet read by the game
+const size_t MAX_UNSENT = 256 * 1024;   // printed text the client has not taken yet
+
+// Thrown inside a session when its connection is gone, so the game's stack
+// unwinds normally (strings and vectors on it are freed)
+struct SessionClosed {};
+
+struct Session;
+
+// What the game reads: text the event loop received, or a pause until more arrives
+class SessionInput : public streambuf {
+private:
+    Session& _session;
+    char _buffer[1024];
+
+protected:
+    int underflow() override;
+
+public:
+    explicit SessionInput(Session& session) : _session(session) {}
+};
+
+// What the game prints: collected until the session pauses, then sent in one go
+class SessionOutput : public streambuf {
+private:
+    Session& _session;
+    char _buffer[4096];
+
+protected:
+    int overflow(int c) override;
+    int sync() override;
+
+public:
+    explicit SessionOutput(Session& session) : _session(session) {
+        setp(_buffer, _buffer + sizeof(_buffer));
+    }
+};
+
+struct Session {
+    int fd;
+    int worker;                // the only worker that ever runs this session
+
+    // Shared by the event loop and the worker
+    mutex lock;
+    string input;              // received, not yet read by the game
+    string unsent;             // printed, not yet accepted by the socket
+    bool closed;               // no more input will come
+    bool scheduled;            // waiting in the worker's queue
+    bool finished;             // the game is over (the coroutine has ended)
+    bool queuedForClose;       // in _done (only one copy may ever be there)
+    bool running;              // a worker has it (popped, not yet handed back)
+    bool watchingOutput;       // EPOLLOUT is switched on
+
+    // Only touched by the session's worker
+    string output;             // printed since the session last paused
+    ucontext_t context;
+    ucontext_t* returnTo;      // the worker's own context
+    char* stackMemory;
+
+    SessionInput inBuffer;
+    SessionOutput outBuffer;
+    istream in;
+    ostream out;
+    Game* game;
+
+    Session() : inBuffer(*this), outBuffer(*this), in(&inBuffer), out(&outBuffer) {
+        fd = -1;
+        worker = 0;
+        closed = false;
+        scheduled = false;
+        finished = false;
+        queuedForClose = false;
+        running = false;
+        watchingOutput = false;
+        returnTo = nullptr;
+        stackMemory = nullptr;
+        game = nullptr;
+        // Let SessionClosed out of >> and getline instead of just failing the stream
+        in.exceptions(ios::badbit);
+    }
+};
+
+int SessionInput::underflow() {
+    while (true) {
+        {
+            lock_guard<mutex> guard(_session.lock);
+            if (!_session.input.empty()) {
+                size_t count = min(_session.input.size(), sizeof(_buffer));
+                memcpy(_buffer, _session.input.data(), count);
+                _session.input.erase(0, count);
+                setg(_buffer, _buffer, _buffer + count);
+                return traits_type::to_int_type(_buffer[0]);
+            }
+            if (_session.closed) {
+                throw SessionClosed();
+            }
+        }
+        // Nothing to read yet: send the prompt, then pause until more input comes
+        _session.out.flush();
+        swapcontext(&_session.context, _session.returnTo);
+    }
+}
+
+int SessionOutput::overflow(int c) {
+    sync();
+    if (c != traits_type::eof()) {
+        *pptr() = (char)c;
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+int SessionOutput::sync() {
+    _session.output.append(pbase(), pptr() - pbase());
+    setp(_buffer, _buffer + sizeof(_buffer));
+    return 0;
+}
+
+class Server {
+private:
+    struct Worker {
+        thread runner;
+        mutex lock;
+        condition_variable ready;
+        deque<Session*> queue;
+        ucontext_t context;
+    };
+
+    int _epoll;
+    int _listener;
+    int _wakeup;   // eventfd: a worker has finished sessions for the loop to close
+    vector<unique_ptr<Worker>> _workers;
+    int _nextWorker;
+    long _sessionCount;
+    long _finishedCount;
+    ResultCache* _results;
+
+    mutex _doneLock;
+    vector<Session*> _done;
+
+    ostream& _log;
+
+    static void sessionMain(unsigned high, unsigned low);
+
+    void workerLoop(Worker* worker);
+    void schedule(Session* session);
+    void sendOutput(Session* session);
+    bool flushUnsent(Session* session);
+    void watchOutput(Session* session, bool on);
+
+    void acceptConnections();
+    void readInput(Session* session);
+    void queueForClose(Session* session);
+    void closeFinished();
+    bool startSession(int fd);
+
+public:
+    Server(int workerCount, ResultCache* results, ostream& log);
+    bool listenOn(const string& address);
+    int run();
+};
+
+Server::Server(int workerCount, ResultCache* results, ostream& log) : _log(log) {
+    _epoll = -1;
+    _listener = -1;
+    _wakeup = -1;
+    _nextWorker = 0;
+    _sessionCount = 0;
+    _finishedCount = 0;
+    _results = results;
+    if (workerCount < 1) {
+        workerCount = 1;
+    }
+    for (int w = 0; w < workerCount; w++) {
+        _workers.push_back(unique_ptr<Worker>(new Worker()));
+    }
+}
+
+bool Server::listenOn(const string& address) {
+    if (address.size() > 0 && address[0] == '/') {
+        sockaddr_un local;
+        memset(&local, 0, sizeof(local));
+        local.sun_family = AF_UNIX;
+        if (address.size() >= sizeof(local.sun_path)) {
+            _log << "Error: socket path is too long" << endl;
+            return false;
+        }
+        strcpy(local.sun_path, address.c_str());
+        unlink(address.c_str());   // left over from an earlier run
+        _listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (_listener < 0 || bind(_listener, (sockaddr*)&local, sizeof(local)) != 0) {
+            _log << "Error: could not listen on " << address << endl;
+            return false;
+        }
+    } else {
+        sockaddr_in local;
+        memset(&local, 0, sizeof(local));
+        local.sin_family = AF_INET;
+        local.sin_port = htons((unsigned short)atoi(address.c_str()));
+        local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);   // local players only
+        _listener = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int yes = 1;
+        if (_listener >= 0) {
+            setsockopt(_listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+        }
+        if (_listener < 0 || bind(_listener, (sockaddr*)&local, sizeof(local)) != 0) {
+            _log << "Error: could not listen on port " << address << endl;
+            return false;
+        }
+    }
+    if (listen(_listener, 1024) != 0) {
+        _log << "Error: could not listen on " << address << endl;
+        return false;
+    }
+
+    _epoll = epoll_create1(EPOLL_CLOEXEC);
+    _wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_epoll < 0 || _wakeup < 0) {
+        _log << "Error: could not set up epoll" << endl;
+        return false;
+    }
+
+    // The listener and the eventfd are told apart from sessions by their data.ptr
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = &_listener;
+    epoll_ctl(_epoll, EPOLL_CTL_ADD, _listener, &event);
+    event.data.ptr = &_wakeup;
+    epoll_ctl(_epoll, EPOLL_CTL_ADD, _wakeup, &event);
+    return true;
+}
+
+// makecontext only passes ints, so the Session pointer comes in two halves
+void Server::sessionMain(unsigned high, unsigned low) {
+    Session* session = (Session*)(((uintptr_t)high << 32) | (uintptr_t)low);
+    try {
+        session->game->run();
+    } catch (SessionClosed&) {
+        // The player left; the game's stack has been unwound
+    } catch (...) {
+        // Anything else ends just this session
+    }
+    session->out.flush();
+    {
+        // The event loop reads this under the lock too
+        lock_guard<mutex> guard(session->lock);
+        session->finished = true;
+    }
+    // Back to the worker for good (this stack is never resumed again)
+    setcontext(session->returnTo);
+}
+
+bool Server::startSession(int fd) {
+    Session* session = new Session();
+    session->fd = fd;
+    session->worker = _nextWorker;
+    _nextWorker = (_nextWorker + 1) % _workers.size();
+    session->returnTo = &_workers[session->worker]->context;
+
+    // Stack with an unmapped guard page below it, so an overflow crashes
+    // instead of silently corrupting another session
+    size_t page = sysconf(_SC_PAGESIZE);
+    void* memory = mmap(0, STACK_SIZE + page, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (memory == MAP_FAILED) {
+        delete session;
+        return false;
+    }
+    mprotect(memory, page, PROT_NONE);
+    session->stackMemory = (char*)memory;
+
+    getcontext(&session->context);
+    session->context.uc_stack.ss_sp = session->stackMemory + page;
+    session->context.uc_stack.ss_size = STACK_SIZE;
+    session->context.uc_link = nullptr;
+    uintptr_t address = (uintptr_t)session;
+    makecontext(&session->context, (void (*)())sessionMain, 2,
+                (unsigned)(address >> 32), (unsigned)(address & 0xffffffffu));
+
+    session->game = new Game(session->in, session->out);
+    session->game->setResultCache(_results);
+
+    epoll_event event;
+    event.events = EPOLLIN | EPOLLRDHUP;
+    event.data.ptr = session;
+    if (epoll_ctl(_epoll, EPOLL_CTL_ADD, fd, &event) != 0) {
+        munmap(session->stackMemory, STACK_SIZE + page);
+        delete session->game;
+        delete session;
+        return false;
+    }
+
+    _sessionCount++;
+    // Start the game right away so the welcome text is sent
+    lock_guard<mutex> guard(session->lock);
+    session->scheduled = true;
+    schedule(session);
+    return true;
+}
+
+// Adds a session to its worker's queue (caller has set session->scheduled)
+void Server::schedule(Session* session) {
+    Worker& worker = *_workers[session->worker];
+    lock_guard<mutex> guard(worker.lock);
+    worker.queue.push_back(session);
+    worker.ready.notify_one();
+}
+
+void Server::workerLoop(Worker* worker) {
+    while (true) {
+        Session* session;
+        {
+            unique_lock<mutex> guard(worker->lock);
+            worker->ready.wait(guard, [&]() { return !worker->queue.empty(); });
+            session = worker->queue.front();
+            worker->queue.pop_front();
+        }
+        if (session == nullptr) {
+            return;   // shutting down
+        }
+
+        // From here until the last locked block below the worker owns the
+        // session: closeFinished leaves it alone while 'running' is set
+        bool finished;
+        {
+            lock_guard<mutex> guard(session->lock);
+            session->scheduled = false;
+            session->running = true;
+            finished = session->finished;
+        }
+
+        if (!finished) {
+            // Run the game until it needs input it doesn't have, or ends
+            swapcontext(&worker->context, &session->context);
+            sendOutput(session);
+        }
+
+        // Hand it to the event loop to close (the loop frees it once nothing
+        // refers to it any more). Nothing touches the session after this block
+        lock_guard<mutex> guard(session->lock);
+        session->running = false;
+        if (session->finished) {
+            queueForClose(session);
+        }
+    }
+}
+
+// Sends what the game printed; whatever the socket won't take now waits in
+// 'unsent' for EPOLLOUT
+void Server::sendOutput(Session* session) {
+    if (session->output.empty()) {
+        return;
+    }
+    lock_guard<mutex> guard(session->lock);
+    session->unsent += session->output;
+    session->output.clear();
+    flushUnsent(session);
+    if (session->unsent.size() > MAX_UNSENT) {
+        // The client is not reading: give up on it
+        session->unsent.clear();
+        session->closed = true;
+        shutdown(session->fd, SHUT_RDWR);
+    }
+}
+
+// Writes as much of 'unsent' as the socket takes (session lock held);
+// returns true once everything is sent
+bool Server::flushUnsent(Session* session) {
+    while (!session->unsent.empty()) {
+        ssize_t sent = send(session->fd, session->unsent.data(), session->unsent.size(), MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                session->unsent.clear();   // connection is broken
+                session->closed = true;
+            }
+            break;
+        }
+        session->unsent.erase(0, sent);
+    }
+    watchOutput(session, !session->unsent.empty());
+    return session->unsent.empty();
+}
+
+void Server::watchOutput(Session* session, bool on) {
+    if (session->watchingOutput == on) {
+        return;
+    }
+    session->watchingOutput = on;
+    epoll_event event;
+    event.events = EPOLLIN | EPOLLRDHUP | (on ? (uint32_t)EPOLLOUT : 0u);
+    event.data.ptr = session;
+    epoll_ctl(_epoll, EPOLL_CTL_MOD, session->fd, &event);
+}
+
+void Server::acceptConnections() {
+    while (true) {
+        int fd = accept4(_listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;   // no more waiting (or out of file descriptors: try later)
+        }
+        int yes = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));   // fails harmlessly on Unix sockets
+        if (!startSession(fd)) {
+            close(fd);
+        }
+    }
+}
+
+void Server::readInput(Session* session) {
+    char buffer[4096];
+    bool gone = false;
+    string received;
+    while (true) {
+        ssize_t count = recv(session->fd, buffer, sizeof(buffer), 0);
+        if (count > 0) {
+            received.append(buffer, count);
+            continue;
+        }
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+            gone = true;
+        }
+        break;
+    }
+
+    lock_guard<mutex> guard(session->lock);
+    if (session->finished) {
+        return;
+    }
+    session->input += received;
+    if (session->input.size() > MAX_INPUT) {
+        gone = true;   // far more than anyone types in one turn
+    }
+    if (gone) {
+        session->closed = true;
+        // Stop listening; the fd is closed when the game has wound down
+        epoll_ctl(_epoll, EPOLL_CTL_DEL, session->fd, nullptr);
+    }
+    if ((gone || !received.empty()) && !session->scheduled) {
+        session->scheduled = true;
+        schedule(session);
+    }
+}
+
+// Puts a finished session on _done for closeFinished (session lock held).
+// The worker and the EPOLLOUT handler can both see it finished before the
+// loop gets to it; only the first one queues it, or it would be freed twice
+void Server::queueForClose(Session* session) {
+    if (session->queuedForClose) {
+        return;
+    }
+    session->queuedForClose = true;
+    {
+        lock_guard<mutex> guard(_doneLock);
+        _done.push_back(session);
+    }
+    uint64_t one = 1;
+    ssize_t ignored = write(_wakeup, &one, sizeof(one));
+    (void)ignored;
+}
+
+// Frees sessions whose game is over, once their last output has gone out
+void Server::closeFinished() {
+    uint64_t count;
+    ssize_t ignored = read(_wakeup, &count, sizeof(count));
+    (void)ignored;
+
+    vector<Session*> done;
+    {
+        lock_guard<mutex> guard(_doneLock);
+        done.swap(_done);
+    }
+
+    size_t page = sysconf(_SC_PAGESIZE);
+    for (size_t i = 0; i < done.size(); i++) {
+        Session* session = done[i];
+        {
+            lock_guard<mutex> guard(session->lock);
+            // Queued for or held by a worker (the worker will report it again),
+            // or still sending (EPOLLOUT will report it once the output is out)
+            if (session->scheduled || session->running ||
+                (!session->closed && !session->unsent.empty())) {
+                session->queuedForClose = false;
+                continue;
+            }
+        }
+        epoll_ctl(_epoll, EPOLL_CTL_DEL, session->fd, nullptr);
+        // Closing with unread input makes the kernel reset the connection, which
+        // can throw away the game's last output; end our side and discard it first
+        shutdown(session->fd, SHUT_WR);
+        char discard[4096];
+        while (recv(session->fd, discard, sizeof(discard), 0) > 0) {
+        }
+        close(session->fd);
+        delete session->game;
+        munmap(session->stackMemory, STACK_SIZE + page);
+        delete session;
+        _sessionCount--;
+        _finishedCount++;
+        if (_results != nullptr && _finishedCount % 1000 == 0) {
+            printCacheCounters(*_results, _log);
+        }
+    }
+}
+
+int Server::run() {
+    for (size_t w = 0; w < _workers.size(); w++) {
+        _workers[w]->runner = thread(&Server::workerLoop, this, _workers[w].get());
+    }
+    _log << "Server running with " << _workers.size() << " worker threads" << endl;
+
+    vector<epoll_event> events(1024);
+    while (true) {
+        int count = epoll_wait(_epoll, events.data(), events.size(), -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        // Sessions are freed only after the whole batch, since a later event
+        // in the same batch may still point at one
+        bool wakeup = false;
+        for (int i = 0; i < count; i++) {
+            void* tag = events[i].data.ptr;
+            if (tag == &_listener) {
+                acceptConnections();
+            } else if (tag == &_wakeup) {
+                wakeup = true;
+            } else {
+                Session* session = (Session*)tag;
+                if (events[i].events & EPOLLOUT) {
+                    lock_guard<mutex> guard(session->lock);
+                    if (flushUnsent(session) && session->finished) {
+                        // Last output is out: let closeFinished free it
+                        queueForClose(session);
+                    }
+                }
+                if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                    readInput(session);
+                }
+            }
+        }
+        if (wakeup) {
+            closeFinished();
+        }
+    }
+
+    // Only reached if epoll itself fails
+    for (size_t w = 0; w < _workers.size(); w++) {
+        lock_guard<mutex> guard(_workers[w]->lock);
+        _workers[w]->queue.push_back(nullptr);
+        _workers[w]->ready.notify_one();
+    }
+    for (size_t w = 0; w < _workers.size(); w++) {
+        _workers[w]->runner.join();
+    }
+    _log << "Error: epoll_wait failed" << endl;
+    return 1;
+}
+
+}  // namespace
+
+int runServer(const string& address, int workerCount, ResultCache* results, ostream& log) {
+    Server server(workerCount, results, log);
+    if (!server.listenOn(address)) {
+        return 1;
+    }
+    return server.run();
+}
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "ResultCache.h"
+
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+// Server mode: many games in one process, played over local socket connections
+//
+// Every connection gets its own Game, exactly like a terminal game (two players
+// taking turns at one keyboard). One thread runs an epoll event loop that
+// accepts connections, reads whatever players type and sends back what the
+// games print. A small pool of worker threads runs the games themselves.
+//
+// A Game is written as ordinary code that reads input with >> and getline.
+// Instead of blocking a thread there, each session runs on its own small stack
+// (a ucontext coroutine): when the game asks for input that has not arrived,
+// the session's input buffer saves the session's place and returns to the
+// worker, which moves on to other sessions. When the player's next line
+// arrives, the session is queued again and continues from the same spot.
+// A session always runs on the same worker, so it never moves between threads.
+//
+// Memory per session is bounded: a 128 KB stack (only the pages it touches
+// are used), the Game, and input/output buffers with fixed limits. Sessions
+// that send too much or read too little are disconnected.
+//
+// 'address' is a TCP port on 127.0.0.1 (like "7300") or a Unix socket path
+// (starting with '/'). Runs until the process is stopped. Linux only.
+// All games share 'results' for their DNA tasks (nullptr = no caching); its
+// counters are logged every 1000 finished sessions.
+int runServer(const string& address, int workerCount, ResultCache* results, ostream& log);
+
+#endif
@@ -0,0 +1,189 @@
+#include "SimilarityMatrix.h"
+#include "DNAUtils.h"
+#include "StrandIO.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <thread>
+
+using namespace std;
+
+// One pair inside a tile while it is being compared
+struct PairProgress {
+    int first;
+    int second;
+    int length;
+    int matches;
+};
+
+SimilarityMatrix::SimilarityMatrix() {
+    _count = 0;
+    _dense = true;
+}
+
+void SimilarityMatrix::compute(const vector<string>& strands, double cutoff, bool dense, int threadCount) {
+    _count = strands.size();
+    _dense = dense;
+    _values.clear();
+    _pairs.clear();
+    if (threadCount < 1) {
+        threadCount = 1;
+    }
+    if (_dense) {
+        _values.assign((size_t)_count * _count, 0.0f);
+        for (int s = 0; s < _count; s++) {
+            if (strands[s].size() > 0) {
+                _values[(size_t)s * _count + s] = 1.0f;
+            }
+        }
+    }
+
+    // Tile t is block pair (tileRows[t], tileColumns[t]), upper triangle only
+    int blocks = (_count + _BLOCK_STRANDS - 1) / _BLOCK_STRANDS;
+    vector<int> tileRows;
+    vector<int> tileColumns;
+    for (int row = 0; row < blocks; row++) {
+        for (int column = row; column < blocks; column++) {
+            tileRows.push_back(row);
+            tileColumns.push_back(column);
+        }
+    }
+
+    atomic<int> nextTile(0);
+    vector<vector<SimilarityPair>> found(threadCount);
+    vector<thread> workers;
+    for (int t = 0; t < threadCount; t++) {
+        workers.push_back(thread([&, t]() {
+            vector<PairProgress> live;
+            while (true) {
+                int tile = nextTile.fetch_add(1);
+                if (tile >= (int)tileRows.size()) {
+                    break;
+                }
+                int rowStart = tileRows[tile] * _BLOCK_STRANDS;
+                int rowEnd = min(rowStart + _BLOCK_STRANDS, _count);
+                int columnStart = tileColumns[tile] * _BLOCK_STRANDS;
+                int columnEnd = min(columnStart + _BLOCK_STRANDS, _count);
+
+                // Only equal, non-zero lengths can be compared
+                live.clear();
+                int longest = 0;
+                for (int a = rowStart; a < rowEnd; a++) {
+                    for (int b = max(columnStart, a + 1); b < columnEnd; b++) {
+                        int length = strands[a].size();
+                        if (length > 0 && (int)strands[b].size() == length) {
+                            live.push_back({a, b, length, 0});
+                            longest = max(longest, length);
+                        }
+                    }
+                }
+
+                // Slice by slice, every live pair reads the same cached bases
+                for (int start = 0; start < longest && live.size() > 0; start += _SLICE_BASES) {
+                    size_t p = 0;
+                    while (p < live.size()) {
+                        PairProgress& pair = live[p];
+                        if (start >= pair.length) {
+                            p++;
+                            continue;
+                        }
+                        int bases = min(_SLICE_BASES, pair.length - start);
+                        pair.matches += countMatches(strands[pair.first].data() + start,
+                                                     strands[pair.second].data() + start, bases);
+                        // Early exit: best case is every remaining base matching
+                        int remaining = pair.length - start - bases;
+                        if (cutoff > 0 && (pair.matches + remaining) / (double)pair.length < cutoff) {
+                            live[p] = live.back();
+                            live.pop_back();
+                            continue;
+                        }
+                        p++;
+                    }
+                }
+
+                for (size_t p = 0; p < live.size(); p++) {
+                    double similarity = live[p].matches / (double)live[p].length;
+                    if (similarity < cutoff) {
+                        continue;
+                    }
+                    if (_dense) {
+                        // Each cell belongs to exactly one tile, so threads never share one
+                        _values[(size_t)live[p].first * _count + live[p].second] = similarity;
+                        _values[(size_t)live[p].second * _count + live[p].first] = similarity;
+                    } else {
+                        found[t].push_back({live[p].first, live[p].second, similarity});
+                    }
+                }
+            }
+        }));
+    }
+    for (int t = 0; t < threadCount; t++) {
+        workers[t].join();
+    }
+
+    if (!_dense) {
+        for (int t = 0; t < threadCount; t++) {
+            _pairs.insert(_pairs.end(), found[t].begin(), found[t].end());
+        }
+        sort(_pairs.begin(), _pairs.end(), [](const SimilarityPair& x, const SimilarityPair& y) {
+            return x.first != y.first ? x.first < y.first : x.second < y.second;
+        });
+    }
+}
+
+int SimilarityMatrix::size() const {
+    return _count;
+}
+
+bool SimilarityMatrix::isDense() const {
+    return _dense;
+}
+
+double SimilarityMatrix::get(int first, int second) const {
+    if (!_dense || first < 0 || second < 0 || first >= _count || second >= _count) {
+        return 0;
+    }
+    return _values[(size_t)first * _count + second];
+}
+
+const vector<SimilarityPair>& SimilarityMatrix::getPairs() const {
+    return _pairs;
+}
+
+void SimilarityMatrix::print(const vector<string>& names, ostream& out) const {
+    out << fixed << setprecision(4);
+    if (_dense) {
+        for (int s = 0; s < _count; s++) {
+            out << "\t" << names[s];
+        }
+        out << "\n";
+        for (int first = 0; first < _count; first++) {
+            out << names[first];
+            for (int second = 0; second < _count; second++) {
+                out << "\t" << get(first, second);
+            }
+            out << "\n";
+        }
+    } else {
+        for (size_t p = 0; p < _pairs.size(); p++) {
+            out << names[_pairs[p].first] << "\t" << names[_pairs[p].second]
+                << "\t" << _pairs[p].similarity << "\n";
+        }
+        out << _pairs.size() << " pairs\n";
+    }
+    out.flush();
+}
+
+int printSimilarityMatrix(const char strandFile[], double cutoff, int threadCount, ostream& out) {
+    vector<string> names;
+    vector<string> strands;
+    if (!readStrands(strandFile, names, strands)) {
+        out << "Error: could not read " << strandFile << endl;
+        return 1;
+    }
+    SimilarityMatrix matrix;
+    matrix.compute(strands, cutoff, cutoff <= 0, threadCount);
+    matrix.print(names, out);
+    return 0;
+}
@@ -0,0 +1,62 @@
+#ifndef SIMILARITYMATRIX_H
+#define SIMILARITYMATRIX_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// All-vs-all strandSimilarity for a set of strands (for clustering)
+//
+// Calling strandSimilarity for every pair reads each strand from memory n
+// times. Here the strands are split into blocks of _BLOCK_STRANDS, and a
+// "tile" is one block against another. Inside a tile the strands are compared
+// one slice of _SLICE_BASES positions at a time, so the slices of both blocks
+// (a few hundred KB) stay in cache while every pair in the tile uses them.
+// Tiles are handed out to the threads from a shared counter.
+//
+// Similarity is the same as strandSimilarity: matching positions / length.
+// Strands of different lengths have similarity 0 (strandSimilarity refuses them).
+//
+// With a cutoff above 0, a pair is dropped as soon as even all-matching
+// remaining bases could not bring it up to the cutoff. Dropped pairs are
+// stored as 0 in the dense matrix and left out of the sparse list.
+
+struct SimilarityPair {
+    int first;
+    int second;
+    double similarity;
+};
+
+class SimilarityMatrix {
+private:
+    static constexpr int _BLOCK_STRANDS = 32;
+    static constexpr int _SLICE_BASES = 2048;
+
+    int _count;
+    bool _dense;
+    vector<float> _values;           // _count x _count, row by row (dense only)
+    vector<SimilarityPair> _pairs;   // first < second, sorted (sparse only)
+
+public:
+    SimilarityMatrix();
+
+    // dense = true: keep every value; false: keep only pairs at or above 'cutoff'
+    void compute(const vector<string>& strands, double cutoff, bool dense, int threadCount);
+
+    int size() const;
+    bool isDense() const;
+    // Dense only (1 on the diagonal)
+    double get(int first, int second) const;
+    const vector<SimilarityPair>& getPairs() const;
+
+    // Dense: a tab separated table with names on both edges; sparse: one pair per line
+    void print(const vector<string>& names, ostream& out) const;
+};
+
+// Command line helper: reads a strand file (see StrandIO.h) and prints the
+// dense matrix (cutoff 0) or the pairs at or above 'cutoff'. Returns the exit code
+int printSimilarityMatrix(const char strandFile[], double cutoff, int threadCount, ostream& out);
+
+#endif
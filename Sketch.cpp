@@ -0,0 +1,291 @@
+#include "Sketch.h"
+#include "Bits.h"
+#include "Random.h"
+#include "StrandIO.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+using namespace std;
+
+// =========================== HyperLogLog ===========================
+
+HyperLogLog::HyperLogLog() {
+    _registers.assign(1 << HLL_BITS, 0);
+}
+
+void HyperLogLog::add(unsigned long long hash) {
+    // The top bits pick a register, which remembers the longest run of
+    // leading zeros seen in the remaining bits
+    int index = hash >> (64 - HLL_BITS);
+    unsigned long long rest = (hash << HLL_BITS) | (1ULL << (HLL_BITS - 1));
+    unsigned char rank = leadingZeros(rest) + 1;
+    if (rank > _registers[index]) {
+        _registers[index] = rank;
+    }
+}
+
+void HyperLogLog::merge(const HyperLogLog& other) {
+    for (size_t i = 0; i < _registers.size(); i++) {
+        _registers[i] = max(_registers[i], other._registers[i]);
+    }
+}
+
+double HyperLogLog::estimate() const {
+    double m = _registers.size();
+    double sum = 0;
+    int zeros = 0;
+    for (size_t i = 0; i < _registers.size(); i++) {
+        sum += ldexp(1.0, -_registers[i]);
+        if (_registers[i] == 0) {
+            zeros++;
+        }
+    }
+    double alpha = 0.7213 / (1 + 1.079 / m);
+    double estimate = alpha * m * m / sum;
+    // Few distinct values: counting the empty registers is more accurate
+    if (estimate <= 2.5 * m && zeros > 0) {
+        estimate = m * log(m / zeros);
+    }
+    return estimate;
+}
+
+const vector<unsigned char>& HyperLogLog::getRegisters() const {
+    return _registers;
+}
+
+void HyperLogLog::setRegisters(const vector<unsigned char>& registers) {
+    if (registers.size() == _registers.size()) {
+        _registers = registers;
+    }
+}
+
+// =========================== Sketching ===========================
+
+// Sorts the candidate hashes, drops repeats and keeps the 'size' smallest
+static void trimBottom(vector<unsigned long long>& hashes, int size) {
+    sort(hashes.begin(), hashes.end());
+    hashes.erase(unique(hashes.begin(), hashes.end()), hashes.end());
+    if ((int)hashes.size() > size) {
+        hashes.resize(size);
+    }
+}
+
+StrandSketch sketchStrand(const string& name, string_view strand, int k, int size) {
+    StrandSketch sketch;
+    sketch.name = name;
+    sketch.k = max(1, min(k, 32));
+    sketch.size = max(1, size);
+    sketch.length = strand.size();
+    k = sketch.k;
+
+    unsigned long long mask = (k == 32) ? ~0ULL : ((1ULL << (2 * k)) - 1);
+    int topShift = 2 * (k - 1);
+    unsigned long long forward = 0;
+    unsigned long long reverse = 0;
+    int valid = 0;   // bases since the last non-ACGT character
+
+    // Hashes below 'threshold' might be in the bottom-k. Candidates collect in
+    // a buffer that is trimmed whenever it doubles, so most k-mers cost one compare
+    unsigned long long threshold = ~0ULL;
+    vector<unsigned long long>& hashes = sketch.hashes;
+    hashes.reserve(2 * sketch.size);
+
+    for (size_t i = 0; i < strand.size(); i++) {
+        int code = baseCode(strand[i]);
+        if (code < 0) {
+            valid = 0;
+            continue;
+        }
+        // Slide the window: new base enters on the right of the forward k-mer
+        // and (complemented) on the left of the reverse one
+        forward = ((forward << 2) | code) & mask;
+        reverse = (reverse >> 2) | ((unsigned long long)(3 - code) << topShift);
+        valid++;
+        if (valid < k) {
+            continue;
+        }
+
+        unsigned long long hash = splitMix64(min(forward, reverse));
+        sketch.distinct.add(hash);
+        if (hash < threshold) {
+            hashes.push_back(hash);
+            if ((int)hashes.size() >= 2 * sketch.size) {
+                trimBottom(hashes, sketch.size);
+                if ((int)hashes.size() == sketch.size) {
+                    threshold = hashes.back();
+                }
+            }
+        }
+    }
+    trimBottom(hashes, sketch.size);
+    return sketch;
+}
+
+// =========================== Comparing ===========================
+
+double estimateJaccard(const StrandSketch& a, const StrandSketch& b) {
+    if (a.k != b.k) {
+        return 0;
+    }
+    // Walk the bottom of the union (both lists are sorted) and count how many
+    // of its smallest hashes appear in both sketches
+    int limit = min(a.size, b.size);
+    size_t i = 0;
+    size_t j = 0;
+    int seen = 0;
+    int shared = 0;
+    while (seen < limit && (i < a.hashes.size() || j < b.hashes.size())) {
+        if (j == b.hashes.size() || (i < a.hashes.size() && a.hashes[i] < b.hashes[j])) {
+            i++;
+        } else if (i == a.hashes.size() || b.hashes[j] < a.hashes[i]) {
+            j++;
+        } else {
+            shared++;
+            i++;
+            j++;
+        }
+        seen++;
+    }
+    if (seen == 0) {
+        return 0;
+    }
+    return (double)shared / seen;
+}
+
+double estimateContainment(const StrandSketch& a, const StrandSketch& b) {
+    // |A and B| = J * |A or B| and |A or B| = (|A| + |B|) / (1 + J)
+    double jaccard = estimateJaccard(a, b);
+    double sizeA = a.distinct.estimate();
+    double sizeB = b.distinct.estimate();
+    if (sizeA < 1) {
+        return 0;
+    }
+    double containment = jaccard * (sizeA + sizeB) / ((1 + jaccard) * sizeA);
+    return min(containment, 1.0);
+}
+
+double estimateDistance(const StrandSketch& a, const StrandSketch& b) {
+    double jaccard = estimateJaccard(a, b);
+    if (jaccard <= 0) {
+        return 1;
+    }
+    return max(0.0, min(1.0, -log(2 * jaccard / (1 + jaccard)) / a.k));
+}
+
+// =========================== Sketch files ===========================
+
+// Layout (native byte order, like the journal):
+//   "GSK1", sketch count (uint32)
+//   per sketch: name length (uint32) + name, k (int32), size (int32),
+//               length (int64), hash count (uint32) + hashes (uint64 each),
+//               4096 HyperLogLog registers (one byte each)
+
+static const char SKETCH_MAGIC[4] = {'G', 'S', 'K', '1'};
+
+bool saveSketches(const char filename[], const vector<StrandSketch>& sketches) {
+    ofstream fout(filename, ios::binary | ios::trunc);
+    if (!fout.is_open()) {
+        return false;
+    }
+    fout.write(SKETCH_MAGIC, 4);
+    writeValue<unsigned int>(fout, sketches.size());
+    for (size_t s = 0; s < sketches.size(); s++) {
+        const StrandSketch& sketch = sketches[s];
+        writeValue<unsigned int>(fout, sketch.name.size());
+        fout.write(sketch.name.data(), sketch.name.size());
+        writeValue<int>(fout, sketch.k);
+        writeValue<int>(fout, sketch.size);
+        writeValue<long long>(fout, sketch.length);
+        writeValue<unsigned int>(fout, sketch.hashes.size());
+        fout.write((const char*)sketch.hashes.data(), sketch.hashes.size() * sizeof(unsigned long long));
+        const vector<unsigned char>& registers = sketch.distinct.getRegisters();
+        fout.write((const char*)registers.data(), registers.size());
+    }
+    return fout.good();
+}
+
+bool loadSketches(const char filename[], vector<StrandSketch>& sketches) {
+    ifstream fin(filename, ios::binary);
+    char magic[4];
+    unsigned int count;
+    if (!fin.read(magic, 4) || memcmp(magic, SKETCH_MAGIC, 4) != 0 || !readValue(fin, count)) {
+        return false;
+    }
+    vector<unsigned char> registers(1 << HLL_BITS);
+    for (unsigned int s = 0; s < count; s++) {
+        StrandSketch sketch;
+        unsigned int nameLength;
+        unsigned int hashCount;
+        if (!readValue(fin, nameLength) || nameLength > (1 << 20)) {
+            return false;
+        }
+        sketch.name.resize(nameLength);
+        fin.read(&sketch.name[0], nameLength);
+        if (!readValue(fin, sketch.k) || !readValue(fin, sketch.size) ||
+            !readValue(fin, sketch.length) || !readValue(fin, hashCount) ||
+            sketch.k < 1 || sketch.k > 32 || hashCount > (unsigned int)sketch.size) {
+            return false;
+        }
+        sketch.hashes.resize(hashCount);
+        fin.read((char*)sketch.hashes.data(), hashCount * sizeof(unsigned long long));
+        fin.read((char*)registers.data(), registers.size());
+        if (!fin) {
+            return false;
+        }
+        sketch.distinct.setRegisters(registers);
+        sketches.push_back(sketch);
+    }
+    return true;
+}
+
+// =========================== Command line tools ===========================
+
+int sketchStrandFile(const char strandFile[], const char sketchFile[], ostream& out) {
+    vector<string> names;
+    vector<string> strands;
+    if (!readStrands(strandFile, names, strands)) {
+        out << "Error: could not read " << strandFile << endl;
+        return 1;
+    }
+    vector<StrandSketch> sketches;
+    for (size_t s = 0; s < strands.size(); s++) {
+        sketches.push_back(sketchStrand(names[s], strands[s]));
+        out << names[s] << ": " << strands[s].size() << " bases, about "
+            << (long long)sketches.back().distinct.estimate() << " distinct " << SKETCH_DEFAULT_K << "-mers" << endl;
+    }
+    if (!saveSketches(sketchFile, sketches)) {
+        out << "Error: could not write " << sketchFile << endl;
+        return 1;
+    }
+    out << "Saved " << sketches.size() << " sketches to " << sketchFile << endl;
+    return 0;
+}
+
+int printRelatedStrands(const char sketchFile[], double minJaccard, ostream& out) {
+    vector<StrandSketch> sketches;
+    if (!loadSketches(sketchFile, sketches)) {
+        out << "Error: could not read sketches from " << sketchFile << endl;
+        return 1;
+    }
+    out << fixed << setprecision(4);
+    int pairs = 0;
+    for (size_t a = 0; a < sketches.size(); a++) {
+        for (size_t b = a + 1; b < sketches.size(); b++) {
+            double jaccard = estimateJaccard(sketches[a], sketches[b]);
+            if (jaccard < minJaccard) {
+                continue;
+            }
+            out << sketches[a].name << "\t" << sketches[b].name
+                << "\tjaccard " << jaccard
+                << "\tcontainment " << estimateContainment(sketches[a], sketches[b])
+                << "\tdistance " << estimateDistance(sketches[a], sketches[b]) << endl;
+            pairs++;
+        }
+    }
+    out << pairs << " related pairs" << endl;
+    return 0;
+}
@@ -0,0 +1,79 @@
+#ifndef SKETCH_H
+#define SKETCH_H
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// Small fixed-size summaries of long strands for quick, approximate comparison
+//
+// A strand is cut into every overlapping k-mer (run of k bases). A k-mer and
+// its reverse complement (the same stretch read on the other DNA strand) are
+// treated as one: we hash whichever 2-bit encoding is smaller ("canonical").
+// K-mers containing anything other than A, C, G, T are skipped.
+//
+// Two sketches are kept per strand:
+//  - MinHash (bottom-k): the 'size' smallest distinct k-mer hashes. Two strands
+//    share about the same fraction of their smallest hashes as of all k-mers,
+//    which estimates the Jaccard similarity |A and B| / |A or B|.
+//  - HyperLogLog: 2^12 one-byte registers that estimate how many distinct
+//    k-mers a strand has (within about 2%), used for containment |A and B| / |A|.
+//
+// Sketching reads each base once; comparing two sketches costs a few
+// microseconds no matter how long the strands were. Sketches can be saved to
+// a file and compared later without the strands.
+
+const int SKETCH_DEFAULT_K = 21;         // k-mer length (at most 32)
+const int SKETCH_DEFAULT_SIZE = 1000;    // hashes kept per MinHash sketch
+const int HLL_BITS = 12;                 // 4096 registers
+
+class HyperLogLog {
+private:
+    vector<unsigned char> _registers;
+
+public:
+    HyperLogLog();
+
+    void add(unsigned long long hash);
+    void merge(const HyperLogLog& other);
+    double estimate() const;
+
+    const vector<unsigned char>& getRegisters() const;
+    void setRegisters(const vector<unsigned char>& registers);
+};
+
+struct StrandSketch {
+    string name;
+    int k;
+    int size;
+    long long length;                 // bases in the strand
+    vector<unsigned long long> hashes;  // bottom-k hashes, sorted ascending
+    HyperLogLog distinct;
+};
+
+// Builds both sketches in one pass over the strand
+StrandSketch sketchStrand(const string& name, string_view strand,
+                          int k = SKETCH_DEFAULT_K, int size = SKETCH_DEFAULT_SIZE);
+
+// Estimated Jaccard similarity (0 = nothing shared, 1 = same k-mers)
+// Both sketches must use the same k
+double estimateJaccard(const StrandSketch& a, const StrandSketch& b);
+// Estimated fraction of a's k-mers that are also in b
+double estimateContainment(const StrandSketch& a, const StrandSketch& b);
+// Mash distance: estimated fraction of differing bases per position, from the Jaccard value
+double estimateDistance(const StrandSketch& a, const StrandSketch& b);
+
+// Binary sketch files (see Sketch.cpp for the layout)
+bool saveSketches(const char filename[], const vector<StrandSketch>& sketches);
+bool loadSketches(const char filename[], vector<StrandSketch>& sketches);
+
+// Command line helpers (return the exit code)
+// Sketches every strand in a strand file (see StrandIO.h) and saves the sketches
+int sketchStrandFile(const char strandFile[], const char sketchFile[], ostream& out);
+// Prints every pair of sketches whose estimated Jaccard similarity is at least 'minJaccard'
+int printRelatedStrands(const char sketchFile[], double minJaccard, ostream& out);
+
+#endif
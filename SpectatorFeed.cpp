@@ -0,0 +1,224 @@
+#include "SpectatorFeed.h"
+
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Shared-memory layout. magic and size let a reader check that the segment
+// really is a spectator feed of this version before trusting the snapshot.
+struct SpectatorSegment {
+    unsigned magic;
+    unsigned size;
+    atomic<unsigned> sequence;   // odd while the game is writing
+    SpectatorSnapshot snapshot;
+};
+
+static const unsigned SPECTATOR_MAGIC = 0x47454e31;   // "GEN1"
+
+// The sequence counter is shared between processes, so it must not need a lock
+static_assert(atomic<unsigned>::is_always_lock_free, "seqlock counter must be lock-free");
+
+#ifdef _WIN32
+
+// No POSIX shared memory: the feed is simply unavailable
+SpectatorFeed::SpectatorFeed() { _segment = nullptr; _name[0] = '\0'; }
+SpectatorFeed::~SpectatorFeed() {}
+bool SpectatorFeed::open(const char name[]) { return false; }
+void SpectatorFeed::close() {}
+bool SpectatorFeed::isOpen() const { return false; }
+void SpectatorFeed::publish(const SpectatorSnapshot& snapshot) {}
+
+SpectatorView::SpectatorView() { _segment = nullptr; }
+SpectatorView::~SpectatorView() {}
+bool SpectatorView::open(const char name[]) { return false; }
+void SpectatorView::close() {}
+bool SpectatorView::read(SpectatorSnapshot& snapshot) const { return false; }
+
+#else
+
+SpectatorFeed::SpectatorFeed() {
+    _segment = nullptr;
+    _name[0] = '\0';
+}
+
+SpectatorFeed::~SpectatorFeed() {
+    close();
+}
+
+bool SpectatorFeed::open(const char name[]) {
+    close();
+    if (strlen(name) >= sizeof(_name)) {
+        return false;
+    }
+
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    if (ftruncate(fd, sizeof(SpectatorSegment)) != 0) {
+        ::close(fd);
+        shm_unlink(name);
+        return false;
+    }
+    void* map = mmap(0, sizeof(SpectatorSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        shm_unlink(name);
+        return false;
+    }
+
+    // A new segment is all zeros: sequence 0 (even) and an empty snapshot
+    _segment = new (map) SpectatorSegment();
+    _segment->size = sizeof(SpectatorSegment);
+    _segment->magic = SPECTATOR_MAGIC;
+    strcpy(_name, name);
+    return true;
+}
+
+void SpectatorFeed::close() {
+    if (_segment == nullptr) {
+        return;
+    }
+    munmap(_segment, sizeof(SpectatorSegment));
+    shm_unlink(_name);
+    _segment = nullptr;
+    _name[0] = '\0';
+}
+
+bool SpectatorFeed::isOpen() const {
+    return _segment != nullptr;
+}
+
+void SpectatorFeed::publish(const SpectatorSnapshot& snapshot) {
+    if (_segment == nullptr) {
+        return;
+    }
+    // Only this process writes, so a relaxed load of our own counter is enough
+    unsigned sequence = _segment->sequence.load(memory_order_relaxed);
+    _segment->sequence.store(sequence + 1, memory_order_relaxed);
+    // The odd number must be visible before any of the new bytes
+    atomic_thread_fence(memory_order_release);
+    memcpy(&_segment->snapshot, &snapshot, sizeof(SpectatorSnapshot));
+    _segment->sequence.store(sequence + 2, memory_order_release);
+}
+
+SpectatorView::SpectatorView() {
+    _segment = nullptr;
+}
+
+SpectatorView::~SpectatorView() {
+    close();
+}
+
+bool SpectatorView::open(const char name[]) {
+    close();
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size != (off_t)sizeof(SpectatorSegment)) {
+        ::close(fd);
+        return false;
+    }
+    void* map = mmap(0, sizeof(SpectatorSegment), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+
+    const SpectatorSegment* segment = (const SpectatorSegment*)map;
+    if (segment->magic != SPECTATOR_MAGIC || segment->size != sizeof(SpectatorSegment)) {
+        munmap(map, sizeof(SpectatorSegment));
+        return false;
+    }
+    _segment = segment;
+    return true;
+}
+
+void SpectatorView::close() {
+    if (_segment != nullptr) {
+        munmap((void*)_segment, sizeof(SpectatorSegment));
+        _segment = nullptr;
+    }
+}
+
+bool SpectatorView::read(SpectatorSnapshot& snapshot) const {
+    if (_segment == nullptr) {
+        return false;
+    }
+    const SpectatorSegment* segment = _segment;
+
+    for (int attempt = 0; attempt < 100; attempt++) {
+        unsigned before = segment->sequence.load(memory_order_acquire);
+        if (before % 2 == 1) {
+            // The game is in the middle of a write
+            this_thread::yield();
+            continue;
+        }
+        memcpy(&snapshot, &segment->snapshot, sizeof(SpectatorSnapshot));
+        // The copy must be finished before the counter is checked again
+        atomic_thread_fence(memory_order_acquire);
+        unsigned after = segment->sequence.load(memory_order_relaxed);
+        if (before == after) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#endif
+
+int watchGame(const char name[], ostream& out) {
+    SpectatorView view;
+
+    // Wait (up to about a minute) for the game to start publishing
+    out << "Waiting for game " << name << "..." << endl;
+    int waited = 0;
+    while (!view.open(name)) {
+        if (waited++ > 600) {
+            out << "Error: no game is publishing to " << name << endl;
+            return 1;
+        }
+        this_thread::sleep_for(chrono::milliseconds(100));
+    }
+
+    const char* pathNames[2] = {"Fellowship", "Direct Lab"};
+    int lastTurn = -1;
+    SpectatorSnapshot snapshot;
+    memset(&snapshot, 0, sizeof(snapshot));
+    while (true) {
+        // boardSize stays 0 until the game publishes its first snapshot
+        if (view.read(snapshot) && snapshot.state.boardSize > 0 && snapshot.turn != lastTurn) {
+            lastTurn = snapshot.turn;
+            const GameState& state = snapshot.state;
+            out << "\n--- Turn " << snapshot.turn << " ---\n";
+            for (int i = 0; i < 2; i++) {
+                const PlayerState& p = state.players[i];
+                int pos = state.positions[i];
+                char color = (pos >= 0 && pos < SPECTATOR_MAX_TILES) ? snapshot.tileColors[i][pos] : '?';
+                out << "Player " << (i + 1) << " (" << snapshot.names[i] << ", "
+                    << pathNames[p.pathType == 1 ? 1 : 0] << "): tile " << pos << "/"
+                    << state.boardSize - 1 << " [" << color << "]  DP " << p.discoverPoints
+                    << "  Acc " << p.accuracy << "  Eff " << p.efficiency
+                    << "  Ins " << p.insight << "\n";
+            }
+            out.flush();
+        }
+        if (snapshot.gameOver) {
+            out << "\nGame over.\n";
+            return 0;
+        }
+        this_thread::sleep_for(chrono::milliseconds(50));
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef SPECTATORFEED_H
+#define SPECTATORFEED_H
+
+#include "GameState.h"
+
+#include <atomic>
+#include <iostream>
+#include <type_traits>
+
+using namespace std;
+
+// Live view of a running game for other processes on the same machine
+//
+// The game publishes a snapshot (positions, tile colors, player stats) into a
+// POSIX shared-memory segment after every turn. The snapshot is guarded by a
+// seqlock: the writer makes the sequence number odd, copies the snapshot in,
+// and makes it even again. A reader copies the snapshot out and keeps it only
+// if the sequence was the same even number before and after. Readers never
+// write to the segment, so any number of them can watch without slowing the game.
+
+// Longest board whose tile colors fit in a snapshot
+const int SPECTATOR_MAX_TILES = 128;
+
+struct SpectatorSnapshot {
+    GameState state;                                 // positions and stats (see GameState.h)
+    char names[2][32];                               // player names (empty before they pick)
+    char tileColors[2][SPECTATOR_MAX_TILES];         // color letter of each tile (see Board.h)
+    int turn;                                        // turns played so far
+    int gameOver;                                    // 1 once the game has ended
+};
+
+static_assert(std::is_trivially_copyable<SpectatorSnapshot>::value,
+              "SpectatorSnapshot must be trivially copyable");
+
+// Layout of the shared memory (see SpectatorFeed.cpp)
+struct SpectatorSegment;
+
+// The game's side: creates the segment and publishes snapshots
+class SpectatorFeed {
+private:
+    SpectatorSegment* _segment;
+    char _name[64];
+
+public:
+    SpectatorFeed();
+    ~SpectatorFeed();
+
+    SpectatorFeed(const SpectatorFeed&) = delete;
+    SpectatorFeed& operator=(const SpectatorFeed&) = delete;
+
+    // Name like "/genome" (see shm_open); returns false if shared memory can't be set up
+    bool open(const char name[]);
+    // Removes the segment (readers that already have it mapped keep their last snapshot)
+    void close();
+    bool isOpen() const;
+
+    // Copies the snapshot in under the seqlock: one memcpy and two atomic stores
+    void publish(const SpectatorSnapshot& snapshot);
+};
+
+// A spectator's side: maps an existing segment read-only
+class SpectatorView {
+private:
+    const SpectatorSegment* _segment;
+
+public:
+    SpectatorView();
+    ~SpectatorView();
+
+    SpectatorView(const SpectatorView&) = delete;
+    SpectatorView& operator=(const SpectatorView&) = delete;
+
+    bool open(const char name[]);
+    void close();
+
+    // Copies out a consistent snapshot; returns false if the game kept
+    // writing during every attempt (try again a moment later)
+    bool read(SpectatorSnapshot& snapshot) const;
+};
+
+// Watches the feed 'name' and prints each new turn to 'out' until the game ends
+int watchGame(const char name[], ostream& out);
+
+#endif
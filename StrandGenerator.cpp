@@ -0,0 +1,300 @@
+#include "StrandGenerator.h"
+#include "Random.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <fstream>
+#include <thread>
+
+using namespace std;
+
+static const char BASES[4] = {'A', 'C', 'G', 'T'};
+
+GeneratorSettings defaultGeneratorSettings() {
+    GeneratorSettings settings;
+    settings.count = 1000;
+    settings.length = 10000;
+    settings.gcContent = 0.41;   // about the human genome average
+    settings.substitutionRate = 0.01;
+    settings.insertionRate = 0.001;
+    settings.deletionRate = 0.001;
+    settings.homopolymerRate = 0.01;
+    settings.seed = 1300;
+    settings.packed = false;
+    settings.threadCount = thread::hardware_concurrency();
+    return settings;
+}
+
+// =========================== Random helpers ===========================
+
+// Uniform double in [0, 1)
+static double nextUniform(unsigned long long& state) {
+    return (nextRandom(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Bases until the next event that happens with probability 'rate' per base
+static long long nextGap(unsigned long long& state, double rate) {
+    if (rate <= 0) {
+        return LLONG_MAX / 2;
+    }
+    if (rate >= 1) {
+        return 0;
+    }
+    double gap = floor(log1p(-nextUniform(state)) / log1p(-rate));
+    return gap < 1e18 ? (long long)gap : LLONG_MAX / 2;
+}
+
+// 16 random bits -> one base: 15 bits against the GC threshold, 1 bit picks
+// G or C (or A or T)
+static inline char randomBase(unsigned int bits, unsigned int gcThreshold) {
+    int gc = (bits >> 1) < gcThreshold;
+    int pick = bits & 1;
+    // gc: C or G (1, 2); otherwise A or T (0, 3)
+    return BASES[gc ? 1 + pick : 3 * pick];
+}
+
+// A C G T -> 0 1 2 3 without branches (random bases would fool the branch
+// predictor). Bits 1-2 of the letters are 0 1 3 2, the XOR swaps G and T
+static inline int baseIndex(char base) {
+    int bits = (base >> 1) & 3;
+    return bits ^ (bits >> 1);
+}
+
+// =========================== One pair ===========================
+
+void generateStrandPair(const GeneratorSettings& settings, long long index, string& reference,
+                        string& query, vector<StrandEdit>& edits) {
+    unsigned long long state = mixKey(settings.seed, index);
+    unsigned int gcThreshold = (unsigned int)(min(max(settings.gcContent, 0.0), 1.0) * 32768);
+    long long length = max(settings.length, 0LL);
+
+    // Reference: four bases per random number
+    reference.resize(length);
+    long long i = 0;
+    for (; i + 4 <= length; i += 4) {
+        unsigned long long bits = nextRandom(state);
+        reference[i] = randomBase(bits & 0xFFFF, gcThreshold);
+        reference[i + 1] = randomBase((bits >> 16) & 0xFFFF, gcThreshold);
+        reference[i + 2] = randomBase((bits >> 32) & 0xFFFF, gcThreshold);
+        reference[i + 3] = randomBase(bits >> 48, gcThreshold);
+    }
+    for (; i < length; i++) {
+        reference[i] = randomBase(nextRandom(state) & 0xFFFF, gcThreshold);
+    }
+
+    // Point edits: jump straight from one to the next
+    edits.clear();
+    double pointRate = settings.substitutionRate + settings.insertionRate + settings.deletionRate;
+    for (long long p = nextGap(state, pointRate); p < length; p += 1 + nextGap(state, pointRate)) {
+        double kind = nextUniform(state) * pointRate;
+        char from = reference[p];
+        if (kind < settings.substitutionRate) {
+            int changed = (baseIndex(from) + 1 + nextRandom(state) % 3) & 3;
+            edits.push_back({p, 'S', from, BASES[changed]});
+        } else if (kind < settings.substitutionRate + settings.insertionRate) {
+            edits.push_back({p, 'I', '-', randomBase(nextRandom(state) & 0xFFFF, gcThreshold)});
+        } else {
+            edits.push_back({p, 'D', from, '-'});
+        }
+    }
+
+    // Homopolymer edits: at the last base of runs of 3 or more, every so many runs
+    vector<StrandEdit> runEdits;
+    long long runsToSkip = nextGap(state, settings.homopolymerRate);
+    long long runStart = 0;
+    for (long long p = 1; p <= length; p++) {
+        if (p < length && reference[p] == reference[runStart]) {
+            continue;
+        }
+        if (p - runStart >= 3) {
+            if (runsToSkip == 0) {
+                char base = reference[p - 1];
+                if (nextRandom(state) & 1) {
+                    runEdits.push_back({p - 1, 'H', '-', base});
+                } else {
+                    runEdits.push_back({p - 1, 'H', base, '-'});
+                }
+                runsToSkip = nextGap(state, settings.homopolymerRate);
+            } else {
+                runsToSkip--;
+            }
+        }
+        runStart = p;
+    }
+    if (runEdits.size() > 0) {
+        vector<StrandEdit> merged(edits.size() + runEdits.size());
+        merge(edits.begin(), edits.end(), runEdits.begin(), runEdits.end(), merged.begin(),
+              [](const StrandEdit& a, const StrandEdit& b) { return a.position < b.position; });
+        edits.swap(merged);
+    }
+
+    // Query: copy the stretches between edits. Only the first edit at a
+    // position is used (and kept in the list)
+    query.clear();
+    query.reserve(length + length / 16 + 16);
+    long long copied = 0;
+    size_t kept = 0;
+    for (size_t e = 0; e < edits.size(); e++) {
+        StrandEdit edit = edits[e];
+        if (edit.position < copied) {
+            continue;
+        }
+        query.append(reference, copied, edit.position - copied);
+        if (edit.type == 'S') {
+            query += edit.to;
+        } else if (edit.to != '-') {
+            // Insertions (and longer homopolymers) come after the reference base
+            query += reference[edit.position];
+            query += edit.to;
+        }
+        copied = edit.position + 1;
+        edits[kept] = edit;
+        kept++;
+    }
+    edits.resize(kept);
+    query.append(reference, copied, length - copied);
+}
+
+// =========================== Output formats ===========================
+
+static void appendFasta(string& out, const string& name, const string& strand) {
+    out += '>';
+    out += name;
+    out += '\n';
+    for (size_t i = 0; i < strand.size(); i += 80) {
+        out.append(strand, i, 80);
+        out += '\n';
+    }
+}
+
+static void appendPacked(string& out, const string& name, const string& strand) {
+    unsigned int nameLength = name.size();
+    unsigned long long count = strand.size();
+    out.append((const char*)&nameLength, sizeof(nameLength));
+    out += name;
+    out.append((const char*)&count, sizeof(count));
+    size_t start = out.size();
+    out.resize(start + (count + 3) / 4, 0);
+    for (size_t i = 0; i < count; i += 4) {
+        unsigned char packed = 0;
+        for (size_t j = 0; j < 4 && i + j < count; j++) {
+            packed |= baseIndex(strand[i + j]) << (2 * j);
+        }
+        out[start + i / 4] = packed;
+    }
+}
+
+void writePackedStrand(ostream& out, const string& name, const string& strand) {
+    string record;
+    appendPacked(record, name, strand);
+    out.write(record.data(), record.size());
+}
+
+static void appendEdits(string& out, long long pair, const vector<StrandEdit>& edits) {
+    for (size_t e = 0; e < edits.size(); e++) {
+        out += to_string(pair);
+        out += '\t';
+        out += to_string(edits[e].position);
+        out += '\t';
+        out += edits[e].type;
+        out += '\t';
+        out += edits[e].from;
+        out += '\t';
+        out += edits[e].to;
+        out += '\n';
+    }
+}
+
+// =========================== Files ===========================
+
+int generateStrandFiles(const string& prefix, const GeneratorSettings& settings, ostream& log) {
+    string extension = settings.packed ? ".gpk" : ".fa";
+    ios::openmode mode = ios::binary | ios::trunc;
+    ofstream referenceFile(prefix + ".ref" + extension, mode);
+    ofstream queryFile(prefix + ".query" + extension, mode);
+    ofstream truthFile(prefix + ".truth.tsv", mode);
+    if (!referenceFile.is_open() || !queryFile.is_open() || !truthFile.is_open()) {
+        log << "Error: could not create the " << prefix << ".* files" << endl;
+        return 1;
+    }
+    if (settings.packed) {
+        referenceFile.write("GPK1", 4);
+        queryFile.write("GPK1", 4);
+    }
+    truthFile << "pair\tposition\ttype\tfrom\tto\n";
+
+    int threadCount = max(settings.threadCount, 1);
+    // About 32 MB per batch. A pair costs more than its bases: three strings
+    // (reference, query, truth lines), two names and FASTA headers, and a
+    // newline every 80 bases, which is most of it for short strands
+    long long length = max(settings.length, 1LL);
+    long long pairBytes = 3 * (long long)sizeof(string) + 2 * (length + length / 80 + 32);
+    long long batchPairs = max(1LL, min(settings.count, (32LL << 20) / pairBytes));
+    vector<string> references(batchPairs);
+    vector<string> queries(batchPairs);
+    vector<string> truths(batchPairs);
+
+    auto started = chrono::steady_clock::now();
+    long long bytes = 0;
+    long long editCount = 0;
+    for (long long first = 0; first < settings.count; first += batchPairs) {
+        long long count = min(batchPairs, settings.count - first);
+        atomic<long long> next(0);
+        atomic<long long> batchEdits(0);
+        vector<thread> workers;
+        for (int t = 0; t < threadCount; t++) {
+            workers.push_back(thread([&]() {
+                string reference;
+                string query;
+                vector<StrandEdit> edits;
+                long long found = 0;
+                for (long long k = next.fetch_add(1); k < count; k = next.fetch_add(1)) {
+                    long long pair = first + k;
+                    generateStrandPair(settings, pair, reference, query, edits);
+                    string refName = "ref" + to_string(pair + 1);
+                    string queryName = "query" + to_string(pair + 1);
+                    references[k].clear();
+                    queries[k].clear();
+                    truths[k].clear();
+                    if (settings.packed) {
+                        appendPacked(references[k], refName, reference);
+                        appendPacked(queries[k], queryName, query);
+                    } else {
+                        appendFasta(references[k], refName, reference);
+                        appendFasta(queries[k], queryName, query);
+                    }
+                    appendEdits(truths[k], pair + 1, edits);
+                    found += edits.size();
+                }
+                batchEdits += found;
+            }));
+        }
+        for (int t = 0; t < threadCount; t++) {
+            workers[t].join();
+        }
+        for (long long k = 0; k < count; k++) {
+            referenceFile.write(references[k].data(), references[k].size());
+            queryFile.write(queries[k].data(), queries[k].size());
+            truthFile.write(truths[k].data(), truths[k].size());
+            bytes += references[k].size() + queries[k].size() + truths[k].size();
+        }
+        editCount += batchEdits;
+    }
+    referenceFile.close();
+    queryFile.close();
+    truthFile.close();
+    if (!referenceFile || !queryFile || !truthFile) {
+        log << "Error: could not write the " << prefix << ".* files" << endl;
+        return 1;
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    log << "Wrote " << settings.count << " strand pairs (" << editCount << " edits) to "
+        << prefix << ".ref" << extension << ", " << prefix << ".query" << extension
+        << " and " << prefix << ".truth.tsv: " << bytes / 1000000.0 << " MB in " << seconds
+        << " s" << endl;
+    return 0;
+}
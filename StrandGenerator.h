@@ -0,0 +1,67 @@
+#ifndef STRANDGENERATOR_H
+#define STRANDGENERATOR_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Makes test inputs for the DNA tasks: random reference strands plus
+// "query" strands copied from them with mistakes, and a list of every mistake
+//
+// Mutation model (rates are per reference base unless noted):
+//  - substitution: the base is replaced by one of the other three
+//  - insertion:    a random base is added after the base
+//  - deletion:     the base is left out
+//  - homopolymer:  per run of 3 or more equal bases (like AAAA); the run
+//                  comes out one base longer or shorter, the usual mistake
+//                  of sequencing machines
+//
+// Edits are rare, so instead of rolling dice for every base the generator
+// draws the distance to the next edit (a geometric distribution) and copies
+// the bases in between in one go. Reference bases are cut from the random
+// numbers 16 bits at a time, four bases per 64-bit number.
+//
+// Every strand pair has its own random stream (seed mixed with the pair's
+// number), so the output is the same whatever the thread count. Threads make
+// batches of pairs and the main thread writes them in order.
+
+struct GeneratorSettings {
+    long long count;          // strand pairs
+    long long length;         // bases per reference strand
+    double gcContent;         // fraction of G and C in references
+    double substitutionRate;
+    double insertionRate;
+    double deletionRate;
+    double homopolymerRate;
+    unsigned long long seed;
+    bool packed;              // 2-bit output instead of FASTA (see writePackedStrand)
+    int threadCount;
+};
+
+GeneratorSettings defaultGeneratorSettings();
+
+// One difference between a reference and its query
+struct StrandEdit {
+    long long position;   // in the reference
+    char type;            // 'S' substitution, 'I' insertion, 'D' deletion, 'H' homopolymer
+    char from;            // reference base ('-' for insertions)
+    char to;              // query base ('-' for deletions)
+};
+
+// Makes reference strand 'index' and its query (same result on any thread)
+void generateStrandPair(const GeneratorSettings& settings, long long index, string& reference,
+                        string& query, vector<StrandEdit>& edits);
+
+// Packed strands: 2 bits per base (A=0 C=1 G=2 T=3), first base in the low
+// bits of the first byte, after a record header:
+//   name length (uint32) + name, base count (uint64), (count + 3) / 4 bytes
+// A packed file starts with "GPK1"
+void writePackedStrand(ostream& out, const string& name, const string& strand);
+
+// Writes <prefix>.ref and <prefix>.query (.fa or .gpk) and <prefix>.truth.tsv
+// Returns the exit code
+int generateStrandFiles(const string& prefix, const GeneratorSettings& settings, ostream& log);
+
+#endif
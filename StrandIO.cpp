@@ -0,0 +1,98 @@
+#include "StrandIO.h"
+#include "DataLoader.h"
+
+#include <fstream>
+
+using namespace std;
+
+// Appends the bases of one line, uppercased, without spaces
+static void appendBases(string& strand, string_view line) {
+    for (size_t i = 0; i < line.size(); i++) {
+        char base = line[i];
+        if (base == ' ' || base == '\t') {
+            continue;
+        }
+        if (base >= 'a' && base <= 'z') {
+            base = base - 'a' + 'A';
+        }
+        strand += base;
+    }
+}
+
+StrandReader::StrandReader() {
+    _lineNumber = 0;
+    _inRecord = false;
+}
+
+bool StrandReader::open(const char filename[]) {
+    _lineNumber = 0;
+    _inRecord = false;
+    _header.clear();
+    return _file.open(filename);
+}
+
+bool StrandReader::next(string& name, string& strand) {
+    strand.clear();
+    string_view line;
+    while (_file.nextLine(line)) {
+        _lineNumber++;
+        if (line.size() > 0 && line[0] == '>') {
+            if (_inRecord) {
+                // This header ends the record before it
+                name.swap(_header);
+                _header.assign(line.substr(1));
+                return true;
+            }
+            _inRecord = true;
+            _header.assign(line.substr(1));
+        } else if (_inRecord) {
+            appendBases(strand, line);
+        } else if (line.size() > 0) {
+            // No header yet: the line is a strand of its own
+            appendBases(strand, line);
+            if (strand.size() > 0) {
+                name = "line" + to_string(_lineNumber);
+                return true;
+            }
+        }
+    }
+    if (_inRecord) {
+        _inRecord = false;
+        name.swap(_header);
+        return true;
+    }
+    return false;
+}
+
+bool readStrands(const char filename[], vector<string>& names, vector<string>& strands) {
+    StrandReader reader;
+    if (!reader.open(filename)) {
+        return false;
+    }
+    string name;
+    string strand;
+    while (reader.next(name, strand)) {
+        names.push_back(name);
+        strands.push_back(strand);
+    }
+    return true;
+}
+
+bool writeStrands(const char filename[], const vector<string>& names,
+                  const vector<string>& strands, int lineWidth) {
+    ofstream fout(filename, ios::binary | ios::trunc);
+    if (!fout.is_open()) {
+        return false;
+    }
+    if (lineWidth < 1) {
+        lineWidth = 80;
+    }
+    for (size_t s = 0; s < strands.size(); s++) {
+        fout << '>' << (s < names.size() ? names[s] : "strand" + to_string(s + 1)) << '\n';
+        for (size_t i = 0; i < strands[s].size(); i += lineWidth) {
+            fout.write(strands[s].data() + i, min((size_t)lineWidth, strands[s].size() - i));
+            fout << '\n';
+        }
+    }
+    return fout.good();
+}
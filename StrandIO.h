@@ -0,0 +1,64 @@
+#ifndef STRANDIO_H
+#define STRANDIO_H
+
+#include "DataLoader.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Reading and writing files of DNA strands
+//
+// FASTA style: a line starting with '>' names the next strand, and every line
+// after it (until the next '>') is part of that strand. Files without any '>'
+// lines hold one strand per non-empty line, named by line number.
+// Bases are stored in uppercase; spaces and tabs are skipped.
+
+bool readStrands(const char filename[], vector<string>& names, vector<string>& strands);
+
+// The same strands one at a time, for files too big to hold all at once
+// (the file is memory-mapped, so only the strand being read is copied)
+class StrandReader {
+private:
+    DataFile _file;
+    int _lineNumber;
+    bool _inRecord;    // a FASTA header was read and its strand is not finished
+    string _header;    // name of that record
+
+public:
+    StrandReader();
+
+    bool open(const char filename[]);
+    // Fills in the next strand and its name; false at the end of the file
+    bool next(string& name, string& strand);
+};
+// Writes FASTA with 'lineWidth' bases per line
+bool writeStrands(const char filename[], const vector<string>& names,
+                  const vector<string>& strands, int lineWidth = 80);
+
+// 2-bit code for a base, or -1 for anything else (N, gaps, typos)
+// The complement of code c is 3 - c (A<->T, C<->G)
+inline int baseCode(char base) {
+    switch (base) {
+        case 'A': case 'a': return 0;
+        case 'C': case 'c': return 1;
+        case 'G': case 'g': return 2;
+        case 'T': case 't': return 3;
+        default: return -1;
+    }
+}
+
+// One value in native byte order, for the binary sketch and filter files
+template <typename T>
+void writeValue(ofstream& fout, T value) {
+    fout.write((const char*)&value, sizeof(value));
+}
+
+template <typename T>
+bool readValue(ifstream& fin, T& value) {
+    return (bool)fin.read((char*)&value, sizeof(value));
+}
+
+#endif
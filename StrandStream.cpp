@@ -0,0 +1,331 @@
+#include "StrandStream.h"
+#include "DNAUtils.h"
+#include "StrandIO.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+// =========================== StrandStream ===========================
+
+StrandStream::StrandStream() {
+    _chunkBases = 0;
+    _overlap = 0;
+    _stopping = false;
+    _finished = true;
+    _rawPos = 0;
+    _rawEnd = 0;
+    _ended = true;
+    _fasta = false;
+    _inHeader = false;
+    _atLineStart = true;
+    _seenBases = false;
+    _current = -1;
+    _viewStart = 0;
+    _total = 0;
+}
+
+StrandStream::~StrandStream() {
+    close();
+}
+
+bool StrandStream::open(const char filename[], size_t chunkBases, size_t overlap) {
+    close();
+    _file.open(filename, ios::binary);
+    if (!_file.is_open()) {
+        return false;
+    }
+    _chunkBases = max(chunkBases, (size_t)1);
+    _overlap = overlap;
+    for (int k = 0; k < 2; k++) {
+        _chunks[k].bases.assign(_overlap + _chunkBases, 0);
+        _chunks[k].count = 0;
+        _chunks[k].ready = false;
+    }
+    _raw.resize(_READ_SIZE);
+    _rawPos = 0;
+    _rawEnd = 0;
+    _ended = false;
+    _fasta = false;
+    _inHeader = false;
+    _atLineStart = true;
+    _seenBases = false;
+    _stopping = false;
+    _finished = false;
+    _current = -1;
+    _view = string_view();
+    _viewStart = 0;
+    _total = 0;
+    _reader = thread(&StrandStream::readLoop, this);
+    return true;
+}
+
+void StrandStream::close() {
+    if (_reader.joinable()) {
+        {
+            lock_guard<mutex> guard(_lock);
+            _stopping = true;
+        }
+        _changed.notify_all();
+        _reader.join();
+    }
+    if (_file.is_open()) {
+        _file.close();
+    }
+    // Give the memory back right away (the chunks can be large)
+    for (int k = 0; k < 2; k++) {
+        vector<char>().swap(_chunks[k].bases);
+    }
+    vector<char>().swap(_raw);
+}
+
+// Reader thread: fills the two chunks in turn, waiting while the caller holds one
+void StrandStream::readLoop() {
+    int k = 0;
+    while (true) {
+        {
+            unique_lock<mutex> guard(_lock);
+            _changed.wait(guard, [&]() { return _stopping || !_chunks[k].ready; });
+            if (_stopping) {
+                return;
+            }
+        }
+        // The caller never touches a chunk that is not ready, so no lock is needed here
+        size_t count = fillChunk(_chunks[k].bases.data() + _overlap, _chunkBases);
+        {
+            lock_guard<mutex> guard(_lock);
+            _chunks[k].count = count;
+            _chunks[k].ready = true;
+            _finished = _ended;
+        }
+        _changed.notify_all();
+        if (_ended) {
+            return;
+        }
+        k ^= 1;
+    }
+}
+
+// Copies up to 'room' bases of the strand from the file into 'bases'
+// (the same rules as readStrands: headers, line breaks and spaces are skipped)
+size_t StrandStream::fillChunk(char bases[], size_t room) {
+    size_t count = 0;
+    while (count < room && !_ended) {
+        if (_rawPos == _rawEnd) {
+            _file.read(_raw.data(), _raw.size());
+            _rawEnd = _file.gcount();
+            _rawPos = 0;
+            if (_rawEnd == 0) {
+                _ended = true;
+                break;
+            }
+        }
+
+        // Fast path: the rest of a line of bases, copied in one tight loop
+        if (!_inHeader && !(_atLineStart && _raw[_rawPos] == '>')) {
+            size_t limit = min(_rawEnd, _rawPos + (room - count));
+            const char* line = _raw.data() + _rawPos;
+            const char* newline = (const char*)memchr(line, '\n', limit - _rawPos);
+            size_t length = newline != nullptr ? newline - line : limit - _rawPos;
+            if (length > 0) {
+                size_t before = count;
+                for (size_t k = 0; k < length; k++) {
+                    char c = line[k];
+                    // Always write, but only keep real bases (no branch per byte)
+                    bases[count] = (c >= 'a' && c <= 'z') ? c - 'a' + 'A' : c;
+                    count += (c != '\r') & (c != ' ') & (c != '\t');
+                }
+                _seenBases = _seenBases || count > before;
+                _atLineStart = false;
+                _rawPos += length;
+                continue;
+            }
+        }
+
+        char c = _raw[_rawPos];
+        _rawPos++;
+
+        if (c == '\n') {
+            // Without FASTA headers every line is its own strand
+            if (!_fasta && _seenBases) {
+                _ended = true;
+            }
+            _inHeader = false;
+            _atLineStart = true;
+            continue;
+        }
+        if (_atLineStart && c == '>') {
+            // A second header starts the next strand
+            if (_seenBases) {
+                _ended = true;
+                break;
+            }
+            _fasta = true;
+            _inHeader = true;
+        }
+        _atLineStart = false;
+        if (_inHeader || c == '\r' || c == ' ' || c == '\t') {
+            continue;
+        }
+        if (c >= 'a' && c <= 'z') {
+            c = c - 'a' + 'A';
+        }
+        bases[count] = c;
+        count++;
+        _seenBases = true;
+    }
+    return count;
+}
+
+bool StrandStream::nextChunk(string_view& bases, long long& start) {
+    unique_lock<mutex> guard(_lock);
+    if (!_reader.joinable()) {
+        return false;
+    }
+    int next = (_current < 0) ? 0 : (_current ^ 1);
+    _changed.wait(guard, [&]() { return _chunks[next].ready || _finished; });
+    Chunk& chunk = _chunks[next];
+    bool more = chunk.ready && chunk.count > 0;
+
+    size_t carried = 0;
+    if (more && _current >= 0) {
+        // The end of the previous chunk goes in front of the new bases
+        carried = min(_overlap, _view.size());
+        memcpy(chunk.bases.data() + _overlap - carried, _view.data() + _view.size() - carried, carried);
+    }
+    if (_current >= 0) {
+        _chunks[_current].ready = false;
+        _current = -1;
+    }
+    if (!more) {
+        _view = string_view();
+        guard.unlock();
+        _changed.notify_all();
+        return false;
+    }
+
+    _current = next;
+    _view = string_view(chunk.bases.data() + _overlap - carried, carried + chunk.count);
+    _viewStart = _total - carried;
+    _total += chunk.count;
+    guard.unlock();
+    _changed.notify_all();
+
+    bases = _view;
+    start = _viewStart;
+    return true;
+}
+
+long long StrandStream::basesRead() const {
+    return _total;
+}
+
+// =========================== Streamed DNA functions ===========================
+
+long long streamBestStrandMatch(const char inputFile[], const string& target_strand,
+                                ostream& out, size_t chunkBases) {
+    int targetLength = target_strand.length();
+    if (targetLength == 0) {
+        out << "Strands must be non-empty.\n";
+        return -1;
+    }
+    StrandStream input;
+    if (!input.open(inputFile, chunkBases, targetLength - 1)) {
+        out << "Could not read " << inputFile << ".\n";
+        return -1;
+    }
+
+    // Chunks arrive in order and only a strictly better count replaces the
+    // best, so ties go to the earliest start, as in findBestMatch
+    int bestMatches = -1;
+    long long bestIndex = -1;
+    string_view bases;
+    long long chunkStart;
+    while (input.nextChunk(bases, chunkStart)) {
+        StrandMatch best = findBestMatch(bases, target_strand);
+        if (best.matches > bestMatches) {
+            bestMatches = best.matches;
+            bestIndex = chunkStart + best.index;
+        }
+    }
+
+    long long inputLength = input.basesRead();
+    if (inputLength == 0) {
+        out << "Strands must be non-empty.\n";
+        return -1;
+    }
+    if (targetLength > inputLength) {
+        out << "Target strand cannot be longer than input strand.\n";
+        return -1;
+    }
+    double bestScore = bestMatches / static_cast<double>(targetLength);
+    out << "Best match starts at index " << bestIndex
+         << " with similarity " << bestScore << endl;
+    return bestIndex;
+}
+
+void streamIdentifyMutations(const char inputFile[], const string& target_strand,
+                             ostream& out, size_t chunkBases) {
+    out << "Comparing input vs target for mutations...\n";
+    StrandStream input;
+    if (!input.open(inputFile, chunkBases, 0)) {
+        out << "Could not read " << inputFile << ".\n";
+        return;
+    }
+
+    long long targetLength = target_strand.length();
+    string_view bases;
+    long long chunkStart;
+    while (input.nextChunk(bases, chunkStart)) {
+        for (size_t k = 0; k < bases.size(); k++) {
+            long long i = chunkStart + k;
+            if (i < targetLength) {
+                if (bases[k] != target_strand[i]) {
+                    out << "Substitution at position " << i
+                         << ": " << target_strand[i] << " -> " << bases[k] << "\n";
+                }
+            } else {
+                out << "Insertion at position " << i
+                     << ": extra base '" << bases[k] << "' in input strand.\n";
+            }
+        }
+    }
+
+    // Missing bases in the input (extra in target)
+    for (long long j = input.basesRead(); j < targetLength; j++) {
+        out << "Deletion at position " << j
+             << ": missing base '" << target_strand[j] << "' from input strand.\n";
+    }
+    out.flush();
+}
+
+// =========================== Command line tools ===========================
+
+static bool readTarget(const char targetFile[], string& target, ostream& out) {
+    vector<string> names;
+    vector<string> strands;
+    if (!readStrands(targetFile, names, strands) || strands.size() == 0) {
+        out << "Error: no strand found in " << targetFile << endl;
+        return false;
+    }
+    target = strands[0];
+    return true;
+}
+
+int scanBestMatch(const char inputFile[], const char targetFile[], ostream& out) {
+    string target;
+    if (!readTarget(targetFile, target, out)) {
+        return 1;
+    }
+    return streamBestStrandMatch(inputFile, target, out) >= 0 ? 0 : 1;
+}
+
+int scanMutations(const char inputFile[], const char targetFile[], ostream& out) {
+    string target;
+    if (!readTarget(targetFile, target, out)) {
+        return 1;
+    }
+    streamIdentifyMutations(inputFile, target, out);
+    return 0;
+}
@@ -0,0 +1,96 @@
+#ifndef STRANDSTREAM_H
+#define STRANDSTREAM_H
+
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Reads one strand from a file in fixed-size chunks, for strands too big for memory
+//
+// The file is a strand file like readStrands takes (see StrandIO.h): either a
+// FASTA record ('>' header, bases on the lines after it) or bases on one line.
+// Only the first strand is read. Bases are uppercased; line breaks and spaces
+// are skipped.
+//
+// A reader thread fills one chunk while the caller works on the other, so the
+// disk reads overlap the scanning. Each chunk can start with the last 'overlap'
+// bases of the chunk before it, so a window of overlap + 1 bases never falls
+// between two chunks. Memory use is two chunks plus a small read buffer.
+
+class StrandStream {
+private:
+    static const size_t _READ_SIZE = 1 << 20;   // bytes per file read
+
+    // One of the two chunk buffers: 'overlap' bytes of room in front for the
+    // carried bases, then up to 'chunkBases' new bases
+    struct Chunk {
+        vector<char> bases;
+        size_t count;      // new bases in this chunk
+        bool ready;        // filled by the reader, not yet handed back
+    };
+
+    ifstream _file;
+    size_t _chunkBases;
+    size_t _overlap;
+    Chunk _chunks[2];
+
+    // Reader thread state (the parser remembers where it was between reads)
+    thread _reader;
+    mutex _lock;
+    condition_variable _changed;
+    bool _stopping;
+    bool _finished;      // reader has seen the end of the strand
+    vector<char> _raw;
+    size_t _rawPos;
+    size_t _rawEnd;
+    bool _ended;         // parser has reached the end of the strand
+    bool _fasta;
+    bool _inHeader;
+    bool _atLineStart;
+    bool _seenBases;
+
+    // Caller state
+    int _current;        // chunk the caller holds, or -1
+    string_view _view;   // the caller's current chunk (with carried bases)
+    long long _viewStart;
+    long long _total;    // new bases handed to the caller so far
+
+    void readLoop();
+    size_t fillChunk(char bases[], size_t room);
+
+public:
+    StrandStream();
+    ~StrandStream();
+
+    bool open(const char filename[], size_t chunkBases, size_t overlap);
+    void close();
+
+    // Hands out the next chunk (valid until the next call) and the strand
+    // position of its first base. Returns false at the end of the strand
+    bool nextChunk(string_view& bases, long long& start);
+    // Bases read so far (the full length once nextChunk returned false)
+    long long basesRead() const;
+};
+
+const size_t STRAND_CHUNK_BASES = 16 << 20;
+
+// Same results and output as bestStrandMatch / identifyMutations (DNAUtils.h),
+// but the input strand is streamed from a file chunk by chunk.
+// The target is short enough to stay in memory.
+long long streamBestStrandMatch(const char inputFile[], const string& target_strand,
+                                ostream& out, size_t chunkBases = STRAND_CHUNK_BASES);
+void streamIdentifyMutations(const char inputFile[], const string& target_strand,
+                             ostream& out, size_t chunkBases = STRAND_CHUNK_BASES);
+
+// Command line helpers: the target is the first strand of 'targetFile'. Return the exit code
+int scanBestMatch(const char inputFile[], const char targetFile[], ostream& out);
+int scanMutations(const char inputFile[], const char targetFile[], ostream& out);
+
+#endif
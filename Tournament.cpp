@@ -0,0 +1,268 @@
+#include "Tournament.h"
+#include "Game.h"
+#include "PlayerTable.h"
+#include "Random.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <thread>
+
+using namespace std;
+
+Tournament::Tournament(int threadCount) {
+    _threadCount = (threadCount < 1) ? 1 : threadCount;
+    _rules = defaultGameRules();
+    _gamesLeft = 0;
+}
+
+void Tournament::setRules(const GameRules& rules) {
+    _rules = rules;
+}
+
+// Own queue first (newest, smallest task), then steal the oldest task of another queue
+// Victims are tried starting from a random one, so thieves spread out
+bool Tournament::takeTask(int self, unsigned long long& rng, Task& task) {
+    {
+        lock_guard<mutex> guard(_queues[self]->lock);
+        if (!_queues[self]->tasks.empty()) {
+            task = _queues[self]->tasks.back();
+            _queues[self]->tasks.pop_back();
+            return true;
+        }
+    }
+
+    int start = nextRandom(rng) % _threadCount;
+    for (int k = 0; k < _threadCount; k++) {
+        int victim = (start + k) % _threadCount;
+        if (victim == self) {
+            continue;
+        }
+        lock_guard<mutex> guard(_queues[victim]->lock);
+        if (!_queues[victim]->tasks.empty()) {
+            task = _queues[victim]->tasks.front();
+            _queues[victim]->tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void Tournament::workerLoop(int self, Results& results) {
+    ostream silent(nullptr);
+    Game game(silent);
+    game.loadData();
+    game.setRules(_rules);
+
+    int entrants = _entrantNames.size();
+    PlayerTable table;
+    vector<int> characters(_GRAIN * 2);
+    vector<int> paths(_GRAIN * 2);
+    vector<int> advisors(_GRAIN * 2);
+    vector<int> scores(_GRAIN * 2);
+    vector<int> seats(_GRAIN * 2);   // entrant in each row
+    vector<unsigned long long> seeds(_GRAIN);
+    unsigned long long rng = mixKey(1300, self);
+
+    // Keep going until every game is played (a task we cannot find now may
+    // still be split off by another thread)
+    while (_gamesLeft.load() > 0) {
+        Task task;
+        if (!takeTask(self, rng, task)) {
+            this_thread::yield();
+            continue;
+        }
+
+        // Split big tasks: keep the first part, leave the rest for us or a thief
+        while (task.seedCount > _GRAIN) {
+            int half = task.seedCount / 2;
+            Task rest = {task.pairing, task.firstSeed + half, task.seedCount - half};
+            task.seedCount = half;
+            lock_guard<mutex> guard(_queues[self]->lock);
+            _queues[self]->tasks.push_back(rest);
+        }
+
+        int count = task.seedCount;
+        for (int s = 0; s < count; s++) {
+            int seedIndex = task.firstSeed + s;
+            unsigned long long seed = mixKey(mixKey(1300, task.pairing), seedIndex);
+
+            // Swap seats every other game (moving first is not quite fair)
+            int first = _pairA[task.pairing];
+            int second = _pairB[task.pairing];
+            if (seedIndex % 2 == 1) {
+                swap(first, second);
+            }
+            seats[s * 2] = first;
+            seats[s * 2 + 1] = second;
+            for (int i = 0; i < 2; i++) {
+                int e = seats[s * 2 + i];
+                characters[s * 2 + i] = e / 2;
+                paths[s * 2 + i] = e % 2;
+                // Advisors are not part of an entrant; each game draws them
+                advisors[s * 2 + i] = 1 + nextRandom(seed) % 5;
+            }
+            seeds[s] = nextRandom(seed);
+        }
+
+        game.simulateBatch(count, characters.data(), paths.data(), advisors.data(),
+                           seeds.data(), table, scores.data());
+
+        for (int s = 0; s < count; s++) {
+            int a = seats[s * 2];
+            int b = seats[s * 2 + 1];
+            double aWins = 0.5;
+            if (scores[s * 2] > scores[s * 2 + 1]) {
+                aWins = 1.0;
+            } else if (scores[s * 2] < scores[s * 2 + 1]) {
+                aWins = 0.0;
+            }
+            results.wins[a * entrants + b] += aWins;
+            results.wins[b * entrants + a] += 1.0 - aWins;
+            results.games[a * entrants + b]++;
+            results.games[b * entrants + a]++;
+        }
+
+        _gamesLeft -= count;
+    }
+}
+
+void Tournament::run(int seedsPerPairing, ostream& out) {
+    // Entrant e is character e / 2 on path e % 2
+    ostream silent(nullptr);
+    Game names(silent);
+    names.loadData();
+    _entrantNames.clear();
+    for (int c = 0; c < names.getCharacterCount(); c++) {
+        _entrantNames.push_back(names.getCharacterOption(c).getName() + " / Fellowship");
+        _entrantNames.push_back(names.getCharacterOption(c).getName() + " / Direct Lab");
+    }
+    int entrants = _entrantNames.size();
+
+    _pairA.clear();
+    _pairB.clear();
+    for (int a = 0; a < entrants; a++) {
+        for (int b = a + 1; b < entrants; b++) {
+            if (a / 2 != b / 2) {
+                _pairA.push_back(a);
+                _pairB.push_back(b);
+            }
+        }
+    }
+    if (_pairA.empty() || seedsPerPairing < 1) {
+        out << "Not enough characters for a tournament.\n";
+        return;
+    }
+
+    // Deal the pairings out to the queues; stealing evens out the rest
+    _queues.clear();
+    for (int t = 0; t < _threadCount; t++) {
+        _queues.push_back(unique_ptr<WorkQueue>(new WorkQueue()));
+    }
+    for (int p = 0; p < (int)_pairA.size(); p++) {
+        Task task = {p, 0, seedsPerPairing};
+        _queues[p % _threadCount]->tasks.push_back(task);
+    }
+    _gamesLeft = (long)_pairA.size() * seedsPerPairing;
+
+    vector<Results> results(_threadCount);
+    vector<thread> workers;
+    for (int t = 0; t < _threadCount; t++) {
+        results[t].wins.assign(entrants * entrants, 0.0);
+        results[t].games.assign(entrants * entrants, 0);
+        workers.push_back(thread(&Tournament::workerLoop, this, t, ref(results[t])));
+    }
+    for (int t = 0; t < _threadCount; t++) {
+        workers[t].join();
+    }
+
+    for (int t = 1; t < _threadCount; t++) {
+        for (int i = 0; i < entrants * entrants; i++) {
+            results[0].wins[i] += results[t].wins[i];
+            results[0].games[i] += results[t].games[i];
+        }
+    }
+    report(results[0], out);
+}
+
+void Tournament::report(const Results& results, ostream& out) const {
+    int entrants = _entrantNames.size();
+
+    // Bradley-Terry strengths: P(a beats b) = s[a] / (s[a] + s[b]), fitted with
+    // the usual fixed-point update. One drawn game per pairing is added so an
+    // entrant that never wins (or never loses) still gets a finite rating.
+    vector<double> strength(entrants, 1.0);
+    for (int iteration = 0; iteration < 500; iteration++) {
+        vector<double> next(entrants, 0.0);
+        double logSum = 0.0;
+        for (int a = 0; a < entrants; a++) {
+            double wins = 0.0;
+            double denominator = 0.0;
+            for (int b = 0; b < entrants; b++) {
+                int games = results.games[a * entrants + b];
+                if (b == a || games == 0) {
+                    continue;
+                }
+                wins += results.wins[a * entrants + b] + 0.5;
+                denominator += (games + 1) / (strength[a] + strength[b]);
+            }
+            next[a] = (denominator > 0.0) ? wins / denominator : 1.0;
+            logSum += log(next[a]);
+        }
+        // Keep the average rating at 1500
+        double scale = exp(logSum / entrants);
+        for (int a = 0; a < entrants; a++) {
+            strength[a] = next[a] / scale;
+        }
+    }
+
+    vector<int> order(entrants);
+    long totalGames = 0;
+    for (int a = 0; a < entrants; a++) {
+        order[a] = a;
+        for (int b = 0; b < entrants; b++) {
+            totalGames += results.games[a * entrants + b];
+        }
+    }
+    sort(order.begin(), order.end(), [&](int x, int y) { return strength[x] > strength[y]; });
+
+    out << "\n===== TOURNAMENT (" << totalGames / 2 << " games) =====\n";
+    out << left << setw(6) << "Rank" << setw(28) << "Entrant" << right
+        << setw(8) << "Rating" << setw(8) << "Win %" << "\n";
+    out << fixed;
+    for (int r = 0; r < entrants; r++) {
+        int a = order[r];
+        double wins = 0.0;
+        long games = 0;
+        for (int b = 0; b < entrants; b++) {
+            wins += results.wins[a * entrants + b];
+            games += results.games[a * entrants + b];
+        }
+        out << left << setw(6) << (r + 1) << setw(28) << _entrantNames[a] << right
+            << setw(8) << setprecision(0) << 1500.0 + 400.0 * log10(strength[a])
+            << setw(8) << setprecision(1) << (games > 0 ? 100.0 * wins / games : 0.0) << "\n";
+    }
+
+    // Row entrant's win % against each column entrant (in rank order)
+    out << "\nWin % of row against column (- = same character)\n";
+    out << setw(6) << "";
+    for (int c = 0; c < entrants; c++) {
+        out << setw(6) << (c + 1);
+    }
+    out << "\n";
+    for (int r = 0; r < entrants; r++) {
+        int a = order[r];
+        out << setw(6) << (r + 1);
+        for (int c = 0; c < entrants; c++) {
+            int b = order[c];
+            int games = results.games[a * entrants + b];
+            if (games == 0) {
+                out << setw(6) << "-";
+            } else {
+                out << setw(6) << setprecision(0) << 100.0 * results.wins[a * entrants + b] / games;
+            }
+        }
+        out << "\n";
+    }
+    out.unsetf(ios::fixed);
+}
@@ -0,0 +1,72 @@
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+
+#include "Rules.h"
+
+#include <atomic>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Round-robin tournament between every character/path combination
+//
+// An entrant is one character on one path. Every two entrants with different
+// characters (the game never lets both players pick the same one) play the
+// same number of games, each from its own seed, with seats swapped every other
+// game. The report ranks the entrants by a rating fitted to all results
+// (Bradley-Terry, shown on the Elo scale) and prints the full win matrix.
+//
+// Scheduling is work stealing: every thread has its own queue of tasks (a range
+// of seeds for one pairing). A thread takes from the back of its own queue and
+// splits big ranges in half, leaving one half in the queue; a thread with
+// nothing left takes the oldest (biggest) task from the front of another queue.
+// Results only depend on the seeds, never on which thread played a game.
+
+class Tournament {
+private:
+    struct Task {
+        int pairing;
+        int firstSeed;
+        int seedCount;
+    };
+
+    struct WorkQueue {
+        mutex lock;
+        deque<Task> tasks;
+    };
+
+    // Wins and games of each entrant against each other entrant
+    struct Results {
+        vector<double> wins;   // [a * entrants + b]: games a won against b (ties count as half)
+        vector<int> games;     // [a * entrants + b]: games between a and b
+    };
+
+    int _threadCount;
+    GameRules _rules;
+    vector<string> _entrantNames;
+    vector<int> _pairA;   // the two entrants of each pairing
+    vector<int> _pairB;
+    vector<unique_ptr<WorkQueue>> _queues;
+    atomic<long> _gamesLeft;
+
+    // Games played per batch; bigger tasks are split before they are played
+    static const int _GRAIN = 256;
+
+    bool takeTask(int self, unsigned long long& rng, Task& task);
+    void workerLoop(int self, Results& results);
+    void report(const Results& results, ostream& out) const;
+
+public:
+    explicit Tournament(int threadCount);
+
+    void setRules(const GameRules& rules);
+    // Plays 'seedsPerPairing' games for every pairing and prints the report to 'out'
+    void run(int seedsPerPairing, ostream& out);
+};
+
+#endif
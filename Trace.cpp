@@ -0,0 +1,184 @@
+#include "Trace.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+atomic<bool> traceActive(false);
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    unsigned long long start;
+    unsigned long long end;
+};
+
+// One per thread that has recorded something. Buffers are kept after their
+// thread ends, so spans of finished worker threads can still be exported.
+struct TraceBuffer {
+    int threadId;
+    vector<TraceEvent> events;
+    long dropped;
+};
+
+// Past this many spans a thread only counts what it drops (about 24 MB each)
+const size_t MAX_EVENTS_PER_THREAD = 1 << 20;
+
+mutex registryLock;                          // only taken when a thread records for the first time
+vector<unique_ptr<TraceBuffer>> registry;
+thread_local TraceBuffer* localBuffer = nullptr;
+
+// Clock readings from when tracing started, for turning ticks into microseconds
+unsigned long long startTicks = 0;
+chrono::steady_clock::time_point startTime;
+
+TraceBuffer* threadBuffer() {
+    if (localBuffer == nullptr) {
+        lock_guard<mutex> guard(registryLock);
+        registry.push_back(unique_ptr<TraceBuffer>(new TraceBuffer()));
+        localBuffer = registry.back().get();
+        localBuffer->threadId = registry.size();
+        localBuffer->dropped = 0;
+        localBuffer->events.reserve(4096);
+    }
+    return localBuffer;
+}
+
+// Ticks per microsecond, measured against the steady clock since startTracing
+double ticksPerMicrosecond() {
+    double micros = chrono::duration<double, micro>(chrono::steady_clock::now() - startTime).count();
+    unsigned long long ticks = traceTimestamp() - startTicks;
+    if (micros <= 0.0 || ticks == 0) {
+        return 1.0;
+    }
+    return ticks / micros;
+}
+
+}  // namespace
+
+void traceRecord(const char* name, unsigned long long start, unsigned long long end) {
+    TraceBuffer* buffer = threadBuffer();
+    if (buffer->events.size() >= MAX_EVENTS_PER_THREAD) {
+        buffer->dropped++;
+        return;
+    }
+    TraceEvent event = {name, start, end};
+    buffer->events.push_back(event);
+}
+
+void startTracing() {
+    if (startTicks == 0) {
+        startTime = chrono::steady_clock::now();
+        startTicks = traceTimestamp();
+    }
+    traceActive.store(true);
+}
+
+void stopTracing() {
+    traceActive.store(false);
+}
+
+TraceSession::TraceSession(ostream& out) : _out(out) {
+}
+
+TraceSession::~TraceSession() {
+    if (_filename == "") {
+        return;
+    }
+    stopTracing();
+    if (!writeChromeTrace(_filename.c_str())) {
+        _out << "Error: could not write " << _filename << endl;
+    }
+    printTraceSummary(_out);
+}
+
+void TraceSession::start(const string& filename) {
+    _filename = filename;
+    startTracing();
+}
+
+// Call these once the traced threads are done (or tracing is stopped)
+bool writeChromeTrace(const char filename[]) {
+    ofstream file(filename);
+    if (!file) {
+        return false;
+    }
+
+    double scale = ticksPerMicrosecond();
+    lock_guard<mutex> guard(registryLock);
+
+    file << "{\"traceEvents\":[\n";
+    file << fixed << setprecision(3);
+    bool first = true;
+    for (size_t b = 0; b < registry.size(); b++) {
+        const TraceBuffer& buffer = *registry[b];
+        for (size_t i = 0; i < buffer.events.size(); i++) {
+            const TraceEvent& e = buffer.events[i];
+            // Complete event ("X"): start and duration in microseconds
+            file << (first ? "" : ",\n")
+                 << "{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer.threadId
+                 << ",\"ts\":" << (double)(e.start - startTicks) / scale
+                 << ",\"dur\":" << (double)(e.end - e.start) / scale << "}";
+            first = false;
+        }
+    }
+    file << "\n],\"displayTimeUnit\":\"ns\"}\n";
+    return (bool)file;
+}
+
+void printTraceSummary(ostream& out) {
+    struct Totals {
+        long count = 0;
+        unsigned long long ticks = 0;
+        unsigned long long longest = 0;
+    };
+
+    double scale = ticksPerMicrosecond();
+    map<string, Totals> totals;
+    long dropped = 0;
+    {
+        lock_guard<mutex> guard(registryLock);
+        for (size_t b = 0; b < registry.size(); b++) {
+            const TraceBuffer& buffer = *registry[b];
+            dropped += buffer.dropped;
+            for (size_t i = 0; i < buffer.events.size(); i++) {
+                const TraceEvent& e = buffer.events[i];
+                Totals& t = totals[e.name];
+                unsigned long long ticks = e.end - e.start;
+                t.count++;
+                t.ticks += ticks;
+                t.longest = max(t.longest, ticks);
+            }
+        }
+    }
+
+    // Most total time first
+    vector<pair<string, Totals>> rows(totals.begin(), totals.end());
+    sort(rows.begin(), rows.end(), [](const pair<string, Totals>& x, const pair<string, Totals>& y) {
+        return x.second.ticks > y.second.ticks;
+    });
+
+    out << "\n===== TRACE SUMMARY =====\n";
+    out << left << setw(24) << "Probe" << right << setw(10) << "Calls" << setw(14) << "Total ms"
+        << setw(12) << "Avg us" << setw(12) << "Max us" << "\n";
+    out << fixed;
+    for (size_t i = 0; i < rows.size(); i++) {
+        const Totals& t = rows[i].second;
+        out << left << setw(24) << rows[i].first << right << setw(10) << t.count
+            << setw(14) << setprecision(3) << t.ticks / scale / 1000.0
+            << setw(12) << setprecision(3) << t.ticks / scale / t.count
+            << setw(12) << setprecision(3) << t.longest / scale << "\n";
+    }
+    if (dropped > 0) {
+        out << dropped << " spans were not recorded (buffer full)\n";
+    }
+    out.unsetf(ios::fixed);
+}
@@ -0,0 +1,96 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+using namespace std;
+
+// Timing probes for finding out where a game spends its time
+//
+// Put TRACE_SCOPE("name") at the top of a function (or any block): while
+// tracing is on, the time from there to the end of the block is recorded.
+// Timestamps come from the CPU's time stamp counter (rdtsc), which costs a few
+// nanoseconds and needs no system call. Each thread records into its own
+// buffer, so probes never wait on each other.
+//
+// While tracing is off a probe only reads one flag, so the probes can stay in
+// the code. Compile with -DNO_TRACE to remove them completely.
+//
+// The recorded spans can be saved as a Chrome trace (open it in chrome://tracing
+// or ui.perfetto.dev), and a summary per probe name can be printed.
+
+// Cheap "is tracing on" flag read by every probe
+extern atomic<bool> traceActive;
+
+// Time stamp counter ticks (nanoseconds on machines without one)
+inline unsigned long long traceTimestamp() {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// Records one span; called by TraceScope when tracing is on
+void traceRecord(const char* name, unsigned long long start, unsigned long long end);
+
+class TraceScope {
+private:
+    const char* _name;   // must be a string literal (only the pointer is kept)
+    unsigned long long _start;
+
+public:
+    explicit TraceScope(const char* name) {
+        _name = name;
+        _start = traceActive.load(memory_order_relaxed) ? traceTimestamp() : 0;
+    }
+
+    ~TraceScope() {
+        if (_start != 0) {
+            traceRecord(_name, _start, traceTimestamp());
+        }
+    }
+};
+
+#ifdef NO_TRACE
+#define TRACE_SCOPE(name)
+#else
+#define TRACE_JOIN2(a, b) a##b
+#define TRACE_JOIN(a, b) TRACE_JOIN2(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_JOIN(traceScope, __LINE__)(name)
+#endif
+
+// Turns recording on or off (spans recorded so far are kept)
+void startTracing();
+void stopTracing();
+
+// Writes every recorded span as Chrome trace-event JSON; returns false if the file can't be written
+bool writeChromeTrace(const char filename[]);
+// Prints call count, total and average time for each probe name
+void printTraceSummary(ostream& out);
+
+// Tracing for the life of the program: start() turns it on, and when the
+// session ends (at the end of main) the trace is saved and the summary printed
+class TraceSession {
+private:
+    string _filename;
+    ostream& _out;
+
+public:
+    explicit TraceSession(ostream& out);
+    ~TraceSession();
+
+    void start(const string& filename);
+};
+
+#endif
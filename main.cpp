@@ -1,7 +1,292 @@
+#include "Alignment.h"
+#include "BalanceOptimizer.h"
+#include "BatchStats.h"
+#include "BloomFilter.h"
 #include "Game.h"
+#include "OrfScanner.h"
+#include "Output.h"
+#include "Pipeline.h"
+#include "ResultCache.h"
+#include "Server.h"
+#include "SimilarityMatrix.h"
+#include "Sketch.h"
+#include "SpectatorFeed.h"
+#include "StrandGenerator.h"
+#include "StrandStream.h"
+#include "Tournament.h"
+#include "Trace.h"
+#include <cstdlib>
+#include <string>
 
-int main() {
-    Game final;
+int main(int argc, char* argv[]) {
+    // Everything prints through one queue (the game and every tool mode, so
+    // their lines cannot overtake each other); a writer thread does the writes
+    Output console(1, OUTPUT_NORMAL);
+    QueuedStream out(console, OUTPUT_NORMAL);
+    Game final(out);
+    // Declared after 'out' so the summary is printed before 'out' goes away
+    TraceSession traceSession(out);
+    string replayFile = "";
+    string optimizeFile = "";
+    long statsGames = 0;
+    int tournamentSeeds = 0;
+    SpectatorFeed spectators;
+    ResultCache results;
+    bool cacheResults = false;
+    string spectateName = "";
+    string serverAddress = "";
+    string sketchStrands = "";
+    string sketchOutput = "";
+    string relatedSketches = "";
+    double relatedJaccard = 0;
+    string similarityStrands = "";
+    double similarityCutoff = 0;
+    string scanMode = "";
+    string scanInput = "";
+    string scanTarget = "";
+    string alignFile = "";
+    string orfFile = "";
+    int orfMinLength = 0;
+    string generatePrefix = "";
+    string bloomStrands = "";
+    string bloomOutput = "";
+    string filterStrands = "";
+    string filterFile = "";
+    string filterTarget = "";
+    double filterSimilarity = 0;
+    string matchAllStrands = "";
+    string matchAllTarget = "";
+    double matchAllSimilarity = 0;
+    GeneratorSettings generator = defaultGeneratorSettings();
+    GameRules rules = defaultGameRules();
+
+    // Optional modes:
+    //   --journal <file>  record this session into a binary journal
+    //   --replay <file>   re-run a recorded session without reading input
+    //   --data-files      read the .txt data files instead of the built-in data
+    //   --ai <1 or 2>     let the computer play that seat
+    //   --indels          blue tiles accept strands with a few inserted/deleted bases
+    //   --rules <file>    use the reward values in a rules file (see Rules.h)
+    //   --optimize <file> search for balanced rules and save them to the file
+    //   --stats <games>   simulate many games and print the score distribution
+    //   --tournament <n>  play n games for every pairing of character and path
+    //   --trace <file>    time the game and save a Chrome trace (plus a summary)
+    //   --publish <name>  let other processes watch this game (shared memory name like /genome)
+    //   --spectate <name> watch a game started with --publish
+    //   --server <port or /socket/path>  host games for many players over local connections
+    //   --result-cache <file>  remember DNA task results in a file shared by every process using it
+    //   --sketch <strands> <out>  save MinHash sketches of every strand in a strand file
+    //   --related <sketches> <min jaccard>  list strand pairs that look at least this similar
+    //   --similarity <strands> <min>  compare every pair of strands (0 prints the full matrix)
+    //   --scan-match <input> <target>      bestStrandMatch on an input strand file of any size
+    //   --scan-mutations <input> <target>  identifyMutations on an input strand file of any size
+    //   --align <strands> similarity of the first two strands, allowing inserted/deleted bases
+    //   --orfs <strands> <min bases>  list the open reading frames in all six frames
+    //   --generate <prefix> <pairs> <length>  write random reference/query strands with known mutations
+    //     (with --gc <fraction>, --mutations <sub> <ins> <del> <homopolymer>, --seed <n>, --packed)
+    //   --bloom <strands> <out>  save a k-mer Bloom filter of every strand in a strand file
+    //   --filter-match <strands> <filters> <target> <min>  best match in the references the filters let through
+    //   --match-all <strands> <target> <min>  best match in every strand of a file of any size (read, compute and print overlap)
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--journal" && i + 1 < argc) {
+            final.startJournal(argv[i + 1]);
+            i++;
+        } else if (arg == "--replay" && i + 1 < argc) {
+            replayFile = argv[i + 1];
+            i++;
+        } else if (arg == "--data-files") {
+            final.useDataFiles();
+        } else if (arg == "--rules" && i + 1 < argc) {
+            final.loadRules(argv[i + 1]);
+            loadGameRules(argv[i + 1], rules);
+            i++;
+        } else if (arg == "--stats" && i + 1 < argc) {
+            statsGames = atol(argv[i + 1]);
+            i++;
+        } else if (arg == "--trace" && i + 1 < argc) {
+            traceSession.start(argv[i + 1]);
+            i++;
+        } else if (arg == "--publish" && i + 1 < argc) {
+            if (spectators.open(argv[i + 1])) {
+                final.setSpectatorFeed(&spectators);
+            } else {
+                out << "Error: could not publish to " << argv[i + 1] << endl;
+            }
+            i++;
+        } else if (arg == "--spectate" && i + 1 < argc) {
+            spectateName = argv[i + 1];
+            i++;
+        } else if (arg == "--server" && i + 1 < argc) {
+            serverAddress = argv[i + 1];
+            i++;
+        } else if (arg == "--result-cache" && i + 1 < argc) {
+            if (results.openFile(argv[i + 1])) {
+                final.setResultCache(&results);
+                cacheResults = true;
+            } else {
+                out << "Error: could not open result cache " << argv[i + 1] << endl;
+            }
+            i++;
+        } else if (arg == "--sketch" && i + 2 < argc) {
+            sketchStrands = argv[i + 1];
+            sketchOutput = argv[i + 2];
+            i += 2;
+        } else if (arg == "--related" && i + 2 < argc) {
+            relatedSketches = argv[i + 1];
+            relatedJaccard = atof(argv[i + 2]);
+            i += 2;
+        } else if (arg == "--similarity" && i + 2 < argc) {
+            similarityStrands = argv[i + 1];
+            similarityCutoff = atof(argv[i + 2]);
+            i += 2;
+        } else if ((arg == "--scan-match" || arg == "--scan-mutations") && i + 2 < argc) {
+            scanMode = arg;
+            scanInput = argv[i + 1];
+            scanTarget = argv[i + 2];
+            i += 2;
+        } else if (arg == "--align" && i + 1 < argc) {
+            alignFile = argv[i + 1];
+            i++;
+        } else if (arg == "--orfs" && i + 2 < argc) {
+            orfFile = argv[i + 1];
+            orfMinLength = atoi(argv[i + 2]);
+            i += 2;
+        } else if (arg == "--generate" && i + 3 < argc) {
+            generatePrefix = argv[i + 1];
+            generator.count = atoll(argv[i + 2]);
+            generator.length = atoll(argv[i + 3]);
+            i += 3;
+        } else if (arg == "--bloom" && i + 2 < argc) {
+            bloomStrands = argv[i + 1];
+            bloomOutput = argv[i + 2];
+            i += 2;
+        } else if (arg == "--filter-match" && i + 4 < argc) {
+            filterStrands = argv[i + 1];
+            filterFile = argv[i + 2];
+            filterTarget = argv[i + 3];
+            filterSimilarity = atof(argv[i + 4]);
+            i += 4;
+        } else if (arg == "--match-all" && i + 3 < argc) {
+            matchAllStrands = argv[i + 1];
+            matchAllTarget = argv[i + 2];
+            matchAllSimilarity = atof(argv[i + 3]);
+            i += 3;
+        } else if (arg == "--gc" && i + 1 < argc) {
+            generator.gcContent = atof(argv[i + 1]);
+            i++;
+        } else if (arg == "--mutations" && i + 4 < argc) {
+            generator.substitutionRate = atof(argv[i + 1]);
+            generator.insertionRate = atof(argv[i + 2]);
+            generator.deletionRate = atof(argv[i + 3]);
+            generator.homopolymerRate = atof(argv[i + 4]);
+            i += 4;
+        } else if (arg == "--seed" && i + 1 < argc) {
+            generator.seed = strtoull(argv[i + 1], nullptr, 10);
+            i++;
+        } else if (arg == "--packed") {
+            generator.packed = true;
+        } else if (arg == "--tournament" && i + 1 < argc) {
+            tournamentSeeds = atoi(argv[i + 1]);
+            i++;
+        } else if (arg == "--optimize" && i + 1 < argc) {
+            optimizeFile = argv[i + 1];
+            i++;
+        } else if (arg == "--indels") {
+            final.setAllowIndels(true);
+        } else if (arg == "--ai" && i + 1 < argc) {
+            final.setAIPlayer(atoi(argv[i + 1]) - 1);
+            i++;
+        }
+    }
+
+    if (serverAddress != "") {
+        // Server games always share the in-memory cache (plus the file, if given)
+        return runServer(serverAddress, thread::hardware_concurrency(), &results, out);
+    }
+
+    if (spectateName != "") {
+        return watchGame(spectateName.c_str(), out);
+    }
+
+    if (sketchStrands != "") {
+        return sketchStrandFile(sketchStrands.c_str(), sketchOutput.c_str(), out);
+    }
+
+    if (relatedSketches != "") {
+        return printRelatedStrands(relatedSketches.c_str(), relatedJaccard, out);
+    }
+
+    if (similarityStrands != "") {
+        return printSimilarityMatrix(similarityStrands.c_str(), similarityCutoff, thread::hardware_concurrency(), out);
+    }
+
+    if (scanMode == "--scan-match") {
+        return scanBestMatch(scanInput.c_str(), scanTarget.c_str(), out);
+    }
+
+    if (scanMode == "--scan-mutations") {
+        return scanMutations(scanInput.c_str(), scanTarget.c_str(), out);
+    }
+
+    if (alignFile != "") {
+        return printAlignment(alignFile.c_str(), out);
+    }
+
+    if (orfFile != "") {
+        return printOpenReadingFrames(orfFile.c_str(), orfMinLength, out);
+    }
+
+    if (generatePrefix != "") {
+        return generateStrandFiles(generatePrefix, generator, out);
+    }
+
+    if (bloomStrands != "") {
+        return buildBloomFilterFile(bloomStrands.c_str(), bloomOutput.c_str(), out);
+    }
+
+    if (filterStrands != "") {
+        return filteredBestMatch(filterStrands.c_str(), filterFile.c_str(), filterTarget.c_str(),
+                                 filterSimilarity, out);
+    }
+
+    if (matchAllStrands != "") {
+        return pipelineBestMatch(matchAllStrands.c_str(), matchAllTarget.c_str(), matchAllSimilarity,
+                                 thread::hardware_concurrency(), out);
+    }
+
+    if (statsGames > 0) {
+        runScoreStatistics(statsGames, thread::hardware_concurrency(), rules, out);
+        return 0;
+    }
+
+    if (tournamentSeeds > 0) {
+        Tournament tournament(thread::hardware_concurrency());
+        tournament.setRules(rules);
+        tournament.run(tournamentSeeds, out);
+        return 0;
+    }
+
+    if (optimizeFile != "") {
+        BalanceOptimizer optimizer(thread::hardware_concurrency());
+        GameRules best = optimizer.optimize(rules, out);
+        if (!saveGameRules(optimizeFile.c_str(), best)) {
+            out << "Error: could not write " << optimizeFile << endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (replayFile != "") {
+        return final.replay(replayFile.c_str()) ? 0 : 1;
+    }
+
+    // Anything waiting in 'out' is printed before cin reads (so prompts show up)
+    cin.tie(&out);
     final.run();
+    cin.tie(&cout);
+    if (cacheResults) {
+        printCacheCounters(results, out);
+    }
     return 0;
 }